@@ -0,0 +1,627 @@
+#include "aabbtree.h"
+#include "states.hpp"
+
+#include "boxlist.h"
+#include "../physics/physicsmodel.h"
+#include "../physics/narrowphase.h"
+
+#include <algorithm>
+#include <limits>
+
+/*
+    broad phase methods
+*/
+
+// add instance to pending queue
+void AABBTree::addToPending(RigidBody* instance, PhysicsModel* model) {
+    // getting all the bounding regions of the model
+    for (BoundingRegion br : model->boundingRegions) {
+        br.instance = instance;
+        br.transform();
+        queue.push(pool.allocate(br));
+    }
+}
+
+// process pending queue
+void AABBTree::processPending() {
+    while (queue.size() != 0) {
+        unsigned int obj = queue.front();
+        queue.pop();
+
+        // create leaf with fattened box
+        unsigned int leaf = allocateNode();
+        nodes[leaf].min = pool.hot[obj].min - glm::vec3(margin);
+        nodes[leaf].max = pool.hot[obj].max + glm::vec3(margin);
+        nodes[leaf].obj = obj;
+        nodes[leaf].height = 0;
+        insertLeaf(leaf);
+
+        pool.hot[obj].cellIdx = leaf;
+        objects.push_back(obj);
+    }
+}
+
+// update objects and check collisions (called during each iteration of main loop)
+void AABBTree::update(BoxList& box) {
+    removeDead();
+
+    // transform moved regions, only reinsert if they left their fattened box
+    std::vector<unsigned int> movedList;
+    for (unsigned int obj : objects) {
+        if (!States::isActive(&pool[obj].instance->state, INSTANCE_MOVED)) {
+            continue;
+        }
+
+        pool.transform(obj);
+        movedList.push_back(obj);
+
+        BoundsHot& hot = pool.hot[obj];
+        unsigned int leaf = hot.cellIdx;
+        if (glm::all(glm::greaterThanEqual(hot.min, nodes[leaf].min)) &&
+            glm::all(glm::lessThanEqual(hot.max, nodes[leaf].max))) {
+            // still inside
+            continue;
+        }
+
+        removeLeaf(leaf);
+        nodes[leaf].min = hot.min - glm::vec3(margin);
+        nodes[leaf].max = hot.max + glm::vec3(margin);
+        insertLeaf(leaf);
+        Stats::add(Stats::REINSERTIONS);
+    }
+
+    // add node boxes
+    for (AABBTreeNode& node : nodes) {
+        if (node.height >= 0) {
+            box.positions.push_back(0.5f * (node.min + node.max));
+            box.sizes.push_back(node.max - node.min);
+        }
+    }
+
+    // test moved regions against all regions they overlap (on the workers if there are any)
+    checkCollisionsList((unsigned int)movedList.size(), [&](unsigned int start, unsigned int end, std::vector<Contact>& contacts) -> void {
+        std::vector<unsigned int> candidates;
+        Contact contact;
+
+        for (unsigned int i = start; i < end; i++) {
+            unsigned int obj = movedList[i];
+            BoundingRegion& objRegion = pool[obj];
+
+            candidates.clear();
+            query(pool.hot[obj].min, pool.hot[obj].max, candidates);
+
+            for (unsigned int other : candidates) {
+                BoundingRegion& br = pool[other];
+                if (br.instance == objRegion.instance) {
+                    // do not test collision with the same instance
+                    continue;
+                }
+
+                if (pool.boxesIntersect(other, obj) && br.intersectsWith(objRegion) &&
+                    NarrowPhase::test(br, objRegion, contact)) {
+                    contacts.push_back(contact);
+                }
+            }
+        }
+    });
+
+    processPending();
+}
+
+// check collisions with a ray
+BoundingRegion* AABBTree::checkCollisionsRay(Ray r, float& tmin) {
+    BoundingRegion* ret = nullptr;
+
+    if (root == NULL_NODE) {
+        return ret;
+    }
+
+    std::vector<unsigned int> stack;
+    stack.push_back(root);
+
+    while (stack.size() != 0) {
+        unsigned int idx = stack.back();
+        stack.pop_back();
+
+        AABBTreeNode& node = nodes[idx];
+        float tmin_tmp = std::numeric_limits<float>::max();
+        float tmax_tmp = std::numeric_limits<float>::lowest();
+
+        // skip subtrees missed by the ray or behind the closest hit
+        BoundingRegion nodeRegion(node.min, node.max);
+        if (!r.intersectsBoundingRegion(nodeRegion, tmin_tmp, tmax_tmp) || tmin_tmp > tmin) {
+            continue;
+        }
+
+        if (node.obj == NULL_BOUNDS) {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+            continue;
+        }
+
+        if (r.intersectsRegion(pool[node.obj], tmin)) {
+            ret = &pool[node.obj];
+        }
+    }
+
+    return ret;
+}
+
+// check for any collision with a ray closer than tmax (returns first region found)
+BoundingRegion* AABBTree::checkCollisionsRayAny(Ray r, float tmax) {
+    if (root == NULL_NODE) {
+        return nullptr;
+    }
+
+    std::vector<unsigned int> stack;
+    stack.push_back(root);
+
+    while (stack.size() != 0) {
+        unsigned int idx = stack.back();
+        stack.pop_back();
+
+        AABBTreeNode& node = nodes[idx];
+        float tmin_tmp = std::numeric_limits<float>::max();
+        float tmax_tmp = std::numeric_limits<float>::lowest();
+
+        // skip subtrees missed by the ray or beyond tmax
+        BoundingRegion nodeRegion(node.min, node.max);
+        if (!r.intersectsBoundingRegion(nodeRegion, tmin_tmp, tmax_tmp) || tmin_tmp > tmax) {
+            continue;
+        }
+
+        if (node.obj == NULL_BOUNDS) {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+            continue;
+        }
+
+        // stop at first hit
+        float t = tmax;
+        if (r.intersectsRegion(pool[node.obj], t)) {
+            return &pool[node.obj];
+        }
+    }
+
+    return nullptr;
+}
+
+// check collisions with a packet of rays
+void AABBTree::checkCollisionsPacket(RayPacket& packet) {
+    if (root == NULL_NODE) {
+        return;
+    }
+
+    alignas(32) float tEnter[RAY_PACKET_MAX];
+
+    // nodes to visit with the rays that entered their parent
+    std::vector<std::pair<unsigned int, unsigned int>> stack;
+    stack.push_back({ root, packet.activeMask() });
+
+    while (stack.size() != 0) {
+        AABBTreeNode& node = nodes[stack.back().first];
+        unsigned int mask = stack.back().second;
+        stack.pop_back();
+
+        // skip subtrees missed by all rays or behind their closest hits
+        mask &= packet.intersectsBox(node.min, node.max, tEnter);
+        if (!mask) {
+            continue;
+        }
+
+        if (node.obj == NULL_BOUNDS) {
+            stack.push_back({ node.left, mask });
+            stack.push_back({ node.right, mask });
+        }
+        else {
+            packet.testRegion(pool[node.obj], mask);
+        }
+    }
+}
+
+// check collisions of a region not stored in the structure
+void AABBTree::checkCollisionsRegion(BoundingRegion& obj, std::vector<Contact>* contacts) {
+    glm::vec3 min, max;
+    BoundsPool::calculateBox(obj, min, max);
+
+    std::vector<unsigned int> candidates;
+    query(min, max, candidates);
+
+    Contact contact;
+    for (unsigned int other : candidates) {
+        BoundingRegion& br = pool[other];
+        if (br.instance == obj.instance) {
+            // do not test collision with the same instance
+            continue;
+        }
+
+        if (pool.boxIntersects(other, min, max) && br.intersectsWith(obj) &&
+            NarrowPhase::test(br, obj, contact)) {
+            if (contacts) {
+                contacts->push_back(contact);
+            }
+            else {
+                NarrowPhase::resolve(contact);
+            }
+        }
+    }
+}
+
+// find regions intersecting box
+void AABBTree::queryBox(glm::vec3 min, glm::vec3 max, QueryCallback callback) {
+    BoundingRegion box(min, max);
+
+    std::vector<unsigned int> candidates;
+    query(min, max, candidates);
+
+    for (unsigned int other : candidates) {
+        if (pool.boxIntersects(other, min, max) && box.intersectsWith(pool[other])) {
+            callback(pool[other]);
+        }
+    }
+}
+
+// add shape of tree to statistics (leaves hold one object)
+void AABBTree::gatherStats(CollisionStats& stats) {
+    stats.pendingLength += (unsigned int)queue.size();
+    if (root == NULL_NODE) {
+        return;
+    }
+
+    // nodes to visit with their depth
+    std::vector<std::pair<unsigned int, unsigned int>> stack;
+    stack.push_back({ root, 0 });
+
+    while (stack.size() != 0) {
+        AABBTreeNode& node = nodes[stack.back().first];
+        unsigned int depth = stack.back().second;
+        stack.pop_back();
+
+        if (node.obj == NULL_BOUNDS) {
+            stats.addNode(depth, 0);
+            stack.push_back({ node.left, depth + 1 });
+            stack.push_back({ node.right, depth + 1 });
+        }
+        else {
+            stats.addNode(depth, 1);
+        }
+    }
+}
+
+// destroy object (free memory)
+void AABBTree::destroy() {
+    objects.clear();
+    while (queue.size() != 0) {
+        queue.pop();
+    }
+    nodes.clear();
+    freeNodes.clear();
+    root = NULL_NODE;
+    pool.clear();
+}
+
+/*
+    tree methods
+*/
+
+// get all regions whose fattened box intersects the box
+void AABBTree::query(glm::vec3 min, glm::vec3 max, std::vector<unsigned int>& out) {
+    if (root == NULL_NODE) {
+        return;
+    }
+
+    std::vector<unsigned int> stack;
+    stack.push_back(root);
+
+    while (stack.size() != 0) {
+        unsigned int idx = stack.back();
+        stack.pop_back();
+
+        AABBTreeNode& node = nodes[idx];
+        if (node.min.x > max.x || node.max.x < min.x ||
+            node.min.y > max.y || node.max.y < min.y ||
+            node.min.z > max.z || node.max.z < min.z) {
+            continue;
+        }
+
+        if (node.obj != NULL_BOUNDS) {
+            out.push_back(node.obj);
+        }
+        else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+// remove regions of dead instances
+void AABBTree::removeDead() {
+    // iterate backwards so swapped objects have already been checked
+    for (int i = (int)objects.size() - 1; i >= 0; i--) {
+        unsigned int obj = objects[i];
+        if (States::isActive(&pool[obj].instance->state, INSTANCE_DEAD)) {
+            unsigned int leaf = pool.hot[obj].cellIdx;
+            removeLeaf(leaf);
+            freeNode(leaf);
+            pool.release(obj);
+
+            objects[i] = objects.back();
+            objects.pop_back();
+        }
+    }
+}
+
+// get node from free list or append a new one
+unsigned int AABBTree::allocateNode() {
+    unsigned int idx;
+
+    if (freeNodes.size() != 0) {
+        idx = freeNodes.back();
+        freeNodes.pop_back();
+    }
+    else {
+        idx = (unsigned int)nodes.size();
+        nodes.push_back({});
+    }
+
+    nodes[idx].parent = NULL_NODE;
+    nodes[idx].left = NULL_NODE;
+    nodes[idx].right = NULL_NODE;
+    nodes[idx].obj = NULL_BOUNDS;
+    nodes[idx].height = 0;
+
+    return idx;
+}
+
+// return node to free list
+void AABBTree::freeNode(unsigned int idx) {
+    nodes[idx].height = -1;
+    freeNodes.push_back(idx);
+}
+
+// insert leaf by choosing the sibling with the lowest cost
+void AABBTree::insertLeaf(unsigned int leaf) {
+    if (root == NULL_NODE) {
+        root = leaf;
+        nodes[root].parent = NULL_NODE;
+        return;
+    }
+
+    glm::vec3 leafMin = nodes[leaf].min;
+    glm::vec3 leafMax = nodes[leaf].max;
+
+    // descend to the best sibling
+    unsigned int idx = root;
+    while (nodes[idx].obj == NULL_BOUNDS) {
+        AABBTreeNode& node = nodes[idx];
+
+        float nodeArea = area(node.min, node.max);
+        float combinedArea = area(glm::min(node.min, leafMin), glm::max(node.max, leafMax));
+
+        // cost of making a new parent for this node and the leaf
+        float cost = 2.0f * combinedArea;
+        // cost of pushing the leaf further down (each ancestor grows)
+        float inheritanceCost = 2.0f * (combinedArea - nodeArea);
+
+        float childCost[2];
+        unsigned int children[2] = { node.left, node.right };
+        for (int i = 0; i < 2; i++) {
+            AABBTreeNode& child = nodes[children[i]];
+            float childArea = area(glm::min(child.min, leafMin), glm::max(child.max, leafMax));
+            if (child.obj != NULL_BOUNDS) {
+                childCost[i] = childArea + inheritanceCost;
+            }
+            else {
+                childCost[i] = childArea - area(child.min, child.max) + inheritanceCost;
+            }
+        }
+
+        if (cost < childCost[0] && cost < childCost[1]) {
+            break;
+        }
+
+        idx = childCost[0] < childCost[1] ? children[0] : children[1];
+    }
+    unsigned int sibling = idx;
+
+    // create new parent (may reallocate storage)
+    unsigned int oldParent = nodes[sibling].parent;
+    unsigned int newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].min = glm::min(nodes[sibling].min, leafMin);
+    nodes[newParent].max = glm::max(nodes[sibling].max, leafMax);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].left = sibling;
+    nodes[newParent].right = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent != NULL_NODE) {
+        if (nodes[oldParent].left == sibling) {
+            nodes[oldParent].left = newParent;
+        }
+        else {
+            nodes[oldParent].right = newParent;
+        }
+    }
+    else {
+        root = newParent;
+    }
+
+    refit(newParent);
+}
+
+// remove leaf and collapse its parent
+void AABBTree::removeLeaf(unsigned int leaf) {
+    if (leaf == root) {
+        root = NULL_NODE;
+        return;
+    }
+
+    unsigned int parent = nodes[leaf].parent;
+    unsigned int grandParent = nodes[parent].parent;
+    unsigned int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+    // sibling takes the place of the parent
+    if (grandParent != NULL_NODE) {
+        if (nodes[grandParent].left == parent) {
+            nodes[grandParent].left = sibling;
+        }
+        else {
+            nodes[grandParent].right = sibling;
+        }
+        nodes[sibling].parent = grandParent;
+        freeNode(parent);
+
+        refit(grandParent);
+    }
+    else {
+        root = sibling;
+        nodes[sibling].parent = NULL_NODE;
+        freeNode(parent);
+    }
+
+    nodes[leaf].parent = NULL_NODE;
+}
+
+// rotate node if the heights of its children differ by more than one, returns new subtree root
+unsigned int AABBTree::balance(unsigned int iA) {
+    AABBTreeNode& A = nodes[iA];
+    if (A.obj != NULL_BOUNDS || A.height < 2) {
+        return iA;
+    }
+
+    unsigned int iB = A.left;
+    unsigned int iC = A.right;
+    AABBTreeNode& B = nodes[iB];
+    AABBTreeNode& C = nodes[iC];
+
+    int diff = C.height - B.height;
+
+    if (diff > 1) {
+        // rotate C up
+        unsigned int iF = C.left;
+        unsigned int iG = C.right;
+        AABBTreeNode& F = nodes[iF];
+        AABBTreeNode& G = nodes[iG];
+
+        // swap A and C
+        C.left = iA;
+        C.parent = A.parent;
+        A.parent = iC;
+
+        if (C.parent != NULL_NODE) {
+            if (nodes[C.parent].left == iA) {
+                nodes[C.parent].left = iC;
+            }
+            else {
+                nodes[C.parent].right = iC;
+            }
+        }
+        else {
+            root = iC;
+        }
+
+        // keep the taller grandchild under C
+        if (F.height > G.height) {
+            C.right = iF;
+            A.right = iG;
+            G.parent = iA;
+            A.min = glm::min(B.min, G.min);
+            A.max = glm::max(B.max, G.max);
+            C.min = glm::min(A.min, F.min);
+            C.max = glm::max(A.max, F.max);
+            A.height = 1 + std::max(B.height, G.height);
+            C.height = 1 + std::max(A.height, F.height);
+        }
+        else {
+            C.right = iG;
+            A.right = iF;
+            F.parent = iA;
+            A.min = glm::min(B.min, F.min);
+            A.max = glm::max(B.max, F.max);
+            C.min = glm::min(A.min, G.min);
+            C.max = glm::max(A.max, G.max);
+            A.height = 1 + std::max(B.height, F.height);
+            C.height = 1 + std::max(A.height, G.height);
+        }
+
+        return iC;
+    }
+
+    if (diff < -1) {
+        // rotate B up
+        unsigned int iD = B.left;
+        unsigned int iE = B.right;
+        AABBTreeNode& D = nodes[iD];
+        AABBTreeNode& E = nodes[iE];
+
+        // swap A and B
+        B.left = iA;
+        B.parent = A.parent;
+        A.parent = iB;
+
+        if (B.parent != NULL_NODE) {
+            if (nodes[B.parent].left == iA) {
+                nodes[B.parent].left = iB;
+            }
+            else {
+                nodes[B.parent].right = iB;
+            }
+        }
+        else {
+            root = iB;
+        }
+
+        // keep the taller grandchild under B
+        if (D.height > E.height) {
+            B.right = iD;
+            A.left = iE;
+            E.parent = iA;
+            A.min = glm::min(C.min, E.min);
+            A.max = glm::max(C.max, E.max);
+            B.min = glm::min(A.min, D.min);
+            B.max = glm::max(A.max, D.max);
+            A.height = 1 + std::max(C.height, E.height);
+            B.height = 1 + std::max(A.height, D.height);
+        }
+        else {
+            B.right = iE;
+            A.left = iD;
+            D.parent = iA;
+            A.min = glm::min(C.min, D.min);
+            A.max = glm::max(C.max, D.max);
+            B.min = glm::min(A.min, E.min);
+            B.max = glm::max(A.max, E.max);
+            A.height = 1 + std::max(C.height, D.height);
+            B.height = 1 + std::max(A.height, E.height);
+        }
+
+        return iB;
+    }
+
+    return iA;
+}
+
+// update box and height of nodes from idx to the root
+void AABBTree::refit(unsigned int idx) {
+    while (idx != NULL_NODE) {
+        idx = balance(idx);
+
+        AABBTreeNode& node = nodes[idx];
+        AABBTreeNode& left = nodes[node.left];
+        AABBTreeNode& right = nodes[node.right];
+
+        node.height = 1 + std::max(left.height, right.height);
+        node.min = glm::min(left.min, right.min);
+        node.max = glm::max(left.max, right.max);
+
+        idx = node.parent;
+    }
+}
+
+// surface area of a box
+float AABBTree::area(glm::vec3 min, glm::vec3 max) {
+    glm::vec3 d = max - min;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
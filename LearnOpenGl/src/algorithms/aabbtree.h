@@ -0,0 +1,129 @@
+#ifndef AABBTREE_H
+#define AABBTREE_H
+
+#include <vector>
+#include <queue>
+
+#include <glm/glm.hpp>
+
+#include "broadphase.h"
+#include "boundspool.h"
+
+// index representing no node
+#define NULL_NODE 0xffffffff
+
+/*
+	structure representing a node in the tree
+*/
+
+typedef struct AABBTreeNode {
+	// box enclosing the children (fattened box of the region for leaves)
+	glm::vec3 min;
+	glm::vec3 max;
+
+	// tree links
+	unsigned int parent;
+	unsigned int left;
+	unsigned int right;
+
+	// region index in pool (NULL_BOUNDS for internal nodes)
+	unsigned int obj;
+
+	// height of subtree (0 = leaf, -1 = free node)
+	int height;
+} AABBTreeNode;
+
+/*
+	class for a dynamic bounding volume tree
+	- each region is a leaf with a fattened box, only reinserted when it leaves that box
+	- the sibling for a new leaf is chosen by the increase in surface area
+	- tree rotations on the way back up keep the tree balanced
+*/
+
+class AABBTree : public BroadPhase {
+public:
+	// pool storing the regions
+	BoundsPool pool;
+
+	// list of regions in tree (indices in pool)
+	std::vector<unsigned int> objects;
+	// queue of regions to be inserted (indices in pool)
+	std::queue<unsigned int> queue;
+
+	// node storage
+	std::vector<AABBTreeNode> nodes;
+	// list of free nodes to be reused
+	std::vector<unsigned int> freeNodes;
+	// root node index
+	unsigned int root = NULL_NODE;
+
+	// distance leaf boxes are fattened by on each side
+	float margin = 0.2f;
+
+	/*
+		broad phase methods
+	*/
+
+	// add instance to pending queue
+	void addToPending(RigidBody* instance, PhysicsModel* model);
+
+	// process pending queue
+	void processPending();
+
+	// update objects and check collisions (called during each iteration of main loop)
+	void update(BoxList& box);
+
+	// check collisions with a ray
+	BoundingRegion* checkCollisionsRay(Ray r, float& tmin);
+
+	// check for any collision with a ray closer than tmax (returns first region found)
+	BoundingRegion* checkCollisionsRayAny(Ray r, float tmax);
+
+	// check collisions with a packet of rays
+	void checkCollisionsPacket(RayPacket& packet);
+
+	// check collisions of a region not stored in the structure
+	void checkCollisionsRegion(BoundingRegion& obj, std::vector<Contact>* contacts = nullptr);
+
+	// find regions intersecting box
+	void queryBox(glm::vec3 min, glm::vec3 max, QueryCallback callback);
+
+	// add shape of tree to statistics (leaves hold one object)
+	void gatherStats(CollisionStats& stats);
+
+	// destroy object (free memory)
+	void destroy();
+
+	/*
+		tree methods
+	*/
+
+	// get all regions whose fattened box intersects the box
+	void query(glm::vec3 min, glm::vec3 max, std::vector<unsigned int>& out);
+
+	// remove regions of dead instances
+	void removeDead();
+
+	// get node from free list or append a new one
+	unsigned int allocateNode();
+
+	// return node to free list
+	void freeNode(unsigned int idx);
+
+	// insert leaf by choosing the sibling with the lowest cost
+	void insertLeaf(unsigned int leaf);
+
+	// remove leaf and collapse its parent
+	void removeLeaf(unsigned int leaf);
+
+	// rotate node if the heights of its children differ by more than one, returns new subtree root
+	unsigned int balance(unsigned int iA);
+
+	// update box and height of nodes from idx to the root
+	void refit(unsigned int idx);
+
+	// surface area of a box
+	static float area(glm::vec3 min, glm::vec3 max);
+};
+
+#endif // !AABBTREE_H
@@ -1,22 +1,154 @@
 #include "bounds.h"
-#include "octree.h"
+#include "math/simd.h"
 #include "../physics/collisionmesh.h"
 
+#include <cmath>
+
+// number of edge axes tested together by the separating axis test (9 padded to a multiple of the simd width)
+#define EDGE_AXES_PADDED 16
+// added to the rotation between boxes so parallel edges do not give a zero axis
+#define SAT_EPSILON 1e-6f
+
+/*
+    oriented box helpers
+*/
+
+// box enclosing an oriented box
+static void enclosingBox(glm::vec3 center, glm::mat3& axes, glm::vec3 halfSize, glm::vec3& min, glm::vec3& max) {
+    glm::vec3 extent(0.0f);
+    for (int i = 0; i < 3; i++) {
+        extent += glm::abs(axes[i]) * halfSize[i];
+    }
+    min = center - extent;
+    max = center + extent;
+}
+
+// center, axes and half size of a box region (axis aligned boxes have the world axes)
+static void boxFrame(BoundingRegion& br, glm::vec3& center, glm::mat3& axes, glm::vec3& halfSize) {
+    if (br.type == BoundTypes::OBB) {
+        center = br.center;
+        axes = br.axes;
+        halfSize = br.halfSize;
+    }
+    else {
+        center = 0.5f * (br.min + br.max);
+        axes = glm::mat3(1.0f);
+        halfSize = 0.5f * (br.max - br.min);
+    }
+}
+
+// if oriented boxes overlap (separating axis test with the 6 face axes, then the 9 edge axes together)
+static bool boxesOverlap(glm::vec3 centerA, glm::mat3& axesA, glm::vec3 halfA, glm::vec3 centerB, glm::mat3& axesB, glm::vec3 halfB) {
+    // rows of the rotation of b in the frame of a
+    glm::vec3 R[3], AbsR[3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            R[i][j] = glm::dot(axesA[i], axesB[j]);
+            AbsR[i][j] = std::abs(R[i][j]) + SAT_EPSILON;
+        }
+    }
+
+    // center of b in the frame of a
+    glm::vec3 d = centerB - centerA;
+    glm::vec3 t(glm::dot(d, axesA[0]), glm::dot(d, axesA[1]), glm::dot(d, axesA[2]));
+
+    // face axes of a
+    for (int i = 0; i < 3; i++) {
+        if (std::abs(t[i]) > halfA[i] + glm::dot(halfB, AbsR[i])) {
+            return false;
+        }
+    }
+
+    // face axes of b
+    for (int j = 0; j < 3; j++) {
+        float ra = halfA[0] * AbsR[0][j] + halfA[1] * AbsR[1][j] + halfA[2] * AbsR[2][j];
+        float dist = t[0] * R[0][j] + t[1] * R[1][j] + t[2] * R[2][j];
+        if (std::abs(dist) > ra + halfB[j]) {
+            return false;
+        }
+    }
+
+    // edge axes (axis i of a crossed with axis j of b), padding lanes never separate
+    alignas(32) float ra[EDGE_AXES_PADDED] = {};
+    alignas(32) float rb[EDGE_AXES_PADDED] = {};
+    alignas(32) float dist[EDGE_AXES_PADDED] = {};
+    glm::vec3 halfB1(halfB.y, halfB.z, halfB.x);
+    glm::vec3 halfB2(halfB.z, halfB.x, halfB.y);
+    for (int i = 0; i < 3; i++) {
+        int i1 = (i + 1) % 3;
+        int i2 = (i + 2) % 3;
+
+        // lanes 3i to 3i + 2 hold the axes with j = 0, 1, 2
+        glm::vec3 rowA = halfA[i1] * AbsR[i2] + halfA[i2] * AbsR[i1];
+        glm::vec3 rowB = halfB1 * glm::vec3(AbsR[i].z, AbsR[i].x, AbsR[i].y) + halfB2 * glm::vec3(AbsR[i].y, AbsR[i].z, AbsR[i].x);
+        glm::vec3 rowDist = t[i2] * R[i1] - t[i1] * R[i2];
+        for (int j = 0; j < 3; j++) {
+            ra[3 * i + j] = rowA[j];
+            rb[3 * i + j] = rowB[j];
+            dist[3 * i + j] = rowDist[j];
+        }
+    }
+
+#ifdef SIMD_WIDTH
+    simd_float zero = simd_set1(0.0f);
+    for (int i = 0; i < 9; i += SIMD_WIDTH) {
+        // |dist| > ra + rb
+        simd_float dl = simd_load(dist + i);
+        simd_float absDist = simd_max(dl, simd_sub(zero, dl));
+        if (simd_mask(simd_gt(absDist, simd_add(simd_load(ra + i), simd_load(rb + i))))) {
+            return false;
+        }
+    }
+#else
+    for (int i = 0; i < 9; i++) {
+        if (std::abs(dist[i]) > ra[i] + rb[i]) {
+            return false;
+        }
+    }
+#endif
+
+    // no separating axis
+    return true;
+}
+
+// if sphere overlaps oriented box (closest point of the box in its own frame)
+static bool sphereOverlapsBox(glm::vec3 sphereCenter, float radius, glm::vec3 center, glm::mat3& axes, glm::vec3 halfSize) {
+    glm::vec3 d = sphereCenter - center;
+    float distSquared = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        float local = glm::dot(d, axes[i]);
+        float outside = std::abs(local) - halfSize[i];
+        if (outside > 0.0f) {
+            distSquared += outside * outside;
+        }
+    }
+    return distSquared <= radius * radius;
+}
+
 /*
         Constructors
 */
 
 // initialize with type
 BoundingRegion::BoundingRegion(BoundTypes type)
-    : type(type) {}
+    : type(type), instance(nullptr), collisionMesh(nullptr) {}
 
 // initialize as sphere
 BoundingRegion::BoundingRegion(glm::vec3 center, float radius)
-    : type(BoundTypes::SPHERE), center(center), ogCenter(center), radius(radius), ogRadius(radius) {}
+    : type(BoundTypes::SPHERE), instance(nullptr), collisionMesh(nullptr),
+    center(center), radius(radius), ogCenter(center), ogRadius(radius) {}
 
-// initialize as AABB
-BoundingRegion::BoundingRegion(glm::vec3 min, glm::vec3 max)
-    : type(BoundTypes::AABB), min(min), ogMin(min), max(max), ogMax(max) {}
+// initialize as AABB (or OBB, box is then in object space)
+BoundingRegion::BoundingRegion(glm::vec3 min, glm::vec3 max, BoundTypes type)
+    : type(type), instance(nullptr), collisionMesh(nullptr),
+    min(min), max(max), ogMin(min), ogMax(max) {
+    if (type == BoundTypes::OBB) {
+        // not rotated until transformed for an instance
+        center = 0.5f * (min + max);
+        axes = glm::mat3(1.0f);
+        halfSize = 0.5f * (max - min);
+    }
+}
 
 /*
     Calculating values for the region
@@ -25,17 +157,27 @@ BoundingRegion::BoundingRegion(glm::vec3 min, glm::vec3 max)
 // transform for instance
 void BoundingRegion::transform() {
     if (instance) {
+        glm::vec3 pos = instance->getPos();
+        glm::vec3 size = instance->getSize();
+
         if (type == BoundTypes::AABB) {
-            min = ogMin * instance->size + instance->pos;
-            max = ogMax * instance->size + instance->pos;
+            min = ogMin * size + pos;
+            max = ogMax * size + pos;
+        }
+        else if (type == BoundTypes::OBB) {
+            // scaled, rotated and moved with the instance
+            axes = instance->getRotationMatrix();
+            center = axes * (0.5f * (ogMin + ogMax) * size) + pos;
+            halfSize = 0.5f * (ogMax - ogMin) * size;
+            enclosingBox(center, axes, halfSize, min, max);
         }
         else {
-            center = ogCenter * instance->size + instance->pos;
+            center = ogCenter * size + pos;
 
-            float maxDim = instance->size[0];
+            float maxDim = size[0];
             for (int i = 1; i < 3; i++) {
-                if (instance->size[i] > maxDim) {
-                    maxDim = instance->size[i];
+                if (size[i] > maxDim) {
+                    maxDim = size[i];
                 }
             }
 
@@ -46,12 +188,12 @@ void BoundingRegion::transform() {
 
 // center
 glm::vec3 BoundingRegion::calculateCenter() {
-    return (type == BoundTypes::AABB) ? (min + max) / 2.0f : center;
+    return (type == BoundTypes::SPHERE) ? center : (min + max) / 2.0f;
 }
 
 // calculate dimensions
 glm::vec3 BoundingRegion::calculateDimensions() {
-    return (type == BoundTypes::AABB) ? (max - min) : glm::vec3(2.0f * radius);
+    return (type == BoundTypes::SPHERE) ? glm::vec3(2.0f * radius) : (max - min);
 }
 
 /*
@@ -66,6 +208,16 @@ bool BoundingRegion::containsPoint(glm::vec3 pt) {
             (pt.y >= min.y) && (pt.y <= max.y) &&
             (pt.z >= min.z) && (pt.z <= max.z);
     }
+    else if (type == BoundTypes::OBB) {
+        // box - point in the frame of the box must be within the half size
+        glm::vec3 d = pt - center;
+        for (int i = 0; i < 3; i++) {
+            if (std::abs(glm::dot(d, axes[i])) > halfSize[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
     else {
         // sphere - distance must be less than radius
         // x^2 + y^2 + z^2 <= r^2
@@ -78,9 +230,36 @@ bool BoundingRegion::containsPoint(glm::vec3 pt) {
 }
 
 // determine if region completely inside
-bool BoundingRegion::containsRegion(BoundingRegion br) {
-    if (br.type == BoundTypes::AABB) {
-        // if br is a box, just has to contain min and max
+bool BoundingRegion::containsRegion(BoundingRegion& br) {
+    if (type == BoundTypes::OBB) {
+        if (br.type == BoundTypes::SPHERE) {
+            // sphere has to be within the half size in the frame of the box
+            glm::vec3 d = br.center - center;
+            for (int i = 0; i < 3; i++) {
+                if (std::abs(glm::dot(d, axes[i])) + br.radius > halfSize[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // box has to have all corners inside
+        glm::vec3 brCenter, brHalfSize;
+        glm::mat3 brAxes;
+        boxFrame(br, brCenter, brAxes, brHalfSize);
+        for (int i = 0; i < 8; i++) {
+            glm::vec3 corner = brCenter;
+            for (int j = 0; j < 3; j++) {
+                corner += brAxes[j] * ((i & (1 << j)) ? brHalfSize[j] : -brHalfSize[j]);
+            }
+            if (!containsPoint(corner)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    else if (br.type != BoundTypes::SPHERE) {
+        // if br is a box, just has to contain min and max (box enclosing an OBB)
         return containsPoint(br.min) && containsPoint(br.max);
     }
     else if (type == BoundTypes::SPHERE && br.type == BoundTypes::SPHERE) {
@@ -112,9 +291,28 @@ bool BoundingRegion::containsRegion(BoundingRegion br) {
 }
 
 // determine if region intersects (partial containment)
-bool BoundingRegion::intersectsWith(BoundingRegion br) {
+bool BoundingRegion::intersectsWith(BoundingRegion& br) {
     // overlap on all axes
 
+    if (type == BoundTypes::OBB || br.type == BoundTypes::OBB) {
+        // at least one oriented box
+        glm::vec3 centerA, halfA, centerB, halfB;
+        glm::mat3 axesA, axesB;
+
+        if (type == BoundTypes::SPHERE) {
+            boxFrame(br, centerB, axesB, halfB);
+            return sphereOverlapsBox(center, radius, centerB, axesB, halfB);
+        }
+        else if (br.type == BoundTypes::SPHERE) {
+            return br.intersectsWith(*this);
+        }
+
+        // separating axis test
+        boxFrame(*this, centerA, axesA, halfA);
+        boxFrame(br, centerB, axesB, halfB);
+        return boxesOverlap(centerA, axesA, halfA, centerB, axesB, halfB);
+    }
+
     if (type == BoundTypes::AABB && br.type == BoundTypes::AABB) {
         // both boxes
 
@@ -178,6 +376,9 @@ bool BoundingRegion::operator==(BoundingRegion br) {
     if (type == BoundTypes::AABB) {
         return min == br.min && max == br.max;
     }
+    else if (type == BoundTypes::OBB) {
+        return center == br.center && axes == br.axes && halfSize == br.halfSize;
+    }
     else {
         return center == br.center && radius == br.radius;
     }
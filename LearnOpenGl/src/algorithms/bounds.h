@@ -6,9 +6,6 @@
 #include "../physics/rigidbody.h"
 
 // forward declaration
-namespace Octree {
-	class node;
-}
 class CollisionMesh;
 
 /*
@@ -17,7 +14,8 @@ class CollisionMesh;
 
 enum class BoundTypes : unsigned char {
 	AABB = 0x00, // 0x00 = 0 // Axis-aligned bounding box
-	SPHERE = 0x01 // 0x01 = 1
+	SPHERE = 0x01, // 0x01 = 1
+	OBB = 0x02 // 0x02 = 2 // Oriented bounding box (rotates with the instance)
 };
 
 /*
@@ -33,9 +31,6 @@ public:
 	RigidBody* instance;
 	CollisionMesh* collisionMesh;
 
-	// pointer to the quick access to the current octree node
-	Octree::node* cell;
-
 	// sphere values
 	glm::vec3 center;
 	float radius;
@@ -50,6 +45,10 @@ public:
 	glm::vec3 ogMin;
 	glm::vec3 ogMax;
 
+	// oriented box values (center is shared with the sphere, min and max hold the box enclosing it)
+	glm::mat3 axes;
+	glm::vec3 halfSize;
+
 	/*
 		Constructers
 	*/
@@ -60,8 +59,8 @@ public:
 	// initalize with sphere
 	BoundingRegion(glm::vec3 center, float radius);
 
-	// inialize with AABB
-	BoundingRegion(glm::vec3 min, glm::vec3 max);
+	// inialize with AABB (or OBB, box is then in object space)
+	BoundingRegion(glm::vec3 min, glm::vec3 max, BoundTypes type = BoundTypes::AABB);
 
 	/*
 		Calculating values for the region	
@@ -84,10 +83,10 @@ public:
 	bool containsPoint(glm::vec3 pt);
 
 	// determine if region completly inside region
-	bool containsRegion(BoundingRegion br);
+	bool containsRegion(BoundingRegion& br);
 
 	// determine if region intersects (partial contains)
-	bool intersectsWith(BoundingRegion br);
+	bool intersectsWith(BoundingRegion& br);
 
 	// operator overload
 	bool operator==(BoundingRegion br);
@@ -0,0 +1,102 @@
+#include "boundspool.h"
+
+/*
+    slot management
+*/
+
+// store region and return its index
+unsigned int BoundsPool::allocate(BoundingRegion& br) {
+    unsigned int idx;
+
+    if (freeSlots.size() != 0) {
+        // reuse released slot
+        idx = freeSlots.back();
+        freeSlots.pop_back();
+        regions[idx] = br;
+    }
+    else {
+        // append new slot
+        idx = (unsigned int)regions.size();
+        regions.push_back(br);
+        hot.push_back({});
+    }
+
+    hot[idx].cell = nullptr;
+    hot[idx].cellIdx = NULL_BOUNDS;
+    updateHot(idx);
+
+    return idx;
+}
+
+// release slot so it can be reused
+void BoundsPool::release(unsigned int idx) {
+    hot[idx].cell = nullptr;
+    hot[idx].cellIdx = NULL_BOUNDS;
+    regions[idx].instance = nullptr;
+    freeSlots.push_back(idx);
+}
+
+// release all slots
+void BoundsPool::clear() {
+    hot.clear();
+    regions.clear();
+    freeSlots.clear();
+}
+
+// number of slots in use
+unsigned int BoundsPool::size() {
+    return (unsigned int)(regions.size() - freeSlots.size());
+}
+
+/*
+    region methods
+*/
+
+// transform region for its instance and update hot data
+void BoundsPool::transform(unsigned int idx) {
+    regions[idx].transform();
+    updateHot(idx);
+}
+
+// update hot data from the region
+void BoundsPool::updateHot(unsigned int idx) {
+    calculateBox(regions[idx], hot[idx].min, hot[idx].max);
+}
+
+// coarse test using the world space boxes
+bool BoundsPool::boxesIntersect(unsigned int idx1, unsigned int idx2) {
+    BoundsHot& a = hot[idx1];
+    BoundsHot& b = hot[idx2];
+
+    return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+        a.min.y <= b.max.y && a.max.y >= b.min.y &&
+        a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+// coarse test of a slot against a world space box
+bool BoundsPool::boxIntersects(unsigned int idx, glm::vec3 min, glm::vec3 max) {
+    BoundsHot& a = hot[idx];
+
+    return a.min.x <= max.x && a.max.x >= min.x &&
+        a.min.y <= max.y && a.max.y >= min.y &&
+        a.min.z <= max.z && a.max.z >= min.z;
+}
+
+// calculate world space box enclosing a (transformed) region
+void BoundsPool::calculateBox(BoundingRegion& br, glm::vec3& min, glm::vec3& max) {
+    if (br.type != BoundTypes::SPHERE) {
+        // boxes (OBBs keep their enclosing box)
+        min = br.min;
+        max = br.max;
+    }
+    else {
+        // box enclosing the sphere
+        min = br.center - glm::vec3(br.radius);
+        max = br.center + glm::vec3(br.radius);
+    }
+}
+
+// access the full region
+BoundingRegion& BoundsPool::operator[](unsigned int idx) {
+    return regions[idx];
+}
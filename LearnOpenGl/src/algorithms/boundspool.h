@@ -0,0 +1,88 @@
+#ifndef BOUNDSPOOL_H
+#define BOUNDSPOOL_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "bounds.h"
+
+// index representing an empty slot
+#define NULL_BOUNDS 0xffffffff
+
+// forward declaration
+namespace Octree {
+	class node;
+}
+
+/*
+	structure holding the values read on every traversal (hot data)
+*/
+
+typedef struct BoundsHot {
+	// world space box enclosing the region
+	glm::vec3 min;
+	glm::vec3 max;
+
+	// node the region is stored in
+	Octree::node* cell;
+	// position of the region in the node's object list (leaf node index in an AABB tree)
+	unsigned int cellIdx;
+} BoundsHot;
+
+/*
+	class to store all bounding regions of a spatial structure in one place
+	- structures reference regions by index instead of storing copies
+	- hot data is stored separate from the full region (original values, instance, collision mesh)
+*/
+
+class BoundsPool {
+public:
+	// hot data of each slot
+	std::vector<BoundsHot> hot;
+	// full region of each slot (cold data)
+	std::vector<BoundingRegion> regions;
+
+	// list of released slots to be reused
+	std::vector<unsigned int> freeSlots;
+
+	/*
+		slot management
+	*/
+
+	// store region and return its index
+	unsigned int allocate(BoundingRegion& br);
+
+	// release slot so it can be reused
+	void release(unsigned int idx);
+
+	// release all slots
+	void clear();
+
+	// number of slots in use
+	unsigned int size();
+
+	/*
+		region methods
+	*/
+
+	// transform region for its instance and update hot data
+	void transform(unsigned int idx);
+
+	// update hot data from the region
+	void updateHot(unsigned int idx);
+
+	// coarse test using the world space boxes
+	bool boxesIntersect(unsigned int idx1, unsigned int idx2);
+
+	// coarse test of a slot against a world space box
+	bool boxIntersects(unsigned int idx, glm::vec3 min, glm::vec3 max);
+
+	// calculate world space box enclosing a (transformed) region
+	static void calculateBox(BoundingRegion& br, glm::vec3& min, glm::vec3& max);
+
+	// access the full region
+	BoundingRegion& operator[](unsigned int idx);
+};
+
+#endif // !BOUNDSPOOL_H
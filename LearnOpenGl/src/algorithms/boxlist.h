@@ -0,0 +1,21 @@
+#ifndef BOXLIST_H
+#define BOXLIST_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/*
+	class to represent a list of boxes to outline
+	- filled by the broad phase while updating (regions of nodes/objects), drawn by Box
+*/
+
+class BoxList {
+public:
+	// centers of boxes
+	std::vector<glm::vec3> positions;
+	// dimensions of boxes
+	std::vector<glm::vec3> sizes;
+};
+
+#endif // !BOXLIST_H
@@ -0,0 +1,99 @@
+#include "broadphase.h"
+#include "aabbtree.h"
+#include "octree.h"
+#include "splitoctree.h"
+#include "sweepandprune.h"
+#include "uniformgrid.h"
+
+#include "../physics/narrowphase.h"
+
+// create broad phase of type (root of its static octree is set in octree if there is one)
+BroadPhase* BroadPhase::create(BroadPhaseType type, Octree::node** octree) {
+    BoundingRegion bounds(glm::vec3(-WORLD_BOUNDS), glm::vec3(WORLD_BOUNDS));
+    Octree::node* root = nullptr;
+    BroadPhase* ret = nullptr;
+
+    switch (type) {
+    case BroadPhaseType::SWEEP_AND_PRUNE:
+        ret = new SweepAndPrune();
+        break;
+    case BroadPhaseType::AABB_TREE:
+        ret = new AABBTree();
+        break;
+    case BroadPhaseType::LOOSE_OCTREE:
+        root = new Octree::node(bounds, LOOSENESS);
+        ret = root;
+        break;
+    case BroadPhaseType::GRID_OCTREE:
+        // projectiles in the grid, everything else in the octree
+        root = new Octree::node(bounds);
+        ret = new UniformGrid(root);
+        break;
+    case BroadPhaseType::SPLIT_OCTREE:
+        // moving instances in a loose octree, everything else in a strict octree built once
+        root = new Octree::node(bounds);
+        ret = new SplitOctree(root, new Octree::node(bounds, LOOSENESS));
+        break;
+    case BroadPhaseType::OCTREE:
+    default:
+        root = new Octree::node(bounds);
+        ret = root;
+        break;
+    }
+
+    if (octree) {
+        *octree = root;
+    }
+    return ret;
+}
+
+// check for any collision with a ray closer than tmax (returns first region found, for shadow/visibility queries)
+// default looks for the closest hit
+BoundingRegion* BroadPhase::checkCollisionsRayAny(Ray r, float tmax) {
+    return checkCollisionsRay(r, tmax);
+}
+
+// check collisions with a packet of rays (closest hits are kept in the packet)
+// default tests each ray on its own
+void BroadPhase::checkCollisionsPacket(RayPacket& packet) {
+    for (unsigned int i = 0; i < packet.count; i++) {
+        float tmin = packet.t[i];
+        BoundingRegion* hit = checkCollisionsRay(packet.getRay(i), tmin);
+        if (hit) {
+            packet.t[i] = tmin;
+            packet.hits[i] = hit;
+        }
+    }
+}
+
+// instance was marked for deletion (its regions are removed on the next update)
+// default does nothing, structures that scan their objects every frame find dead instances themselves
+void BroadPhase::markDead(RigidBody* /*instance*/) {}
+
+// add shape of structure to statistics (nodes, objects, pending queue)
+// default adds nothing
+void BroadPhase::gatherStats(CollisionStats& /*stats*/) {}
+
+// test items [0, count) (in chunks on the workers if there are any), then resolve the contacts in item order
+// contacts are only resolved once all tests are done, so serial and parallel runs test the same pairs with the same results
+void BroadPhase::checkCollisionsList(unsigned int count, TestCallback test) {
+    // list of contacts for each chunk of items
+    std::vector<std::vector<Contact>> chunkContacts(workers ? workers->size() : 1);
+
+    if (workers) {
+        // structures are only read while testing
+        workers->parallelFor(count, [&](unsigned int start, unsigned int end, unsigned int chunk) -> void {
+            test(start, end, chunkContacts[chunk]);
+        });
+    }
+    else {
+        test(0, count, chunkContacts[0]);
+    }
+
+    // chunks are contiguous ranges of the list, so merging in chunk order keeps the order of the items
+    for (std::vector<Contact>& contacts : chunkContacts) {
+        for (Contact& contact : contacts) {
+            NarrowPhase::resolve(contact);
+        }
+    }
+}
@@ -0,0 +1,101 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include <functional>
+#include <vector>
+
+#include "bounds.h"
+#include "collisionstats.h"
+#include "ray.h"
+#include "raypacket.h"
+#include "threadpool.h"
+
+// half size of the region covered by the broad phase structures
+#define WORLD_BOUNDS 36.0f
+
+// forward declaration
+namespace Octree {
+	class node;
+}
+class PhysicsModel;
+class BoxList;
+class RigidBody;
+struct Contact;
+
+/*
+	enum for available broad phase structures
+*/
+
+enum class BroadPhaseType : unsigned char {
+	OCTREE = 0x00,
+	SWEEP_AND_PRUNE = 0x01,
+	AABB_TREE = 0x02,
+	LOOSE_OCTREE = 0x03,
+	GRID_OCTREE = 0x04,
+	SPLIT_OCTREE = 0x05
+};
+
+/*
+	interface for the structures finding potentially colliding instances
+	- the scene only talks to its broad phase through these methods
+*/
+
+class BroadPhase {
+public:
+	// callback for each region found by a query
+	typedef std::function<void(BoundingRegion&)> QueryCallback;
+	// callback testing items [start, end) of a list of moved objects or pairs, contacts found are added to the list
+	typedef std::function<void(unsigned int, unsigned int, std::vector<Contact>&)> TestCallback;
+
+	// worker pool for parallel collision detection (nullptr = serial)
+	ThreadPool* workers = nullptr;
+
+	virtual ~BroadPhase() {}
+
+	// create broad phase of type (root of its static octree is set in octree if there is one)
+	static BroadPhase* create(BroadPhaseType type, Octree::node** octree = nullptr);
+
+	// add instance to pending queue
+	virtual void addToPending(RigidBody* instance, PhysicsModel* model) = 0;
+
+	// process pending queue
+	virtual void processPending() = 0;
+
+	// update objects and check collisions (called during each iteration of main loop)
+	virtual void update(BoxList& box) = 0;
+
+	// check collisions with a ray
+	virtual BoundingRegion* checkCollisionsRay(Ray r, float& tmin) = 0;
+
+	// check for any collision with a ray closer than tmax (returns first region found, for shadow/visibility queries)
+	// default looks for the closest hit
+	virtual BoundingRegion* checkCollisionsRayAny(Ray r, float tmax);
+
+	// check collisions with a packet of rays (closest hits are kept in the packet)
+	// default tests each ray on its own
+	virtual void checkCollisionsPacket(RayPacket& packet);
+
+	// check collisions of a region not stored in the structure (region is the moved object)
+	// contacts are gathered into list if given, otherwise resolved immediately
+	virtual void checkCollisionsRegion(BoundingRegion& obj, std::vector<Contact>* contacts = nullptr) = 0;
+
+	// find regions intersecting box (no narrow phase tests, for swept volumes and range queries)
+	virtual void queryBox(glm::vec3 min, glm::vec3 max, QueryCallback callback) = 0;
+
+	// instance was marked for deletion (its regions are removed on the next update)
+	// default does nothing, structures that scan their objects every frame find dead instances themselves
+	virtual void markDead(RigidBody* instance);
+
+	// add shape of structure to statistics (nodes, objects, pending queue)
+	// default adds nothing
+	virtual void gatherStats(CollisionStats& stats);
+
+	// destroy object (free memory)
+	virtual void destroy() = 0;
+
+	// test items [0, count) (in chunks on the workers if there are any), then resolve the contacts in item order
+	// contacts are only resolved once all tests are done, so serial and parallel runs test the same pairs with the same results
+	void checkCollisionsList(unsigned int count, TestCallback test);
+};
+
+#endif // !BROADPHASE_H
@@ -0,0 +1,191 @@
+#include "collisionstats.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+// counters of current frame
+std::atomic<unsigned int> Stats::counters[Stats::NO_COUNTERS];
+
+/*
+    collecting
+*/
+
+// reset shape values before gathering them
+void CollisionStats::clearShape() {
+    noNodes = 0;
+    depthHistogram.clear();
+    objectsHistogram.assign(STATS_OBJECT_BUCKETS, 0);
+    noObjects = 0;
+    maxObjectsPerNode = 0;
+    pendingLength = 0;
+    noBlocksInUse = 0;
+    noBlocksAllocated = 0;
+}
+
+// add node at depth holding number of objects
+void CollisionStats::addNode(unsigned int depth, unsigned int noNodeObjects) {
+    noNodes++;
+
+    if (depth >= depthHistogram.size()) {
+        depthHistogram.resize(depth + 1, 0);
+    }
+    depthHistogram[depth]++;
+
+    if (objectsHistogram.size() != STATS_OBJECT_BUCKETS) {
+        objectsHistogram.assign(STATS_OBJECT_BUCKETS, 0);
+    }
+    objectsHistogram[std::min(noNodeObjects, (unsigned int)STATS_OBJECT_BUCKETS - 1)]++;
+
+    noObjects += noNodeObjects;
+    maxObjectsPerNode = std::max(maxObjectsPerNode, noNodeObjects);
+}
+
+// copy counters of the frame and reset them
+void CollisionStats::takeCounters() {
+    reinsertions = Stats::counters[Stats::REINSERTIONS].exchange(0, std::memory_order_relaxed);
+    parentWalks = Stats::counters[Stats::PARENT_WALKS].exchange(0, std::memory_order_relaxed);
+    pairTests = Stats::counters[Stats::PAIR_TESTS].exchange(0, std::memory_order_relaxed);
+    faceTests = Stats::counters[Stats::FACE_TESTS].exchange(0, std::memory_order_relaxed);
+}
+
+// add values of the frame to the summary
+void CollisionStats::record() {
+    if (noRecorded == 0) {
+        firstRecorded = frame;
+    }
+    lastRecorded = frame;
+
+    summary["noNodes"].add(noNodes, noRecorded);
+    summary["noObjects"].add(noObjects, noRecorded);
+    summary["objectsPerNode"].add(objectsPerNode(), noRecorded);
+    summary["maxObjectsPerNode"].add(maxObjectsPerNode, noRecorded);
+    summary["pendingLength"].add(pendingLength, noRecorded);
+    summary["nodePoolOccupancy"].add(nodePoolOccupancy(), noRecorded);
+    summary["reinsertions"].add(reinsertions, noRecorded);
+    summary["parentWalks"].add(parentWalks, noRecorded);
+    summary["pairTests"].add(pairTests, noRecorded);
+    summary["faceTests"].add(faceTests, noRecorded);
+    summary["pendingTime"].add(pendingTime, noRecorded);
+    summary["updateTime"].add(updateTime, noRecorded);
+    summary["responseTime"].add(responseTime, noRecorded);
+
+    // histograms
+    auto addHistogram = [](std::vector<unsigned int>& total, std::vector<unsigned int>& values) -> void {
+        if (values.size() > total.size()) {
+            total.resize(values.size(), 0);
+        }
+        for (unsigned int i = 0; i < values.size(); i++) {
+            total[i] += values[i];
+        }
+    };
+    addHistogram(depthHistogramTotal, depthHistogram);
+    addHistogram(objectsHistogramTotal, objectsHistogram);
+
+    noRecorded++;
+}
+
+// reset summary before recording
+void CollisionStats::clearSummary() {
+    noRecorded = 0;
+    firstRecorded = 0;
+    lastRecorded = 0;
+    summary.clear();
+    depthHistogramTotal.clear();
+    objectsHistogramTotal.clear();
+}
+
+/*
+    output
+*/
+
+// get average number of objects per node
+float CollisionStats::objectsPerNode() {
+    return noNodes == 0 ? 0.0f : (float)noObjects / (float)noNodes;
+}
+
+// get fraction of allocated node blocks handed out
+float CollisionStats::nodePoolOccupancy() {
+    return noBlocksAllocated == 0 ? 0.0f : (float)noBlocksInUse / (float)noBlocksAllocated;
+}
+
+// write summary of recorded frames as JSON object to file
+bool CollisionStats::writeJSON(std::string path) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << std::setprecision(10);
+
+    // histograms are written as arrays of counts
+    auto histogram = [](std::vector<unsigned int>& values) -> std::string {
+        std::stringstream ret;
+        ret << '[';
+        for (unsigned int i = 0; i < values.size(); i++) {
+            ret << (i ? ", " : "") << values[i];
+        }
+        ret << ']';
+        return ret.str();
+    };
+
+    file << "{\n"
+        << "    \"noFrames\": " << noRecorded << ",\n"
+        << "    \"firstFrame\": " << firstRecorded << ",\n"
+        << "    \"lastFrame\": " << lastRecorded << ",\n"
+        << "    \"depthHistogram\": " << histogram(depthHistogramTotal) << ",\n"
+        << "    \"objectsHistogram\": " << histogram(objectsHistogramTotal);
+
+    // total, min, max and mean of each value
+    for (std::pair<const std::string, StatsSummary>& val : summary) {
+        file << ",\n    \"" << val.first << "\": { "
+            << "\"total\": " << val.second.total << ", "
+            << "\"min\": " << val.second.min << ", "
+            << "\"max\": " << val.second.max << ", "
+            << "\"mean\": " << (noRecorded == 0 ? 0.0 : val.second.total / (double)noRecorded) << " }";
+    }
+    file << "\n}\n";
+
+    return file.good();
+}
+
+// append values as CSV row to file (header is written to new files)
+bool CollisionStats::appendCSV(std::string path) {
+    // header is written to missing or empty files (position of a stream opened for appending is not reliable)
+    bool newFile = true;
+    {
+        std::ifstream existing(path, std::ios::binary | std::ios::ate);
+        if (existing.is_open() && existing.tellg() > 0) {
+            newFile = false;
+        }
+    }
+
+    std::ofstream file(path, std::ios::app);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    if (newFile) {
+        file << "frame,noNodes,depthHistogram,objectsHistogram,noObjects,objectsPerNode,maxObjectsPerNode,"
+            << "pendingLength,nodePoolOccupancy,reinsertions,parentWalks,pairTests,faceTests,"
+            << "pendingTime,updateTime,responseTime\n";
+    }
+
+    // histograms are written as one column of values separated by spaces
+    auto histogram = [](std::vector<unsigned int>& values) -> std::string {
+        std::stringstream ret;
+        for (unsigned int i = 0; i < values.size(); i++) {
+            ret << (i ? " " : "") << values[i];
+        }
+        return ret.str();
+    };
+
+    file << frame << ',' << noNodes << ',' << histogram(depthHistogram) << ',' << histogram(objectsHistogram) << ','
+        << noObjects << ',' << objectsPerNode() << ',' << maxObjectsPerNode << ','
+        << pendingLength << ',' << nodePoolOccupancy() << ',' << reinsertions << ',' << parentWalks << ','
+        << pairTests << ',' << faceTests << ','
+        << pendingTime << ',' << updateTime << ',' << responseTime << '\n';
+
+    return file.good();
+}
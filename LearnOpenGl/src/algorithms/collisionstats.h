@@ -0,0 +1,160 @@
+#ifndef COLLISIONSTATS_H
+#define COLLISIONSTATS_H
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+
+// number of buckets in the objects per node histogram (last bucket counts nodes with at least that many)
+#define STATS_OBJECT_BUCKETS 9
+
+/*
+	namespace to tie together the counters incremented by the collision code
+	- counters are atomic so the parallel paths can add to them
+	- they are read and reset once per frame by the scene
+*/
+
+namespace Stats {
+	/*
+		enum for counters
+	*/
+
+	enum Counter : unsigned char {
+		REINSERTIONS = 0,	// moved objects queued for another node in update()
+		PARENT_WALKS,		// steps up the tree looking for a node enclosing a moved object
+		PAIR_TESTS,			// pairs passed from the broad phase to the narrow phase
+		FACE_TESTS,			// collision mesh face tests in the narrow phase
+		NO_COUNTERS
+	};
+
+	// counters of current frame
+	extern std::atomic<unsigned int> counters[NO_COUNTERS];
+
+	// add to counter (safe from any thread)
+	inline void add(Counter counter, unsigned int n = 1) {
+		counters[counter].fetch_add(n, std::memory_order_relaxed);
+	}
+}
+
+/*
+	structure accumulating one value over the recorded frames
+*/
+
+typedef struct StatsSummary {
+	double total = 0.0;
+	double min = 0.0;
+	double max = 0.0;
+
+	// add value of frame (first is the number of frames added before)
+	void add(double val, unsigned int first) {
+		total += val;
+		min = first == 0 || val < min ? val : min;
+		max = first == 0 || val > max ? val : max;
+	}
+} StatsSummary;
+
+/*
+	class holding the statistics of the spatial subsystem for one frame
+	- counters and timings are taken every frame
+	- shape values are only gathered on request (requires a walk of the structure)
+	- recorded frames are accumulated into a summary (totals, minimums, maximums and means)
+*/
+
+class CollisionStats {
+public:
+	// frame the values belong to
+	unsigned int frame = 0;
+
+	/*
+		shape of structure
+	*/
+
+	// number of nodes
+	unsigned int noNodes = 0;
+	// number of nodes at each depth
+	std::vector<unsigned int> depthHistogram;
+	// number of nodes by number of objects they hold
+	std::vector<unsigned int> objectsHistogram;
+	// number of objects stored
+	unsigned int noObjects = 0;
+	// most objects in one node
+	unsigned int maxObjectsPerNode = 0;
+	// number of objects waiting to be inserted
+	unsigned int pendingLength = 0;
+	// node blocks handed out and allocated by the node pools
+	unsigned int noBlocksInUse = 0;
+	unsigned int noBlocksAllocated = 0;
+
+	/*
+		counters
+	*/
+
+	unsigned int reinsertions = 0;
+	unsigned int parentWalks = 0;
+	unsigned int pairTests = 0;
+	unsigned int faceTests = 0;
+
+	/*
+		timings of phases (milliseconds)
+	*/
+
+	// processing pending queues
+	double pendingTime = 0.0;
+	// broad phase update (including narrow phase tests)
+	double updateTime = 0.0;
+	// contact events and responses
+	double responseTime = 0.0;
+
+	/*
+		summary of recorded frames
+	*/
+
+	// number of frames recorded
+	unsigned int noRecorded = 0;
+	// first and last frame recorded
+	unsigned int firstRecorded = 0;
+	unsigned int lastRecorded = 0;
+	// values accumulated by name
+	std::map<std::string, StatsSummary> summary;
+	// histograms summed over the recorded frames
+	std::vector<unsigned int> depthHistogramTotal;
+	std::vector<unsigned int> objectsHistogramTotal;
+
+	/*
+		collecting
+	*/
+
+	// reset shape values before gathering them
+	void clearShape();
+
+	// add node at depth holding number of objects
+	void addNode(unsigned int depth, unsigned int noNodeObjects);
+
+	// copy counters of the frame and reset them
+	void takeCounters();
+
+	// add values of the frame to the summary
+	void record();
+
+	// reset summary before recording
+	void clearSummary();
+
+	/*
+		output
+	*/
+
+	// get average number of objects per node
+	float objectsPerNode();
+
+	// get fraction of allocated node blocks handed out
+	float nodePoolOccupancy();
+
+	// write summary of recorded frames as JSON object to file
+	bool writeJSON(std::string path);
+
+	// append values as CSV row to file (header is written to new files)
+	bool appendCSV(std::string path);
+};
+
+#endif // !COLLISIONSTATS_H
@@ -0,0 +1,86 @@
+#include "frustum.h"
+
+/*
+    constructor
+*/
+
+// extract planes from view projection matrix
+Frustum::Frustum(glm::mat4 viewProjection) {
+    // rows of the matrix (glm is column major)
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++) {
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    }
+
+    // clip space bounds -w <= x, y, z <= w
+    planes[0] = rows[3] + rows[0];
+    planes[1] = rows[3] - rows[0];
+    planes[2] = rows[3] + rows[1];
+    planes[3] = rows[3] - rows[1];
+    planes[4] = rows[3] + rows[2];
+    planes[5] = rows[3] - rows[2];
+
+    // normalize so offsets are distances
+    for (int i = 0; i < 6; i++) {
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
+}
+
+/*
+    testing methods
+*/
+
+// classify box against frustum
+Containment Frustum::classifyBox(glm::vec3 min, glm::vec3 max) {
+    Containment ret = Containment::INSIDE;
+
+    for (int i = 0; i < 6; i++) {
+        glm::vec3 norm(planes[i]);
+
+        // corners furthest along and against the normal
+        glm::vec3 positive = glm::mix(min, max, glm::greaterThanEqual(norm, glm::vec3(0.0f)));
+        glm::vec3 negative = glm::mix(max, min, glm::greaterThanEqual(norm, glm::vec3(0.0f)));
+
+        if (glm::dot(norm, positive) + planes[i].w < 0.0f) {
+            // entire box behind plane
+            return Containment::OUTSIDE;
+        }
+        if (glm::dot(norm, negative) + planes[i].w < 0.0f) {
+            // box crosses plane
+            ret = Containment::INTERSECTS;
+        }
+    }
+
+    return ret;
+}
+
+// classify sphere against frustum
+Containment Frustum::classifySphere(glm::vec3 center, float radius) {
+    Containment ret = Containment::INSIDE;
+
+    for (int i = 0; i < 6; i++) {
+        float dist = glm::dot(glm::vec3(planes[i]), center) + planes[i].w;
+
+        if (dist < -radius) {
+            // entire sphere behind plane
+            return Containment::OUTSIDE;
+        }
+        if (dist < radius) {
+            // sphere crosses plane
+            ret = Containment::INTERSECTS;
+        }
+    }
+
+    return ret;
+}
+
+// determine if region intersects frustum
+bool Frustum::intersects(BoundingRegion& br) {
+    if (br.type != BoundTypes::SPHERE) {
+        // box enclosing an OBB is close enough for culling
+        return classifyBox(br.min, br.max) != Containment::OUTSIDE;
+    }
+    else {
+        return classifySphere(br.center, br.radius) != Containment::OUTSIDE;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include "bounds.h"
+
+/*
+	enum for how a volume lies relative to a query shape
+*/
+
+enum class Containment : unsigned char {
+	OUTSIDE = 0x00,		// no overlap
+	INTERSECTS = 0x01,	// partial overlap
+	INSIDE = 0x02		// completely inside
+};
+
+/*
+	class to represent a view frustum by its six planes
+	- planes point inwards, a point is inside if it is on the positive side of all of them
+*/
+
+class Frustum {
+public:
+	// planes (normal in xyz, offset in w): left, right, bottom, top, near, far
+	glm::vec4 planes[6];
+
+	/*
+		constructor
+	*/
+
+	// extract planes from view projection matrix
+	Frustum(glm::mat4 viewProjection);
+
+	/*
+		testing methods
+	*/
+
+	// classify box against frustum
+	Containment classifyBox(glm::vec3 min, glm::vec3 max);
+
+	// classify sphere against frustum
+	Containment classifySphere(glm::vec3 center, float radius);
+
+	// determine if region intersects frustum
+	bool intersects(BoundingRegion& br);
+};
+
+#endif // !FRUSTUM_H
@@ -1,6 +1,9 @@
 #ifndef LIST_HPP
 #define LIST_HPP
 
+#include <algorithm>
+#include <vector>
+
 /*
 	namespace to tie together list utility methods
 */
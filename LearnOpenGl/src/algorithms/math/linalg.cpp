@@ -1,5 +1,6 @@
 #include "linalg.h"
 
+#include <cmath>
 #include <limits>
 #include <glm/glm.hpp>
 
@@ -57,21 +58,286 @@ glm::vec3 mat4vec3mult(glm::mat4& m, glm::vec3& v) {
 }
 
 glm::vec3 linCombSolution(glm::vec3 A, glm::vec3 B, glm::vec3 C, glm::vec3 point) {
-    // represent the point as a linear combination of the 3 basis vectors
-    glm::mat4x3 m(A, B, C, point);
-
-    // do RREF
-    rref<4, 3>(m);
+    // represent the point as a linear combination of the 3 basis vectors (Cramer's rule with triple products)
+    glm::vec3 BxC = glm::cross(B, C);
+    float det = glm::dot(A, BxC);
+    if (det == 0.0f) {
+        // vectors do not span space
+        return glm::vec3(std::numeric_limits<float>::quiet_NaN());
+    }
 
-    return m[3];
+    return glm::vec3(
+        glm::dot(point, BxC),
+        glm::dot(A, glm::cross(point, C)),
+        glm::dot(A, glm::cross(B, point))
+    ) / det;
 }
 
 bool faceContainsPointRange(glm::vec3 A, glm::vec3 B, glm::vec3 N, glm::vec3 point, float radius) {
-    glm::vec3 c = linCombSolution(A, B, N, point);
+    // barycentric coordinates of point along A and B (the coordinate along N is not needed)
+    glm::vec3 BxN = glm::cross(B, N);
+    float det = glm::dot(A, BxN);
+    if (det == 0.0f) {
+        // degenerate face
+        return false;
+    }
 
-    return c[0] >= -radius && c[1] >= -radius && c[0] + c[1] <= 1.0f + radius;
+    float c0 = glm::dot(point, BxN) / det;
+    float c1 = glm::dot(A, glm::cross(point, N)) / det;
+
+    return c0 >= -radius && c1 >= -radius && c0 + c1 <= 1.0f + radius;
 }
 
 bool faceContainsPoint(glm::vec3 A, glm::vec3 B, glm::vec3 N, glm::vec3 point) {
     return faceContainsPointRange(A, B, N, point, 0.0f);
 }
+
+/*
+    Closed form triangle tests
+*/
+
+bool rayTriangleIntersection(glm::vec3 origin, glm::vec3 dir, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3, float& t) {
+    glm::vec3 A = P2 - P1;
+    glm::vec3 B = P3 - P1;
+
+    glm::vec3 p = glm::cross(dir, B);
+    float det = glm::dot(A, p);
+    if (det == 0.0f) {
+        // ray parallel to the plane
+        return false;
+    }
+    float invDet = 1.0f / det;
+
+    // barycentric coordinates of the hit
+    glm::vec3 s = origin - P1;
+    float u = glm::dot(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f) {
+        return false;
+    }
+
+    glm::vec3 q = glm::cross(s, A);
+    float v = glm::dot(dir, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) {
+        return false;
+    }
+
+    float tHit = glm::dot(B, q) * invDet;
+    if (tHit < 0.0f) {
+        // behind the origin
+        return false;
+    }
+
+    t = tHit;
+    return true;
+}
+
+// orientation of c to the line through a and b
+static float orient2d(glm::vec2 a, glm::vec2 b, glm::vec2 c) {
+    return (a.x - c.x) * (b.y - c.y) - (a.y - c.y) * (b.x - c.x);
+}
+
+// if segments ab and cd intersect in 2D
+static bool segmentsIntersect2d(glm::vec2 a, glm::vec2 b, glm::vec2 c, glm::vec2 d) {
+    float o1 = orient2d(a, b, c), o2 = orient2d(a, b, d);
+    float o3 = orient2d(c, d, a), o4 = orient2d(c, d, b);
+
+    if (o1 * o2 < 0.0f && o3 * o4 < 0.0f) {
+        // proper crossing
+        return true;
+    }
+
+    // touching or collinear, check if the touching point is on the other segment
+    auto onSegment = [](glm::vec2 p, glm::vec2 q, glm::vec2 r) -> bool {
+        return r.x >= std::fminf(p.x, q.x) && r.x <= std::fmaxf(p.x, q.x) &&
+            r.y >= std::fminf(p.y, q.y) && r.y <= std::fmaxf(p.y, q.y);
+    };
+    return (o1 == 0.0f && onSegment(a, b, c)) ||
+        (o2 == 0.0f && onSegment(a, b, d)) ||
+        (o3 == 0.0f && onSegment(c, d, a)) ||
+        (o4 == 0.0f && onSegment(c, d, b));
+}
+
+// if point is inside the 2D triangle abc (either winding)
+static bool triangleContainsPoint2d(glm::vec2 a, glm::vec2 b, glm::vec2 c, glm::vec2 p) {
+    float o1 = orient2d(a, b, p), o2 = orient2d(b, c, p), o3 = orient2d(c, a, p);
+    return (o1 >= 0.0f && o2 >= 0.0f && o3 >= 0.0f) || (o1 <= 0.0f && o2 <= 0.0f && o3 <= 0.0f);
+}
+
+// if coplanar triangles intersect, projected onto the plane their normal N is most aligned with
+static bool coplanarTriangleIntersection(glm::vec3 P[3], glm::vec3 U[3], glm::vec3 N) {
+    glm::vec3 absN = glm::abs(N);
+    int x = 0, y = 1;
+    if (absN.x >= absN.y && absN.x >= absN.z) {
+        // drop x
+        x = 1; y = 2;
+    }
+    else if (absN.y >= absN.z) {
+        // drop y
+        x = 0; y = 2;
+    }
+
+    glm::vec2 p[3], u[3];
+    for (int i = 0; i < 3; i++) {
+        p[i] = glm::vec2(P[i][x], P[i][y]);
+        u[i] = glm::vec2(U[i][x], U[i][y]);
+    }
+
+    // edges crossing
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            if (segmentsIntersect2d(p[i], p[(i + 1) % 3], u[j], u[(j + 1) % 3])) {
+                return true;
+            }
+        }
+    }
+
+    // one triangle inside the other
+    return triangleContainsPoint2d(p[0], p[1], p[2], u[0]) ||
+        triangleContainsPoint2d(u[0], u[1], u[2], p[0]);
+}
+
+/*
+    Guigue-Devillers triangle-triangle test
+    - the vertices of each triangle are permuted so the first vertex is alone on its side of the other plane
+    - the triangles then intersect if the intervals they cut on the line of the two planes overlap,
+      which is decided with two orientation tests
+*/
+
+// test once the vertices are in canonical order (p1 and p2 alone on their side of the other plane)
+static bool checkMinMax(glm::vec3 p1, glm::vec3 q1, glm::vec3 r1, glm::vec3 p2, glm::vec3 q2, glm::vec3 r2) {
+    if (glm::dot(q2 - q1, glm::cross(p2 - q1, p1 - q1)) > 0.0f) {
+        return false;
+    }
+    if (glm::dot(r2 - p1, glm::cross(p2 - p1, r1 - p1)) > 0.0f) {
+        return false;
+    }
+    return true;
+}
+
+// permute triangle 2 so p2 is alone on its side of the plane of triangle 1
+static bool triTri3d(glm::vec3 p1, glm::vec3 q1, glm::vec3 r1, glm::vec3 p2, glm::vec3 q2, glm::vec3 r2,
+    float dp2, float dq2, float dr2, glm::vec3 P[3], glm::vec3 U[3], glm::vec3 N1) {
+    if (dp2 > 0.0f) {
+        if (dq2 > 0.0f) return checkMinMax(p1, r1, q1, r2, p2, q2);
+        else if (dr2 > 0.0f) return checkMinMax(p1, r1, q1, q2, r2, p2);
+        else return checkMinMax(p1, q1, r1, p2, q2, r2);
+    }
+    else if (dp2 < 0.0f) {
+        if (dq2 < 0.0f) return checkMinMax(p1, q1, r1, r2, p2, q2);
+        else if (dr2 < 0.0f) return checkMinMax(p1, q1, r1, q2, r2, p2);
+        else return checkMinMax(p1, r1, q1, p2, q2, r2);
+    }
+    else {
+        if (dq2 < 0.0f) {
+            if (dr2 >= 0.0f) return checkMinMax(p1, r1, q1, q2, r2, p2);
+            else return checkMinMax(p1, q1, r1, p2, q2, r2);
+        }
+        else if (dq2 > 0.0f) {
+            if (dr2 > 0.0f) return checkMinMax(p1, r1, q1, p2, q2, r2);
+            else return checkMinMax(p1, q1, r1, q2, r2, p2);
+        }
+        else {
+            if (dr2 > 0.0f) return checkMinMax(p1, q1, r1, r2, p2, q2);
+            else if (dr2 < 0.0f) return checkMinMax(p1, r1, q1, r2, p2, q2);
+            else return coplanarTriangleIntersection(P, U, N1);
+        }
+    }
+}
+
+bool triangleTriangleIntersection(glm::vec3 P1, glm::vec3 P2, glm::vec3 P3, glm::vec3 U1, glm::vec3 U2, glm::vec3 U3) {
+    glm::vec3 P[3] = { P1, P2, P3 };
+    glm::vec3 U[3] = { U1, U2, U3 };
+
+    // normals of the faces
+    glm::vec3 N1 = glm::cross(P1 - P3, P2 - P3);
+    glm::vec3 N2 = glm::cross(U1 - U3, U2 - U3);
+    if (N1 == glm::vec3(0.0f) || N2 == glm::vec3(0.0f)) {
+        // degenerate face
+        return false;
+    }
+
+    // sides of the plane of U the vertices of P are on
+    float dp1 = glm::dot(P1 - U3, N2);
+    float dq1 = glm::dot(P2 - U3, N2);
+    float dr1 = glm::dot(P3 - U3, N2);
+    if (dp1 * dq1 > 0.0f && dp1 * dr1 > 0.0f) {
+        // all on one side
+        return false;
+    }
+
+    // sides of the plane of P the vertices of U are on
+    float dp2 = glm::dot(U1 - P3, N1);
+    float dq2 = glm::dot(U2 - P3, N1);
+    float dr2 = glm::dot(U3 - P3, N1);
+    if (dp2 * dq2 > 0.0f && dp2 * dr2 > 0.0f) {
+        return false;
+    }
+
+    // permute triangle 1 so P1 is alone on its side of the plane of triangle 2
+    if (dp1 > 0.0f) {
+        if (dq1 > 0.0f) return triTri3d(P3, P1, P2, U1, U3, U2, dp2, dr2, dq2, P, U, N1);
+        else if (dr1 > 0.0f) return triTri3d(P2, P3, P1, U1, U3, U2, dp2, dr2, dq2, P, U, N1);
+        else return triTri3d(P1, P2, P3, U1, U2, U3, dp2, dq2, dr2, P, U, N1);
+    }
+    else if (dp1 < 0.0f) {
+        if (dq1 < 0.0f) return triTri3d(P3, P1, P2, U1, U2, U3, dp2, dq2, dr2, P, U, N1);
+        else if (dr1 < 0.0f) return triTri3d(P2, P3, P1, U1, U2, U3, dp2, dq2, dr2, P, U, N1);
+        else return triTri3d(P1, P2, P3, U1, U3, U2, dp2, dr2, dq2, P, U, N1);
+    }
+    else {
+        if (dq1 < 0.0f) {
+            if (dr1 >= 0.0f) return triTri3d(P2, P3, P1, U1, U3, U2, dp2, dr2, dq2, P, U, N1);
+            else return triTri3d(P1, P2, P3, U1, U2, U3, dp2, dq2, dr2, P, U, N1);
+        }
+        else if (dq1 > 0.0f) {
+            if (dr1 > 0.0f) return triTri3d(P1, P2, P3, U1, U3, U2, dp2, dr2, dq2, P, U, N1);
+            else return triTri3d(P2, P3, P1, U1, U2, U3, dp2, dq2, dr2, P, U, N1);
+        }
+        else {
+            if (dr1 > 0.0f) return triTri3d(P3, P1, P2, U1, U2, U3, dp2, dq2, dr2, P, U, N1);
+            else if (dr1 < 0.0f) return triTri3d(P3, P1, P2, U1, U3, U2, dp2, dr2, dq2, P, U, N1);
+            else return coplanarTriangleIntersection(P, U, N1);
+        }
+    }
+}
+
+// closest point of segment P1P2 to point
+static glm::vec3 closestPointOnSegment(glm::vec3 point, glm::vec3 P1, glm::vec3 P2) {
+    glm::vec3 A = P2 - P1;
+    float len2 = glm::dot(A, A);
+    float t = len2 > 0.0f ? glm::clamp(glm::dot(point - P1, A) / len2, 0.0f, 1.0f) : 0.0f;
+    return P1 + t * A;
+}
+
+glm::vec3 closestPointOnTriangle(glm::vec3 point, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3) {
+    glm::vec3 A = P2 - P1;
+    glm::vec3 B = P3 - P1;
+    glm::vec3 D = point - P1;
+
+    // barycentric coordinates of the projection onto the plane
+    float d00 = glm::dot(A, A);
+    float d01 = glm::dot(A, B);
+    float d11 = glm::dot(B, B);
+    float denom = d00 * d11 - d01 * d01;
+    if (denom > 0.0f) {
+        float da = glm::dot(D, A);
+        float db = glm::dot(D, B);
+        float u = (d11 * da - d01 * db) / denom;
+        float v = (d00 * db - d01 * da) / denom;
+        if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f) {
+            return P1 + u * A + v * B;
+        }
+    }
+
+    // closest point of the edges
+    glm::vec3 ret = closestPointOnSegment(point, P1, P2);
+    glm::vec3 E2 = closestPointOnSegment(point, P1, P3);
+    glm::vec3 E3 = closestPointOnSegment(point, P2, P3);
+    if (glm::dot(point - E2, point - E2) < glm::dot(point - ret, point - ret)) {
+        ret = E2;
+    }
+    if (glm::dot(point - E3, point - E3) < glm::dot(point - ret, point - ret)) {
+        ret = E3;
+    }
+    return ret;
+}
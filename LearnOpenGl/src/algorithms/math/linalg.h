@@ -56,6 +56,20 @@ bool faceContainsPointRange(glm::vec3 A, glm::vec3 B, glm::vec3 N, glm::vec3 poi
 
 bool faceContainsPoint(glm::vec3 A, glm::vec3 B, glm::vec3 N, glm::vec3 point);
 
+/*
+    Closed form triangle tests
+    - faces are hit from both sides, points on an edge count as inside
+*/
+
+// parameter t of the ray { origin + dir * t } where it hits the triangle P1P2P3 (Moller-Trumbore), only t >= 0
+bool rayTriangleIntersection(glm::vec3 origin, glm::vec3 dir, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3, float& t);
+
+// if the triangles P1P2P3 and U1U2U3 intersect (Guigue-Devillers, coplanar triangles are tested in 2D)
+bool triangleTriangleIntersection(glm::vec3 P1, glm::vec3 P2, glm::vec3 P3, glm::vec3 U1, glm::vec3 U2, glm::vec3 U3);
+
+// point of the triangle P1P2P3 closest to point (projection if it falls inside, else closest point of the edges)
+glm::vec3 closestPointOnTriangle(glm::vec3 point, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3);
+
 template <int C, int R>
 void rref(glm::mat<C, R, float>& m) {
     unsigned int currentRow = 0;
@@ -0,0 +1,66 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+/*
+	simd helpers (8 lanes with AVX, 4 lanes with SSE, SIMD_WIDTH is not defined otherwise)
+	- loads and stores need addresses aligned to 32 bytes (simd_loadu and simd_storeu take any address)
+	- comparisons give a lane mask (all bits set) that can be combined with simd_and/simd_or (simd_andnot(a, b) = ~a & b)
+*/
+
+#if defined(__AVX__)
+#include <immintrin.h>
+
+#define SIMD_WIDTH 8
+typedef __m256 simd_float;
+#define simd_load(p) _mm256_load_ps(p)
+#define simd_loadu(p) _mm256_loadu_ps(p)
+#define simd_store(p, a) _mm256_store_ps(p, a)
+#define simd_storeu(p, a) _mm256_storeu_ps(p, a)
+#define simd_set1(x) _mm256_set1_ps(x)
+#define simd_add(a, b) _mm256_add_ps(a, b)
+#define simd_sub(a, b) _mm256_sub_ps(a, b)
+#define simd_mul(a, b) _mm256_mul_ps(a, b)
+#define simd_div(a, b) _mm256_div_ps(a, b)
+#define simd_min(a, b) _mm256_min_ps(a, b)
+#define simd_max(a, b) _mm256_max_ps(a, b)
+#define simd_sqrt(a) _mm256_sqrt_ps(a)
+#define simd_and(a, b) _mm256_and_ps(a, b)
+#define simd_or(a, b) _mm256_or_ps(a, b)
+#define simd_andnot(a, b) _mm256_andnot_ps(a, b)
+#define simd_ge(a, b) _mm256_cmp_ps(a, b, _CMP_GE_OQ)
+#define simd_le(a, b) _mm256_cmp_ps(a, b, _CMP_LE_OQ)
+#define simd_gt(a, b) _mm256_cmp_ps(a, b, _CMP_GT_OQ)
+#define simd_lt(a, b) _mm256_cmp_ps(a, b, _CMP_LT_OQ)
+#define simd_neq(a, b) _mm256_cmp_ps(a, b, _CMP_NEQ_UQ)
+#define simd_mask(a) (unsigned int)_mm256_movemask_ps(a)
+
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+
+#define SIMD_WIDTH 4
+typedef __m128 simd_float;
+#define simd_load(p) _mm_load_ps(p)
+#define simd_loadu(p) _mm_loadu_ps(p)
+#define simd_store(p, a) _mm_store_ps(p, a)
+#define simd_storeu(p, a) _mm_storeu_ps(p, a)
+#define simd_set1(x) _mm_set1_ps(x)
+#define simd_add(a, b) _mm_add_ps(a, b)
+#define simd_sub(a, b) _mm_sub_ps(a, b)
+#define simd_mul(a, b) _mm_mul_ps(a, b)
+#define simd_div(a, b) _mm_div_ps(a, b)
+#define simd_min(a, b) _mm_min_ps(a, b)
+#define simd_max(a, b) _mm_max_ps(a, b)
+#define simd_sqrt(a) _mm_sqrt_ps(a)
+#define simd_and(a, b) _mm_and_ps(a, b)
+#define simd_or(a, b) _mm_or_ps(a, b)
+#define simd_andnot(a, b) _mm_andnot_ps(a, b)
+#define simd_ge(a, b) _mm_cmpge_ps(a, b)
+#define simd_le(a, b) _mm_cmple_ps(a, b)
+#define simd_gt(a, b) _mm_cmpgt_ps(a, b)
+#define simd_lt(a, b) _mm_cmplt_ps(a, b)
+#define simd_neq(a, b) _mm_cmpneq_ps(a, b)
+#define simd_mask(a) (unsigned int)_mm_movemask_ps(a)
+
+#endif
+
+#endif // !SIMD_H
@@ -0,0 +1,316 @@
+#include "meshbvh.h"
+
+#include "../physics/collisionmesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// maximum depth of the traversal stacks (faces are split in half so this covers any mesh)
+#define MESH_BVH_STACK_SIZE 64
+
+/*
+    build
+*/
+
+// build tree over faces
+void MeshBVH::build(std::vector<glm::vec3>& points, std::vector<Face>& faces) {
+    nodes.clear();
+    faceIndices.resize(faces.size());
+    if (faces.empty()) {
+        return;
+    }
+
+    // boxes and centers of the faces
+    std::vector<glm::vec3> centers(faces.size()), mins(faces.size()), maxs(faces.size());
+    for (unsigned int i = 0; i < faces.size(); i++) {
+        glm::vec3 P1 = points[faces[i].i1];
+        glm::vec3 P2 = points[faces[i].i2];
+        glm::vec3 P3 = points[faces[i].i3];
+
+        mins[i] = glm::min(P1, glm::min(P2, P3));
+        maxs[i] = glm::max(P1, glm::max(P2, P3));
+        centers[i] = (P1 + P2 + P3) / 3.0f;
+        faceIndices[i] = i;
+    }
+
+    nodes.reserve(2 * faces.size() / MESH_BVH_LEAF_SIZE + 1);
+    nodes.push_back(MeshBVHNode());
+    buildNode(0, 0, (unsigned int)faces.size(), centers, mins, maxs);
+}
+
+// build subtree over the face range [start, end) into node
+void MeshBVH::buildNode(unsigned int node, unsigned int start, unsigned int end, std::vector<glm::vec3>& centers, std::vector<glm::vec3>& mins, std::vector<glm::vec3>& maxs) {
+    // box around the faces and their centers
+    glm::vec3 min(std::numeric_limits<float>::max());
+    glm::vec3 max(std::numeric_limits<float>::lowest());
+    glm::vec3 centerMin = min;
+    glm::vec3 centerMax = max;
+    for (unsigned int i = start; i < end; i++) {
+        unsigned int face = faceIndices[i];
+        min = glm::min(min, mins[face]);
+        max = glm::max(max, maxs[face]);
+        centerMin = glm::min(centerMin, centers[face]);
+        centerMax = glm::max(centerMax, centers[face]);
+    }
+    nodes[node].min = min;
+    nodes[node].max = max;
+
+    if (end - start <= MESH_BVH_LEAF_SIZE) {
+        // leaf
+        nodes[node].first = start;
+        nodes[node].count = end - start;
+        return;
+    }
+
+    // split at the median center along the longest axis
+    glm::vec3 extent = centerMax - centerMin;
+    int axis = 0;
+    if (extent.y > extent[axis]) {
+        axis = 1;
+    }
+    if (extent.z > extent[axis]) {
+        axis = 2;
+    }
+
+    unsigned int mid = (start + end) / 2;
+    std::nth_element(faceIndices.begin() + start, faceIndices.begin() + mid, faceIndices.begin() + end,
+        [&](unsigned int a, unsigned int b) -> bool {
+            return centers[a][axis] < centers[b][axis];
+        });
+
+    // children are next to each other (vector may grow, so do not hold references)
+    unsigned int left = (unsigned int)nodes.size();
+    nodes.push_back(MeshBVHNode());
+    nodes.push_back(MeshBVHNode());
+    nodes[node].first = left;
+    nodes[node].count = 0;
+
+    buildNode(left, start, mid, centers, mins, maxs);
+    buildNode(left + 1, mid, end, centers, mins, maxs);
+}
+
+/*
+    queries (in local space of the mesh)
+*/
+
+// if boxes overlap
+static bool boxesOverlap(glm::vec3 min1, glm::vec3 max1, glm::vec3 min2, glm::vec3 max2) {
+    return min1.x <= max2.x && max1.x >= min2.x &&
+        min1.y <= max2.y && max1.y >= min2.y &&
+        min1.z <= max2.z && max1.z >= min2.z;
+}
+
+// entry distance of ray into box, or false if it misses it before tmax
+static bool rayEntersBox(glm::vec3 origin, glm::vec3 invdir, glm::vec3 min, glm::vec3 max, float tmax, float& tEnter) {
+    glm::vec3 t1 = (min - origin) * invdir;
+    glm::vec3 t2 = (max - origin) * invdir;
+    glm::vec3 tNear = glm::min(t1, t2);
+    glm::vec3 tFar = glm::max(t1, t2);
+
+    tEnter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float tExit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tmax));
+    return tEnter <= tExit;
+}
+
+// call for each face in a leaf whose box overlaps the box
+void MeshBVH::queryBox(glm::vec3 min, glm::vec3 max, FaceCallback callback) {
+    if (nodes.empty()) {
+        return;
+    }
+
+    unsigned int stack[MESH_BVH_STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        MeshBVHNode& node = nodes[stack[--top]];
+        if (!boxesOverlap(node.min, node.max, min, max)) {
+            continue;
+        }
+
+        if (node.count) {
+            // test faces of leaf
+            for (unsigned int i = node.first; i < node.first + node.count; i++) {
+                if (callback(faceIndices[i])) {
+                    return;
+                }
+            }
+        }
+        else {
+            stack[top++] = node.first;
+            stack[top++] = node.first + 1;
+        }
+    }
+}
+
+// call for each run of leaves whose boxes overlap the box (leaves next to each other in the face list are merged)
+void MeshBVH::queryBoxRanges(glm::vec3 min, glm::vec3 max, RangeCallback callback) {
+    if (nodes.empty()) {
+        return;
+    }
+
+    unsigned int stack[MESH_BVH_STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+
+    // run of leaves found so far
+    unsigned int first = 0, count = 0;
+
+    while (top > 0) {
+        MeshBVHNode& node = nodes[stack[--top]];
+        if (!boxesOverlap(node.min, node.max, min, max)) {
+            continue;
+        }
+
+        if (node.count) {
+            if (count && first + count == node.first) {
+                // leaf follows the run
+                count += node.count;
+                continue;
+            }
+            if (count && callback(first, count)) {
+                return;
+            }
+            first = node.first;
+            count = node.count;
+        }
+        else {
+            // left child first, so neighbouring leaves are found in order
+            stack[top++] = node.first + 1;
+            stack[top++] = node.first;
+        }
+    }
+
+    if (count) {
+        callback(first, count);
+    }
+}
+
+// call for each leaf hit by the ray before tmax, closer leaves first (callback can lower tmax to skip further leaves)
+void MeshBVH::queryRay(glm::vec3 origin, glm::vec3 dir, float& tmax, LeafCallback callback) {
+    glm::vec3 invdir = 1.0f / dir;
+    float tEnter;
+    if (nodes.empty() || !rayEntersBox(origin, invdir, nodes[0].min, nodes[0].max, tmax, tEnter)) {
+        return;
+    }
+
+    // nodes with the distance the ray enters them
+    unsigned int stack[MESH_BVH_STACK_SIZE];
+    float stackT[MESH_BVH_STACK_SIZE];
+    int top = 0;
+    stack[top] = 0;
+    stackT[top++] = tEnter;
+
+    while (top > 0) {
+        top--;
+        if (stackT[top] > tmax) {
+            // closer hit found since node was pushed
+            continue;
+        }
+        MeshBVHNode& node = nodes[stack[top]];
+
+        if (node.count) {
+            // test faces of leaf
+            if (callback(&faceIndices[node.first], node.count)) {
+                return;
+            }
+            continue;
+        }
+
+        // visit closer child first (pushed last)
+        float tLeft, tRight;
+        bool hitLeft = rayEntersBox(origin, invdir, nodes[node.first].min, nodes[node.first].max, tmax, tLeft);
+        bool hitRight = rayEntersBox(origin, invdir, nodes[node.first + 1].min, nodes[node.first + 1].max, tmax, tRight);
+        unsigned int left = node.first;
+
+        if (hitLeft && hitRight) {
+            if (tLeft <= tRight) {
+                stack[top] = left + 1; stackT[top++] = tRight;
+                stack[top] = left; stackT[top++] = tLeft;
+            }
+            else {
+                stack[top] = left; stackT[top++] = tLeft;
+                stack[top] = left + 1; stackT[top++] = tRight;
+            }
+        }
+        else if (hitLeft) {
+            stack[top] = left; stackT[top++] = tLeft;
+        }
+        else if (hitRight) {
+            stack[top] = left + 1; stackT[top++] = tRight;
+        }
+    }
+}
+
+// call for each pair of faces in overlapping leaves of both trees (transform takes local space of other to local space of this)
+void MeshBVH::queryTree(MeshBVH& other, glm::mat4 transform, FacePairCallback callback) {
+    if (nodes.empty() || other.nodes.empty()) {
+        return;
+    }
+
+    // pairs of nodes (this, other)
+    unsigned int stack[2 * MESH_BVH_STACK_SIZE][2];
+    int top = 0;
+    stack[top][0] = 0;
+    stack[top++][1] = 0;
+
+    while (top > 0) {
+        top--;
+        MeshBVHNode& a = nodes[stack[top][0]];
+        MeshBVHNode& b = other.nodes[stack[top][1]];
+        unsigned int idxA = stack[top][0];
+        unsigned int idxB = stack[top][1];
+
+        // box of other node in this space
+        glm::vec3 bMin = b.min, bMax = b.max;
+        transformBox(transform, bMin, bMax);
+        if (!boxesOverlap(a.min, a.max, bMin, bMax)) {
+            continue;
+        }
+
+        if (a.count && b.count) {
+            // test face pairs of leaves
+            for (unsigned int i = a.first; i < a.first + a.count; i++) {
+                for (unsigned int j = b.first; j < b.first + b.count; j++) {
+                    if (callback(faceIndices[i], other.faceIndices[j])) {
+                        return;
+                    }
+                }
+            }
+            continue;
+        }
+
+        // descend the internal node with the larger box
+        glm::vec3 aSize = a.max - a.min, bSize = bMax - bMin;
+        if (b.count || (!a.count && aSize.x * aSize.y * aSize.z >= bSize.x * bSize.y * bSize.z)) {
+            stack[top][0] = a.first; stack[top++][1] = idxB;
+            stack[top][0] = a.first + 1; stack[top++][1] = idxB;
+        }
+        else {
+            stack[top][0] = idxA; stack[top++][1] = b.first;
+            stack[top][0] = idxA; stack[top++][1] = b.first + 1;
+        }
+    }
+}
+
+/*
+    box helpers
+*/
+
+// box enclosing the box min-max after it is transformed
+void MeshBVH::transformBox(glm::mat4& transform, glm::vec3& min, glm::vec3& max) {
+    glm::vec3 center = 0.5f * (min + max);
+    glm::vec3 extent = 0.5f * (max - min);
+
+    glm::vec3 newCenter = glm::vec3(transform * glm::vec4(center, 1.0f));
+    glm::vec3 newExtent(0.0f);
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            newExtent[i] += std::abs(transform[j][i]) * extent[j];
+        }
+    }
+
+    min = newCenter - newExtent;
+    max = newCenter + newExtent;
+}
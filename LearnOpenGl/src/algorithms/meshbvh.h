@@ -0,0 +1,87 @@
+#ifndef MESHBVH_H
+#define MESHBVH_H
+
+#include <functional>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// maximum number of faces in a leaf
+#define MESH_BVH_LEAF_SIZE 4
+
+// forward declaration
+typedef struct Face Face;
+
+/*
+	structure representing a node in the tree
+*/
+
+typedef struct MeshBVHNode {
+	// box enclosing the faces below the node
+	glm::vec3 min;
+	glm::vec3 max;
+
+	// first child (children are first and first + 1) or first face in the face list for leaves
+	unsigned int first;
+	// number of faces (0 for internal nodes)
+	unsigned int count;
+} MeshBVHNode;
+
+/*
+	class for a static bounding volume hierarchy over the faces of a collision mesh
+	- built once in the local space of the mesh, faces are split at the median of their centers along the longest axis
+	- queries from world space are moved into the local space of the mesh (the tree never has to be refit)
+*/
+
+class MeshBVH {
+public:
+	// callback for faces found by a query (return true to stop the query)
+	typedef std::function<bool(unsigned int)> FaceCallback;
+	// callback for the faces of a leaf found by a query (return true to stop the query)
+	typedef std::function<bool(unsigned int*, unsigned int)> LeafCallback;
+	// callback for a run of positions [first, first + count) in the face list found by a query (return true to stop the query)
+	typedef std::function<bool(unsigned int, unsigned int)> RangeCallback;
+	// callback for pairs of faces found by a query against another tree (return true to stop the query)
+	typedef std::function<bool(unsigned int, unsigned int)> FacePairCallback;
+
+	// node storage (root is the first node)
+	std::vector<MeshBVHNode> nodes;
+	// face indices, each leaf owns a range
+	std::vector<unsigned int> faceIndices;
+
+	/*
+		build
+	*/
+
+	// build tree over faces
+	void build(std::vector<glm::vec3>& points, std::vector<Face>& faces);
+
+	/*
+		queries (in local space of the mesh)
+	*/
+
+	// call for each face in a leaf whose box overlaps the box
+	void queryBox(glm::vec3 min, glm::vec3 max, FaceCallback callback);
+
+	// call for each run of leaves whose boxes overlap the box (leaves next to each other in the face list are merged)
+	void queryBoxRanges(glm::vec3 min, glm::vec3 max, RangeCallback callback);
+
+	// call for each leaf hit by the ray before tmax, closer leaves first (callback can lower tmax to skip further leaves)
+	void queryRay(glm::vec3 origin, glm::vec3 dir, float& tmax, LeafCallback callback);
+
+	// call for each pair of faces in overlapping leaves of both trees (transform takes local space of other to local space of this)
+	void queryTree(MeshBVH& other, glm::mat4 transform, FacePairCallback callback);
+
+	/*
+		box helpers
+	*/
+
+	// box enclosing the box min-max after it is transformed
+	static void transformBox(glm::mat4& transform, glm::vec3& min, glm::vec3& max);
+
+private:
+	// build subtree over the face range [start, end) into node
+	void buildNode(unsigned int node, unsigned int start, unsigned int end, std::vector<glm::vec3>& centers, std::vector<glm::vec3>& mins, std::vector<glm::vec3>& maxs);
+};
+
+#endif // !MESHBVH_H
@@ -0,0 +1,359 @@
+#include "meshsimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <unordered_map>
+
+/*
+    quadric error of a point to a set of planes (symmetric 4x4 matrix, upper triangle)
+*/
+
+typedef struct Quadric {
+    // aa ab ac ad bb bc bd cc cd dd
+    double q[10];
+} Quadric;
+
+// quadric of plane { dot(n, p) + d = 0 } scaled by weight
+static Quadric planeQuadric(glm::dvec3 n, double d, double weight) {
+    Quadric ret = { {
+        n.x * n.x, n.x * n.y, n.x * n.z, n.x * d,
+        n.y * n.y, n.y * n.z, n.y * d,
+        n.z * n.z, n.z * d,
+        d * d
+    } };
+    for (int i = 0; i < 10; i++) {
+        ret.q[i] *= weight;
+    }
+    return ret;
+}
+
+static void addQuadric(Quadric& a, const Quadric& b) {
+    for (int i = 0; i < 10; i++) {
+        a.q[i] += b.q[i];
+    }
+}
+
+// squared distance of p to the planes of the quadric
+static double quadricError(const Quadric& Q, glm::dvec3 p) {
+    const double* q = Q.q;
+    return q[0] * p.x * p.x + 2.0 * q[1] * p.x * p.y + 2.0 * q[2] * p.x * p.z + 2.0 * q[3] * p.x
+        + q[4] * p.y * p.y + 2.0 * q[5] * p.y * p.z + 2.0 * q[6] * p.y
+        + q[7] * p.z * p.z + 2.0 * q[8] * p.z
+        + q[9];
+}
+
+// point with the smallest error, returns false if the planes do not meet in a point
+static bool quadricMinimum(const Quadric& Q, glm::dvec3& p) {
+    const double* q = Q.q;
+    glm::dmat3 A(
+        q[0], q[1], q[2],
+        q[1], q[4], q[5],
+        q[2], q[5], q[7]
+    );
+    double det = glm::determinant(A);
+
+    // scale of the matrix, so the check does not depend on the size of the mesh
+    double scale = q[0] + q[4] + q[7];
+    if (std::abs(det) <= 1e-9 * scale * scale * scale) {
+        return false;
+    }
+
+    p = glm::inverse(A) * glm::dvec3(-q[3], -q[6], -q[8]);
+    return true;
+}
+
+/*
+    edge collapse candidates
+*/
+
+typedef struct Collapse {
+    // error of the collapse
+    double cost;
+    // point kept and point removed
+    unsigned int v0, v1;
+    // versions of the points the collapse was computed for
+    unsigned int version0, version1;
+    // position of the kept point after the collapse
+    glm::vec3 pos;
+} Collapse;
+
+// order for the queue (smallest cost on top)
+struct CollapseGreater {
+    bool operator()(const Collapse& a, const Collapse& b) const {
+        return a.cost > b.cost;
+    }
+};
+
+// key of the edge between points a and b (either order)
+static unsigned long long edgeKey(unsigned int a, unsigned int b) {
+    return a < b ? ((unsigned long long)a << 32) | b : ((unsigned long long)b << 32) | a;
+}
+
+/*
+    welding
+*/
+
+// cell of a point in the welding grid
+typedef struct WeldCell {
+    long long x, y, z;
+
+    bool operator==(const WeldCell& other) const {
+        return x == other.x && y == other.y && z == other.z;
+    }
+} WeldCell;
+
+struct WeldCellHash {
+    size_t operator()(const WeldCell& c) const {
+        return (size_t)(c.x * 73856093LL ^ c.y * 19349663LL ^ c.z * 83492791LL);
+    }
+};
+
+// remove unused points, remapping the indices
+static void removeUnusedPoints(std::vector<glm::vec3>& points, std::vector<unsigned int>& indices) {
+    std::vector<unsigned int> remap(points.size(), (unsigned int)-1);
+    std::vector<glm::vec3> used;
+    used.reserve(points.size());
+
+    for (unsigned int& i : indices) {
+        if (remap[i] == (unsigned int)-1) {
+            remap[i] = (unsigned int)used.size();
+            used.push_back(points[i]);
+        }
+        i = remap[i];
+    }
+
+    points.swap(used);
+}
+
+// merge points in the same cell of a grid with spacing tolerance (> 0), indices are remapped, unused points and degenerate faces are removed
+void MeshSimplifier::weld(std::vector<glm::vec3>& points, std::vector<unsigned int>& indices, float tolerance) {
+    // first point in each cell of the grid represents the cell
+    std::unordered_map<WeldCell, unsigned int, WeldCellHash> cells;
+    std::vector<unsigned int> remap(points.size());
+    double invTolerance = 1.0 / tolerance;
+
+    for (unsigned int i = 0, noPoints = (unsigned int)points.size(); i < noPoints; i++) {
+        glm::dvec3 cell = glm::floor(glm::dvec3(points[i]) * invTolerance + 0.5);
+        WeldCell key = { (long long)cell.x, (long long)cell.y, (long long)cell.z };
+
+        auto found = cells.find(key);
+        if (found == cells.end()) {
+            cells[key] = i;
+            remap[i] = i;
+        }
+        else {
+            remap[i] = found->second;
+        }
+    }
+
+    // remap faces, dropping those with repeated points
+    std::vector<unsigned int> welded;
+    welded.reserve(indices.size());
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        unsigned int a = remap[indices[i]], b = remap[indices[i + 1]], c = remap[indices[i + 2]];
+        if (a != b && b != c && a != c) {
+            welded.push_back(a);
+            welded.push_back(b);
+            welded.push_back(c);
+        }
+    }
+
+    indices.swap(welded);
+    removeUnusedPoints(points, indices);
+}
+
+/*
+    simplification
+*/
+
+// collapse edges until at most maxFaces faces are left, unused points are removed
+void MeshSimplifier::simplify(std::vector<glm::vec3>& points, std::vector<unsigned int>& indices, unsigned int maxFaces) {
+    unsigned int noPoints = (unsigned int)points.size();
+    unsigned int noFaces = (unsigned int)indices.size() / 3;
+    if (noFaces <= maxFaces) {
+        return;
+    }
+
+    std::vector<Quadric> quadrics(noPoints, Quadric());
+    std::vector<std::vector<unsigned int>> pointFaces(noPoints);
+    std::vector<bool> faceAlive(noFaces, true);
+    std::vector<bool> pointAlive(noPoints, true);
+    std::vector<unsigned int> versions(noPoints, 0);
+
+    // planes of the faces, weighted by area
+    std::unordered_map<unsigned long long, unsigned int> edgeFaces;
+    for (unsigned int f = 0; f < noFaces; f++) {
+        unsigned int* v = &indices[3 * f];
+        glm::dvec3 P1 = points[v[0]], P2 = points[v[1]], P3 = points[v[2]];
+        glm::dvec3 N = glm::cross(P2 - P1, P3 - P1);
+        double len = glm::length(N);
+        if (len > 0.0) {
+            N /= len;
+            Quadric Q = planeQuadric(N, -glm::dot(N, P1), 0.5 * len);
+            for (int i = 0; i < 3; i++) {
+                addQuadric(quadrics[v[i]], Q);
+            }
+        }
+
+        for (int i = 0; i < 3; i++) {
+            pointFaces[v[i]].push_back(f);
+            edgeFaces[edgeKey(v[i], v[(i + 1) % 3])]++;
+        }
+    }
+
+    // planes through open borders, perpendicular to their face
+    for (unsigned int f = 0; f < noFaces; f++) {
+        unsigned int* v = &indices[3 * f];
+        glm::dvec3 N = glm::cross(glm::dvec3(points[v[1]]) - glm::dvec3(points[v[0]]), glm::dvec3(points[v[2]]) - glm::dvec3(points[v[0]]));
+        for (int i = 0; i < 3; i++) {
+            unsigned int a = v[i], b = v[(i + 1) % 3];
+            if (edgeFaces[edgeKey(a, b)] != 1) {
+                continue;
+            }
+
+            glm::dvec3 edge = glm::dvec3(points[b]) - glm::dvec3(points[a]);
+            glm::dvec3 borderN = glm::cross(edge, N);
+            double len = glm::length(borderN);
+            if (len > 0.0) {
+                borderN /= len;
+                Quadric Q = planeQuadric(borderN, -glm::dot(borderN, glm::dvec3(points[a])), BORDER_QUADRIC_WEIGHT * glm::dot(edge, edge));
+                addQuadric(quadrics[a], Q);
+                addQuadric(quadrics[b], Q);
+            }
+        }
+    }
+
+    // best collapse of edge ab into a
+    auto evaluate = [&](unsigned int a, unsigned int b) -> Collapse {
+        Quadric Q = quadrics[a];
+        addQuadric(Q, quadrics[b]);
+
+        Collapse ret = { 0.0, a, b, versions[a], versions[b], points[a] };
+        glm::dvec3 p;
+        if (quadricMinimum(Q, p)) {
+            ret.cost = quadricError(Q, p);
+            ret.pos = glm::vec3(p);
+        }
+        else {
+            // planes do not meet in a point, best of the ends and the middle
+            glm::dvec3 candidates[3] = { glm::dvec3(points[a]), glm::dvec3(points[b]), 0.5 * (glm::dvec3(points[a]) + glm::dvec3(points[b])) };
+            ret.cost = quadricError(Q, candidates[0]);
+            for (int i = 1; i < 3; i++) {
+                double cost = quadricError(Q, candidates[i]);
+                if (cost < ret.cost) {
+                    ret.cost = cost;
+                    ret.pos = glm::vec3(candidates[i]);
+                }
+            }
+        }
+        return ret;
+    };
+
+    // queue each edge once (face counts are cleared as their edges are queued, borders are already found)
+    std::priority_queue<Collapse, std::vector<Collapse>, CollapseGreater> queue;
+    for (unsigned int f = 0; f < noFaces; f++) {
+        unsigned int* v = &indices[3 * f];
+        for (int i = 0; i < 3; i++) {
+            unsigned int& edgeCount = edgeFaces[edgeKey(v[i], v[(i + 1) % 3])];
+            if (edgeCount) {
+                edgeCount = 0;
+                queue.push(evaluate(v[i], v[(i + 1) % 3]));
+            }
+        }
+    }
+
+    // if moving the points of the collapse keeps every other face around them from flipping or degenerating
+    auto valid = [&](Collapse& c) -> bool {
+        for (unsigned int p : { c.v0, c.v1 }) {
+            for (unsigned int f : pointFaces[p]) {
+                unsigned int* v = &indices[3 * f];
+                if (!faceAlive[f] || ((v[0] == c.v0 || v[1] == c.v0 || v[2] == c.v0) && (v[0] == c.v1 || v[1] == c.v1 || v[2] == c.v1))) {
+                    // removed by the collapse
+                    continue;
+                }
+
+                glm::vec3 before[3], after[3];
+                for (int i = 0; i < 3; i++) {
+                    before[i] = points[v[i]];
+                    after[i] = v[i] == c.v0 || v[i] == c.v1 ? c.pos : points[v[i]];
+                }
+                glm::vec3 N1 = glm::cross(before[1] - before[0], before[2] - before[0]);
+                glm::vec3 N2 = glm::cross(after[1] - after[0], after[2] - after[0]);
+                float len1 = glm::length(N1), len2 = glm::length(N2);
+                if (len2 == 0.0f || (len1 > 0.0f && glm::dot(N1, N2) < COLLAPSE_MIN_NORMAL_DOT * len1 * len2)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    unsigned int faceCount = noFaces;
+    std::vector<unsigned int> neighbours;
+    while (faceCount > maxFaces && !queue.empty()) {
+        Collapse c = queue.top();
+        queue.pop();
+
+        if (!pointAlive[c.v0] || !pointAlive[c.v1] || c.version0 != versions[c.v0] || c.version1 != versions[c.v1] || !valid(c)) {
+            // out of date (a newer collapse of the edge is queued) or not allowed
+            continue;
+        }
+
+        // move faces of the removed point to the kept point
+        for (unsigned int f : pointFaces[c.v1]) {
+            if (!faceAlive[f]) {
+                continue;
+            }
+            unsigned int* v = &indices[3 * f];
+            if (v[0] == c.v0 || v[1] == c.v0 || v[2] == c.v0) {
+                // face on the edge
+                faceAlive[f] = false;
+                faceCount--;
+                continue;
+            }
+            for (int i = 0; i < 3; i++) {
+                if (v[i] == c.v1) {
+                    v[i] = c.v0;
+                }
+            }
+            pointFaces[c.v0].push_back(f);
+        }
+        pointFaces[c.v1].clear();
+        pointAlive[c.v1] = false;
+
+        points[c.v0] = c.pos;
+        addQuadric(quadrics[c.v0], quadrics[c.v1]);
+        versions[c.v0]++;
+
+        // drop removed faces from the kept point, queue its edges again
+        std::vector<unsigned int>& faces = pointFaces[c.v0];
+        faces.erase(std::remove_if(faces.begin(), faces.end(), [&](unsigned int f) -> bool { return !faceAlive[f]; }), faces.end());
+
+        neighbours.clear();
+        for (unsigned int f : faces) {
+            for (int i = 0; i < 3; i++) {
+                if (indices[3 * f + i] != c.v0) {
+                    neighbours.push_back(indices[3 * f + i]);
+                }
+            }
+        }
+        std::sort(neighbours.begin(), neighbours.end());
+        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+        for (unsigned int n : neighbours) {
+            queue.push(evaluate(c.v0, n));
+        }
+    }
+
+    // keep faces left
+    std::vector<unsigned int> simplified;
+    simplified.reserve(3 * faceCount);
+    for (unsigned int f = 0; f < noFaces; f++) {
+        if (faceAlive[f]) {
+            simplified.insert(simplified.end(), indices.begin() + 3 * f, indices.begin() + 3 * f + 3);
+        }
+    }
+
+    indices.swap(simplified);
+    removeUnusedPoints(points, indices);
+}
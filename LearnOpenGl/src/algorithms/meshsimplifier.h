@@ -0,0 +1,27 @@
+#ifndef MESHSIMPLIFIER_H
+#define MESHSIMPLIFIER_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// weight of the planes keeping open borders in place (relative to the faces)
+#define BORDER_QUADRIC_WEIGHT 1000.0
+// smallest cosine between the normals of a face before and after a collapse (smaller = the face flips)
+#define COLLAPSE_MIN_NORMAL_DOT 0.2f
+
+/*
+	namespace to tie together the mesh simplification functions
+	- used to build collision meshes from render meshes (see CollisionImport)
+	- simplify collapses the edge with the smallest quadric error until the face budget is met (Garland-Heckbert)
+*/
+
+namespace MeshSimplifier {
+	// merge points in the same cell of a grid with spacing tolerance (> 0), indices are remapped, unused points and degenerate faces are removed
+	void weld(std::vector<glm::vec3>& points, std::vector<unsigned int>& indices, float tolerance);
+
+	// collapse edges until at most maxFaces faces are left, unused points are removed
+	void simplify(std::vector<glm::vec3>& points, std::vector<unsigned int>& indices, unsigned int maxFaces);
+}
+
+#endif // !MESHSIMPLIFIER_H
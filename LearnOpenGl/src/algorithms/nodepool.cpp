@@ -0,0 +1,70 @@
+#include "nodepool.h"
+#include "octree.h"
+
+/*
+    constructor
+*/
+
+// initialize with number of blocks allocated at once
+NodePool::NodePool(unsigned int blocksPerChunk)
+    : blocksPerChunk(blocksPerChunk), noBlocksInUse(0) {}
+
+/*
+    block management
+*/
+
+// get block of eight nodes
+Octree::node* NodePool::allocateBlock() {
+    if (freeBlocks.size() == 0) {
+        // allocate new chunk and split it into blocks
+        Octree::node* chunk = new Octree::node[NO_CHILDREN * blocksPerChunk];
+        chunks.push_back(chunk);
+
+        // push in reverse so blocks are handed out in address order
+        for (int i = (int)blocksPerChunk - 1; i >= 0; i--) {
+            freeBlocks.push_back(chunk + NO_CHILDREN * i);
+        }
+    }
+
+    Octree::node* block = freeBlocks.back();
+    freeBlocks.pop_back();
+    noBlocksInUse++;
+
+    return block;
+}
+
+// return block to free list
+void NodePool::releaseBlock(Octree::node* block) {
+    freeBlocks.push_back(block);
+    noBlocksInUse--;
+}
+
+// free all chunks
+void NodePool::cleanup() {
+    for (Octree::node* chunk : chunks) {
+        delete[] chunk;
+    }
+    chunks.clear();
+    freeBlocks.clear();
+    noBlocksInUse = 0;
+}
+
+/*
+    occupancy
+*/
+
+// number of blocks handed out
+unsigned int NodePool::blocksInUse() {
+    return noBlocksInUse;
+}
+
+// number of blocks allocated
+unsigned int NodePool::blockCapacity() {
+    return (unsigned int)chunks.size() * blocksPerChunk;
+}
+
+// fraction of allocated blocks handed out
+float NodePool::occupancy() {
+    unsigned int capacity = blockCapacity();
+    return capacity == 0 ? 0.0f : (float)noBlocksInUse / (float)capacity;
+}
@@ -0,0 +1,65 @@
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <vector>
+
+// forward declaration
+namespace Octree {
+	class node;
+}
+
+/*
+	class to allocate octree nodes in contiguous blocks of eight children
+	- blocks are carved out of larger chunks, so the general allocator is only used when the pool grows
+	- released blocks go on a free list and are reused before new chunks are allocated
+*/
+
+class NodePool {
+public:
+	/*
+		constructor
+	*/
+
+	// initialize with number of blocks allocated at once
+	NodePool(unsigned int blocksPerChunk = 64);
+
+	/*
+		block management
+	*/
+
+	// get block of eight nodes
+	Octree::node* allocateBlock();
+
+	// return block to free list
+	void releaseBlock(Octree::node* block);
+
+	// free all chunks
+	void cleanup();
+
+	/*
+		occupancy
+	*/
+
+	// number of blocks handed out
+	unsigned int blocksInUse();
+
+	// number of blocks allocated
+	unsigned int blockCapacity();
+
+	// fraction of allocated blocks handed out
+	float occupancy();
+
+private:
+	// number of blocks in each chunk
+	unsigned int blocksPerChunk;
+
+	// allocated chunks
+	std::vector<Octree::node*> chunks;
+	// list of blocks to be reused
+	std::vector<Octree::node*> freeBlocks;
+
+	// number of blocks handed out
+	unsigned int noBlocksInUse;
+};
+
+#endif // !NODEPOOL_H
@@ -1,6 +1,9 @@
 #include "octree.h"
 #include "avl.h"
-#include "../graphics/models/box.hpp"
+#include "boxlist.h"
+#include "../physics/narrowphase.h"
+
+#include <iostream>
 
 // calculate bounds of specified quadrant in bounding region
 void Octree::calculateBounds(BoundingRegion &out, Octant octant, BoundingRegion parentRegion) {
@@ -33,23 +36,85 @@ void Octree::calculateBounds(BoundingRegion &out, Octant octant, BoundingRegion
     }
 }
 
+// get octants in the order a ray with direction passes through them (nearest first)
+void Octree::orderOctants(int order[NO_CHILDREN], glm::vec3 dir) {
+    // octant index by side of center (bit 0 = -x, bit 1 = -y, bit 2 = -z)
+    static const int octantBySide[NO_CHILDREN] = { 0, 1, 3, 2, 4, 5, 7, 6 };
+    // sides flipped from the entry octant, fewest flips first
+    static const int flips[NO_CHILDREN] = { 0, 1, 2, 4, 3, 5, 6, 7 };
+
+    // a ray travelling in +x enters through the -x half
+    int entry = (dir.x > 0.0f ? 1 : 0) | (dir.y > 0.0f ? 2 : 0) | (dir.z > 0.0f ? 4 : 0);
+    for (int i = 0; i < NO_CHILDREN; i++) {
+        order[i] = octantBySide[entry ^ flips[i]];
+    }
+}
+
+// calculate bounds of region scaled about its center by looseness
+void Octree::calculateLooseBounds(BoundingRegion &out, BoundingRegion region, float looseness) {
+    glm::vec3 center = region.calculateCenter();
+    glm::vec3 halfDimensions = 0.5f * looseness * region.calculateDimensions();
+    out = BoundingRegion(center - halfDimensions, center + halfDimensions);
+}
+
+// get distance from point to region (0 if inside)
+float Octree::distanceToRegion(glm::vec3 point, BoundingRegion& br) {
+    if (br.type == BoundTypes::AABB) {
+        // distance to closest point of box
+        return glm::length(point - glm::clamp(point, br.min, br.max));
+    }
+    else if (br.type == BoundTypes::OBB) {
+        // distance to closest point of box in its own frame (axes are orthonormal)
+        glm::vec3 local = glm::transpose(br.axes) * (point - br.center);
+        return glm::length(local - glm::clamp(local, -br.halfSize, br.halfSize));
+    }
+    else {
+        return std::max(glm::length(point - br.center) - br.radius, 0.0f);
+    }
+}
+
 /*
     constructors
 */
 
 // default
 Octree::node::node()
-    : region(BoundTypes::AABB) {}
+    : parent(nullptr), children(), block(nullptr), activeOctants(0),
+    pool(nullptr), nodes(nullptr), region(BoundTypes::AABB), looseness(1.0f), looseRegion(region) {}
+
+// initialize root with bounds and looseness (no objects yet, allocates pools)
+Octree::node::node(BoundingRegion bound, float looseness)
+    : parent(nullptr), children(), block(nullptr), activeOctants(0),
+    pool(new BoundsPool()), nodes(new NodePool()), region(bound), looseness(looseness) {
+    calculateLooseBounds(looseRegion, region, looseness);
+}
 
-// initialize with bounds (no objects yet)
-Octree::node::node(BoundingRegion bound)
-    : region(bound) {}
+// reset node taken from a block with bounds, pools of tree and looseness
+void Octree::node::init(BoundingRegion bounds, BoundsPool* pool, NodePool* nodes, float looseness) {
+    region = bounds;
+    this->pool = pool;
+    this->nodes = nodes;
+    this->looseness = looseness;
+    calculateLooseBounds(looseRegion, region, looseness);
 
-// initialize with bounds and list of objects
-Octree::node::node(BoundingRegion bounds, std::vector<BoundingRegion> objectsList)
-    : region(bounds) {
-    // insert entire list of objects
-    objects.insert(objects.end(), objectsList.begin(), objectsList.end());
+    // clear state of previous use
+    parent = nullptr;
+    for (int i = 0; i < NO_CHILDREN; i++) {
+        children[i] = nullptr;
+    }
+    block = nullptr;
+    activeOctants = 0;
+    workers = nullptr;
+
+    treeReady = false;
+    treeBuilt = false;
+    maxLifeSpan = 8;
+    currentLifeSpan = -1;
+
+    objects.clear();
+    while (queue.size() != 0) {
+        queue.pop();
+    }
 }
 
 /*
@@ -57,12 +122,23 @@ Octree::node::node(BoundingRegion bounds, std::vector<BoundingRegion> objectsLis
 */
 
 // add instance to pending queue
-void Octree::node::addToPending(RigidBody* instance, Model* model) {
+void Octree::node::addToPending(RigidBody* instance, PhysicsModel* model) {
+    // static instances added before the first build go to the cache
+    bool isStatic = staticCache && !treeBuilt && States::isActive(&model->switches, CONST_INSTANCES);
+    if (isStatic) {
+        staticCache->addInstance(instance, model);
+    }
+
     // getting all the bounding regions of the model
     for (BoundingRegion br : model->boundingRegions) {
         br.instance = instance;
         br.transform();
-        queue.push(br);
+        if (isStatic) {
+            staticCache->statics.push_back(pool->allocate(br));
+        }
+        else {
+            queue.push(pool->allocate(br));
+        }
     }
 }
 
@@ -70,8 +146,9 @@ void Octree::node::addToPending(RigidBody* instance, Model* model) {
 void Octree::node::build() {
     // variable declerations
     BoundingRegion octants[NO_CHILDREN];
+    BoundingRegion looseOctants[NO_CHILDREN];
     glm::vec3 dimensions = region.calculateDimensions();
-    std::vector<BoundingRegion> octList[NO_CHILDREN]; // array of list of object in each octant
+    std::vector<unsigned int> octList[NO_CHILDREN]; // array of list of object in each octant
 
     /*
         termination condition
@@ -96,20 +173,18 @@ void Octree::node::build() {
     // create regions
     for (int i = 0; i < NO_CHILDREN; i++) {
         calculateBounds(octants[i], (Octant)(1 << i), region);
+        calculateLooseBounds(looseOctants[i], octants[i], looseness);
     }
 
     // determines wich octants to place objects in
-    for (int i = 0, len = (int)objects.size(); i < len; i++) {
-        BoundingRegion br = objects[i];
+    // (iterate backwards so swapped objects have already been checked)
+    for (int i = (int)objects.size() - 1; i >= 0; i--) {
+        unsigned int obj = objects[i];
         for (int j = 0; j < NO_CHILDREN; j++) {
-            if (octants[j].containsRegion(br)) {
+            if (looseOctants[j].containsRegion((*pool)[obj])) {
                 // octant contains region
-                octList[j].push_back(br);
-                objects.erase(objects.begin() + i);
-
-                // offset because removed object from list
-                i--;
-                len--;
+                octList[j].push_back(obj);
+                removeObject(obj);
                 break;
             }
         }
@@ -119,10 +194,7 @@ void Octree::node::build() {
     for (int i = 0; i < NO_CHILDREN; i++) {
         if (octList[i].size() != 0) {
             // if children go into this octant, generate new child
-            children[i] = new node(octants[i], octList[i]);
-            States::activateIndex(&activeOctants, i); // activate octant
-            children[i]->parent = this;
-            children[i]->build();
+            createChild(i, octants[i], octList[i]);
         }
     }
     
@@ -130,15 +202,19 @@ setVars:
     // set state varaibles
     treeBuilt = true;
     treeReady = true;
-
-    // set pointer to current cell of each object
-    for (int i = 0; i < objects.size(); i++) {
-        objects[i].cell = this;
-    }
 }
 
 // update objects in tree (called during each iteration of main loop)
-void Octree::node::update(Box &box) {
+void Octree::node::update(BoxList& box) {
+    // gather moved objects of entire tree before testing collisions
+    std::vector<unsigned int> movedList;
+    update(box, &movedList);
+    checkCollisionsMoved(movedList);
+}
+
+// update objects in tree
+// moved objects are gathered into movedList (collisions are tested once the whole tree is updated)
+void Octree::node::update(BoxList& box, std::vector<unsigned int>* movedList) {
     if(treeBuilt && treeReady){
         box.positions.push_back(region.calculateCenter());
         box.sizes.push_back(region.calculateDimensions());
@@ -167,26 +243,26 @@ void Octree::node::update(Box &box) {
         }
 
         // removing moved objects that dont exist anymore
-        for (int i = 0, listSize = (int)objects.size(); i < listSize; i++) {
+        for (int i = (int)objects.size() - 1; i >= 0; i--) {
             // remove if on list of dead objects
-            if (States::isActive(&objects[i].instance->state, INSTANCE_DEAD)) {
-                objects.erase(objects.begin() + i);
-                // update counter/size
-                i--;
-                listSize--;
+            unsigned int obj = objects[i];
+            if (States::isActive(&(*pool)[obj].instance->state, INSTANCE_DEAD)) {
+                removeObject(obj);
+                pool->release(obj);
             }
         }
 
         // get moved objects that were in this leaf in previous frame
-        std::stack<int> movedObjects;
-        for (int i = 0, listSize = (int)objects.size(); i < listSize; i++) {
-            if (States::isActive(&objects[i].instance->state, INSTANCE_MOVED)) {
+        std::stack<unsigned int> movedObjects;
+        for (unsigned int obj : objects) {
+            BoundingRegion& br = (*pool)[obj];
+            if (States::isActive(&br.instance->state, INSTANCE_MOVED)) {
                 // if moved switch active, transform region and push to list
-                objects[i].transform();
-                movedObjects.push(i);
+                pool->transform(obj);
+                movedObjects.push(obj);
             }
-            box.positions.push_back(objects[i].calculateCenter());
-            box.sizes.push_back(objects[i].calculateDimensions());
+            box.positions.push_back(br.calculateCenter());
+            box.sizes.push_back(br.calculateDimensions());
         }
 
         // remove dead branches
@@ -203,9 +279,7 @@ void Octree::node::update(Box &box) {
                 }
                 else {
                     // branches dead and no objects
-                    free(children[i]);
-                    children[i] = nullptr;
-                    States::deactivateIndex(&activeOctants, i);
+                    releaseChild(i);
                 }
             }
         }
@@ -220,14 +294,14 @@ void Octree::node::update(Box &box) {
                     // active octant
                     if (children[i] != nullptr) {
                         // child not null
-                        children[i]->update(box);
+                        children[i]->update(box, movedList);
                     }
                 }
             }
         }
 
         // move moved objects into new nodes
-        BoundingRegion movedObj;
+        unsigned int movedObj;
         while (movedObjects.size() != 0) {
             /*
                 for each moved object 
@@ -235,12 +309,13 @@ void Octree::node::update(Box &box) {
                 - call insert (push object as far down as posible 
             */
 
-            movedObj = objects[movedObjects.top()]; // set to top object
+            movedObj = movedObjects.top(); // set to top object
             node* current = this; // placeholder
-            while (!current->region.containsRegion(movedObj)) {
+            while (!current->looseRegion.containsRegion((*pool)[movedObj])) {
                 if (current->parent != nullptr) {
                     // set current to current's parent (recursion)
                     current = current->parent;
+                    Stats::add(Stats::PARENT_WALKS);
                 }
                 else {
                     break; // if root node, leave
@@ -252,24 +327,17 @@ void Octree::node::update(Box &box) {
                 - remove from objects list
                 - remove from objects stack
                 - instert into found region
+                (loose nodes keep objects that still fit, their depth only depends on size)
             */
-            objects.erase(objects.begin() + movedObjects.top());
             movedObjects.pop();
-            current->queue.push(movedObj);
-
-            // collusion detection
-            // itself
-            current = movedObj.cell;
-            current->checkCollisionsSelf(movedObj);
-
-            // children
-            current->checkCollisionsChildren(movedObj);
-
-            // parents
-            while (current->parent) {
-                current = current->parent;
-                current->checkCollisionsSelf(movedObj);
+            if (current != this || looseness == 1.0f) {
+                removeObject(movedObj);
+                current->queue.push(movedObj);
+                Stats::add(Stats::REINSERTIONS);
             }
+
+            // collisions are tested once the tree is updated
+            movedList->push_back(movedObj);
         }
         
     }
@@ -279,33 +347,56 @@ void Octree::node::update(Box &box) {
 
 // process pending queue
 void Octree::node::processPending() {
+    if (!treeBuilt && staticCache && staticCache->statics.size() != 0) {
+        // static part first, pending objects are then inserted into it
+        buildStatic();
+    }
+
     if (!treeBuilt) {
         // add objects to be sorted into branches when build
         while (queue.size() != 0) {
-            objects.push_back(queue.front());
+            addObject(queue.front());
             queue.pop();
         }
         build();
     }
     else {
         for (int i = 0, len = (int)queue.size(); i < len; i++) {
-            BoundingRegion br = queue.front();
-            if (region.containsRegion(br)) {
+            unsigned int obj = queue.front();
+            if (looseRegion.containsRegion((*pool)[obj])) {
                 // interst objects imidiatly
-                insert(br);
+                insert(obj);
             }
             else {
                 // return to queue
-                br.transform();
-                queue.push(br);
+                pool->transform(obj);
+                queue.push(obj);
             }
             queue.pop();
         }
     }
 }
 
+// place static objects from the cache, or build them and save the cache
+void Octree::node::buildStatic() {
+    if (!staticCache->load(this)) {
+        // missing or out of date, build from the static objects only
+        for (unsigned int obj : staticCache->statics) {
+            addObject(obj);
+        }
+        build();
+
+        if (!staticCache->save(this)) {
+            std::cout << "Could not save octree cache to " << staticCache->path << std::endl;
+        }
+    }
+
+    treeBuilt = true;
+    treeReady = true;
+}
+
 // dynamically insert object into node
-bool Octree::node::insert(BoundingRegion obj) {
+bool Octree::node::insert(unsigned int obj) {
     /*
         termination conditions
         - no objects (an empty leaf node)
@@ -318,42 +409,42 @@ bool Octree::node::insert(BoundingRegion obj) {
             dimesions.y < MIN_BOUNDS ||
             dimesions.z < MIN_BOUNDS)
             ) {
-        obj.cell = this;
-        objects.push_back(obj);
+        addObject(obj);
         return true;
     }
 
     // safe guard if object doesnt fit
-    if (!region.containsRegion(obj)) {
+    if (!looseRegion.containsRegion((*pool)[obj])) {
         return parent == nullptr ? false : parent->insert(obj);
     }
 
     // create region if not defined
     BoundingRegion octants[NO_CHILDREN];
+    BoundingRegion looseOctants[NO_CHILDREN];
     for (int i = 0; i < NO_CHILDREN; i++) {
         if (children[i] != nullptr) {
             // child exists, so take its region
             octants[i] = children[i]->region;
+            looseOctants[i] = children[i]->looseRegion;
         }
         else {
             // get region for this octant
             calculateBounds(octants[i], (Octant)(1 << i), region);
+            calculateLooseBounds(looseOctants[i], octants[i], looseness);
         }
     }
     
-    objects.push_back(obj);
+    addObject(obj);
 
     // determine which octants to put objects in
-    std::vector<BoundingRegion> octLists[NO_CHILDREN]; // array of list of object in each octant
-    for (int i = 0, len = (int)objects.size(); i < len; i++) {
-        objects[i].cell = this;
+    std::vector<unsigned int> octLists[NO_CHILDREN]; // array of list of object in each octant
+    for (int i = (int)objects.size() - 1; i >= 0; i--) {
+        unsigned int idx = objects[i];
         for (int j = 0; j < NO_CHILDREN; j++) {
-            if (octants[j].containsRegion(objects[i])) {
-                octLists[j].push_back(objects[i]);
+            if (looseOctants[j].containsRegion((*pool)[idx])) {
+                octLists[j].push_back(idx);
                 // remove from object list
-                objects.erase(objects.begin() + i);
-                i--;
-                len--;
+                removeObject(idx);
                 break;
             }
         }
@@ -363,16 +454,13 @@ bool Octree::node::insert(BoundingRegion obj) {
         if (octLists[i].size() != 0) {
             // object exist in this octant
             if (children[i]) {
-                for (BoundingRegion br : octLists[i]) {
-                    children[i]->insert(br);
+                for (unsigned int idx : octLists[i]) {
+                    children[i]->insert(idx);
                 }
             }
             else {
                 // create new node
-                children[i] = new node(octants[i], octLists[i]);
-                children[i]->parent = this;
-                States::activateIndex(&activeOctants, i);
-                children[i]->build();
+                createChild(i, octants[i], octLists[i]);
             }
         }
     }
@@ -380,255 +468,292 @@ bool Octree::node::insert(BoundingRegion obj) {
     return true;
 }
 
-// check collision with all objects in node
-void Octree::node::checkCollisionsSelf(BoundingRegion obj) {
-    for (BoundingRegion br : objects) {
-        if (br.instance->instanceId == obj.instance->instanceId) {
-            // do not test collision with the same instance
+// create child in octant with list of objects and build it
+void Octree::node::createChild(int octant, BoundingRegion bounds, std::vector<unsigned int>& objectsList) {
+    if (!block) {
+        // first child, get block for all octants
+        block = nodes->allocateBlock();
+    }
+
+    node* child = &block[octant];
+    child->init(bounds, pool, nodes, looseness);
+    child->parent = this;
+
+    // insert entire list of objects
+    child->objects.reserve(objectsList.size());
+    for (unsigned int obj : objectsList) {
+        child->addObject(obj);
+    }
+
+    children[octant] = child;
+    States::activateIndex(&activeOctants, octant); // activate octant
+    child->build();
+}
+
+// destroy child in octant, releasing the block once no children are left
+void Octree::node::releaseChild(int octant) {
+    children[octant]->destroy();
+    children[octant] = nullptr;
+    States::deactivateIndex(&activeOctants, octant);
+
+    if (!activeOctants && block) {
+        nodes->releaseBlock(block);
+        block = nullptr;
+    }
+}
+
+// add object to list of node
+void Octree::node::addObject(unsigned int obj) {
+    pool->hot[obj].cell = this;
+    pool->hot[obj].cellIdx = (unsigned int)objects.size();
+    objects.push_back(obj);
+}
+
+// remove object from list of node (swap with last)
+void Octree::node::removeObject(unsigned int obj) {
+    unsigned int idx = pool->hot[obj].cellIdx;
+    unsigned int last = objects.back();
+
+    // move last object into the slot
+    objects[idx] = last;
+    pool->hot[last].cellIdx = idx;
+    objects.pop_back();
+
+    pool->hot[obj].cell = nullptr;
+    pool->hot[obj].cellIdx = NULL_BOUNDS;
+}
+
+// check collisions of object stored in the tree with all objects in cells its box overlaps the loose region of (searched from the root)
+void Octree::node::checkCollisionsObject(unsigned int obj, std::vector<Contact>* contacts) {
+    BoundsHot& hot = pool->hot[obj];
+    if (!hot.cell) {
+        // still pending (outside of tree)
+        return;
+    }
+
+    // loose regions of siblings and cousins can overlap the object, so the whole tree is searched
+    node* root = this;
+    while (root->parent) {
+        root = root->parent;
+    }
+
+    root->checkCollisionsRegion((*pool)[obj], hot.min, hot.max, contacts);
+}
+
+// check collisions of moved objects (on the worker pool if there is one)
+void Octree::node::checkCollisionsMoved(std::vector<unsigned int>& movedList) {
+    // generate candidate pairs and do the fine grain tests (tree is only read)
+    checkCollisionsList((unsigned int)movedList.size(), [&](unsigned int start, unsigned int end, std::vector<Contact>& contacts) -> void {
+        for (unsigned int i = start; i < end; i++) {
+            checkCollisionsObject(movedList[i], &contacts);
+        }
+    });
+}
+
+// check collisions with a ray
+BoundingRegion* Octree::node::checkCollisionsRay(Ray r, float& tmin) {
+    BoundingRegion* ret = nullptr;
+
+    // children are visited nearest first so the closest hit shrinks early
+    int order[NO_CHILDREN];
+    orderOctants(order, r.dir);
+
+    std::vector<node*> stack;
+    stack.push_back(this);
+
+    while (stack.size() != 0) {
+        node* current = stack.back();
+        stack.pop_back();
+
+        // skip nodes missed by the ray or behind the closest hit (objects may stick out of the tight region)
+        // the root keeps objects that do not fit in it, so its objects are always tested
+        float tmin_tmp = std::numeric_limits<float>::max();
+        float tmax_tmp = std::numeric_limits<float>::lowest();
+        bool missed = !r.intersectsBoundingRegion(current->looseRegion, tmin_tmp, tmax_tmp) || tmin_tmp >= tmin;
+        if (missed && current->parent) {
             continue;
         }
-        // coarse check for bounding region intersection
-        if (br.intersectsWith(obj)) {
-            // course check passed
-
-            unsigned int noFacesBr = br.collisionMesh ? (unsigned int)br.collisionMesh->faces.size() : 0;
-            unsigned int noFacesObj = obj.collisionMesh ? (unsigned int)obj.collisionMesh->faces.size() : 0;
-
-            glm::vec3 norm;
-
-            if (noFacesBr) {
-
-                if (noFacesObj) {
-                    // both have collision mesh
-                    // check all faces in br againts all faces in obj
-                    for (unsigned int i = 0; i < noFacesBr; i++) {
-                        for (unsigned int j = 0; j < noFacesObj; j++) {
-                            if (br.collisionMesh->faces[i].collidesWithFace(
-                                br.instance,
-                                obj.collisionMesh->faces[j],
-                                obj.instance,
-                                norm
-                            )) {
-                                std::cout << "Case 1: Instance " << br.instance->instanceId
-                                    << "(" << br.instance->modelId << ") collides with instance "
-                                    << obj.instance->instanceId << "(" << obj.instance->modelId << ")" << std::endl;
-                                obj.instance->handleCollision(br.instance, norm);
-                                break;
-                            }
-                        }
-                    }
-                }
-                else {
-                    // br has a collision mesh obj does not
-                    // check all faces br againts onj's sphere
-                    for (unsigned int i = 0; i < noFacesBr; i++) {
-                        if (br.collisionMesh->faces[i].collidesWithSphere(
-                            br.instance,
-                            obj,
-                            norm)) {
-                            std::cout << "Case 2: Instance " << br.instance->instanceId
-                                << "(" << br.instance->modelId << ") collides with instance "
-                                << obj.instance->instanceId << "(" << obj.instance->modelId << ")" << std::endl;
-                            obj.instance->handleCollision(br.instance, norm);
-                            break;
-                        }
-                    }
-                }
+
+        // check objects in the node
+        for (unsigned int obj : current->objects) {
+            BoundingRegion& br = (*pool)[obj];
+            if (r.intersectsRegion(br, tmin)) {
+                ret = &br;
             }
-            else {
-                if (noFacesObj) {
-                    // obj has collision mesh br does not
-                    // check all faces in obj againts br's sphere
-                    for (unsigned int i = 0; i < noFacesObj; i++) {
-                        if (obj.collisionMesh->faces[i].collidesWithSphere(
-                            obj.instance,
-                            br,
-                            norm)) {
-                            std::cout << "Case 3: Instance " << br.instance->instanceId
-                                << "(" << br.instance->modelId << ") collides with instance "
-                                << obj.instance->instanceId << "(" << obj.instance->modelId << ")" << std::endl;
-
-                            obj.instance->handleCollision(br.instance, norm);
-                            break;
-                        }
-                    }
-                }
-                else {
-                    // neither have collision mesh
-                    // coarse grain test passed (test collision between different bounding volumes)
-                    std::cout << "Case 4: Instance " << br.instance->instanceId
-                        << "(" << br.instance->modelId << ") collides with instance "
-                        << obj.instance->instanceId << "(" << obj.instance->modelId << ")" << std::endl;
-
-                    // Determine the types of bounding volumes
-                    bool isBrSphere = br.type == BoundTypes::SPHERE;
-                    bool isObjSphere = obj.type == BoundTypes::SPHERE;
-
-                    if (isBrSphere && isObjSphere) {
-                        // Sphere-Sphere collision
-                        norm = obj.center - br.center;
-                        br.instance->handleCollision(obj.instance, norm);
-                    }
-                    else if (isBrSphere && !isObjSphere) {
-                        // Sphere-AABB collision
-                        glm::vec3 closestPoint = br.center;
-                        glm::vec3 penetration;
-                        float minPenetration = std::numeric_limits<float>::max();
-                        for (int i = 0; i < 3; i++) {
-                            if (br.center[i] < obj.min[i]) {
-                                closestPoint[i] = obj.min[i];
-                                penetration[i] = obj.min[i] - br.center[i];
-                                minPenetration = std::min(minPenetration, penetration[i]);
-                            }
-                            else if (br.center[i] > obj.max[i]) {
-                                closestPoint[i] = obj.max[i];
-                                penetration[i] = br.center[i] - obj.max[i];
-                                minPenetration = std::min(minPenetration, penetration[i]);
-                            }
-                        }
-                        if (minPenetration <= br.radius) {
-                            norm = glm::normalize(br.center - closestPoint);
-                            br.instance->handleCollision(obj.instance, norm);
-                        }
-                    }
-                    else if (!isBrSphere && isObjSphere) {
-                        // AABB-Sphere collision
-                        glm::vec3 closestPoint = obj.center;
-                        glm::vec3 penetration;
-                        float minPenetration = std::numeric_limits<float>::max();
-                        for (int i = 0; i < 3; i++) {
-                            if (obj.center[i] < br.min[i]) {
-                                closestPoint[i] = br.min[i];
-                                penetration[i] = br.min[i] - obj.center[i];
-                                minPenetration = std::min(minPenetration, penetration[i]);
-                            }
-                            else if (obj.center[i] > br.max[i]) {
-                                closestPoint[i] = br.max[i];
-                                penetration[i] = obj.center[i] - br.max[i];
-                                minPenetration = std::min(minPenetration, penetration[i]);
-                            }
-                        }
-                        if (minPenetration <= obj.radius) {
-                            norm = glm::normalize(obj.center - closestPoint);
-                            obj.instance->handleCollision(br.instance, norm);
-                        }
-                    }
-                    else {
-                        // AABB-AABB collision
-                        if (br.min.x <= obj.max.x && br.max.x >= obj.min.x &&
-                            br.min.y <= obj.max.y && br.max.y >= obj.min.y &&
-                            br.min.z <= obj.max.z && br.max.z >= obj.min.z) {
-                            // Calculate the penetration depth and normal
-                            glm::vec3 penetration;
-                            if (br.max.x < obj.max.x) penetration.x = br.max.x - obj.min.x;
-                            else if (obj.max.x < br.max.x) penetration.x = obj.max.x - br.min.x;
-                            if (br.max.y < obj.max.y) penetration.y = br.max.y - obj.min.y;
-                            else if (obj.max.y < br.max.y) penetration.y = obj.max.y - br.min.y;
-                            if (br.max.z < obj.max.z) penetration.z = br.max.z - obj.min.z;
-                            else if (obj.max.z < br.max.z) penetration.z = obj.max.z - br.min.z;
-
-                            // Find the axis with the smallest penetration depth
-                            if (penetration.x < penetration.y && penetration.x < penetration.z) {
-                                norm = glm::vec3(1, 0, 0);
-                                if (br.center.x > obj.center.x) norm = -norm;
-                            }
-                            else if (penetration.y < penetration.z) {
-                                norm = glm::vec3(0, 1, 0);
-                                if (br.center.y > obj.center.y) norm = -norm;
-                            }
-                            else {
-                                norm = glm::vec3(0, 0, 1);
-                                if (br.center.z > obj.center.z) norm = -norm;
-                            }
-
-                            br.instance->handleCollision(obj.instance, norm);
-                        }
-                    }
-                }
+        }
+
+        if (missed) {
+            continue;
+        }
+
+        // push children farthest first so the nearest is popped next
+        for (int i = NO_CHILDREN - 1; i >= 0; i--) {
+            int octant = order[i];
+            if (States::isIndexActive(&current->activeOctants, octant) && current->children[octant]) {
+                stack.push_back(current->children[octant]);
             }
         }
     }
+
+    return ret;
 }
 
-// check collisions with all objects in child nodes
-void Octree::node::checkCollisionsChildren(BoundingRegion obj)
-{
-    if (children) {
-        for (int flags = activeOctants, i = 0;
+// check for any collision with a ray closer than tmax (returns first region found)
+BoundingRegion* Octree::node::checkCollisionsRayAny(Ray r, float tmax) {
+    int order[NO_CHILDREN];
+    orderOctants(order, r.dir);
+
+    std::vector<node*> stack;
+    stack.push_back(this);
+
+    while (stack.size() != 0) {
+        node* current = stack.back();
+        stack.pop_back();
+
+        // skip nodes missed by the ray or beyond tmax (objects of the root are always tested)
+        float tmin_tmp = std::numeric_limits<float>::max();
+        float tmax_tmp = std::numeric_limits<float>::lowest();
+        bool missed = !r.intersectsBoundingRegion(current->looseRegion, tmin_tmp, tmax_tmp) || tmin_tmp > tmax;
+        if (missed && current->parent) {
+            continue;
+        }
+
+        // stop at first hit
+        for (unsigned int obj : current->objects) {
+            BoundingRegion& br = (*pool)[obj];
+            float t = tmax;
+            if (r.intersectsRegion(br, t)) {
+                return &br;
+            }
+        }
+
+        if (missed) {
+            continue;
+        }
+
+        for (int i = NO_CHILDREN - 1; i >= 0; i--) {
+            int octant = order[i];
+            if (States::isIndexActive(&current->activeOctants, octant) && current->children[octant]) {
+                stack.push_back(current->children[octant]);
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+// check collisions with a packet of rays
+void Octree::node::checkCollisionsPacket(RayPacket& packet) {
+    alignas(32) float tEnter[RAY_PACKET_MAX];
+
+    // nodes to visit with the rays that entered their parent
+    std::vector<std::pair<node*, unsigned int>> stack;
+    stack.push_back({ this, packet.activeMask() });
+
+    while (stack.size() != 0) {
+        node* current = stack.back().first;
+        unsigned int mask = stack.back().second;
+        stack.pop_back();
+
+        // rays entering the node before their closest hit (objects may stick out of the tight region)
+        // the root keeps objects that do not fit in it, so its objects are tested with all rays
+        unsigned int entered = mask & packet.intersectsBox(current->looseRegion.min, current->looseRegion.max, tEnter);
+        if (current->parent) {
+            mask = entered;
+        }
+        if (!mask) {
+            continue;
+        }
+
+        // check objects in the node
+        for (unsigned int obj : current->objects) {
+            packet.testRegion((*pool)[obj], mask);
+        }
+
+        if (!entered) {
+            continue;
+        }
+
+        // check children with the rays that entered the node
+        for (int flags = current->activeOctants, i = 0;
             flags > 0;
             flags >>= 1, i++) {
-            if(States::isIndexActive(&flags, 0) && children[i]) {
-                children[i]->checkCollisionsSelf(obj);
-                children[i]->checkCollisionsChildren(obj);
+            if (States::isIndexActive(&flags, 0) && current->children[i]) {
+                stack.push_back({ current->children[i], entered });
             }
         }
     }
 }
 
-// check collisions with a ray
-BoundingRegion* Octree::node::checkCollisionsRay(Ray r, float& tmin) {
-    float tmin_tmp = std::numeric_limits<float>::max();
-    float tmax_tmp = std::numeric_limits<float>::lowest();
-    float t_tmp = std::numeric_limits<float>::max();
+// check collisions of a region not stored in the structure
+void Octree::node::checkCollisionsRegion(BoundingRegion& obj, std::vector<Contact>* contacts) {
+    glm::vec3 min, max;
+    BoundsPool::calculateBox(obj, min, max);
+
+    checkCollisionsRegion(obj, min, max, contacts);
+}
 
-    // check current region
-    if (r.intersectsBoundingRegion(region, tmin_tmp, tmax_tmp)) {
-        // know ray collides with the current region
-        if (tmin_tmp >= tmin) {
-            // found nearer collision
-            return nullptr;
+// check collisions of a region with its world space box in this node and its children
+void Octree::node::checkCollisionsRegion(BoundingRegion& obj, glm::vec3 min, glm::vec3 max, std::vector<Contact>* contacts) {
+    // objects of the subtree are inside the loose region
+    if (glm::any(glm::greaterThan(min, looseRegion.max)) ||
+        glm::any(glm::lessThan(max, looseRegion.min))) {
+        return;
+    }
+
+    Contact contact;
+    for (unsigned int brIdx : objects) {
+        BoundingRegion& br = (*pool)[brIdx];
+        if (br.instance == obj.instance) {
+            // do not test collision with the same instance
+            continue;
         }
 
-        BoundingRegion* ret = nullptr, * ret_tmp = nullptr;
-        
-        // check objects in the node
-        for (BoundingRegion& br : this->objects) {
-            tmin_tmp = std::numeric_limits<float>::max();
-            tmax_tmp = std::numeric_limits<float>::lowest();
-
-            // coarse check - check againts BR
-            if (r.intersectsBoundingRegion(br, tmin_tmp, tmax_tmp)) {
-                std::cout << "Passed coarse check, ";
-                if (tmin_tmp > tmin) {
-                    continue;
-                }
-                else if (br.collisionMesh) {
-                    // fine grain check with collision mesh
-                    t_tmp = std::numeric_limits<float>::max();
-                    if (r.intersectsMesh(br.collisionMesh, br.instance, t_tmp)) {
-                        if (t_tmp < tmin) {
-                            // found closer collision
-                            tmin = t_tmp;
-                            ret = &br;
-                        }
-                    }
-                }
-                else {
-                    // relly on coarse check
-                    if (tmin_tmp < tmin) {
-                        tmin = tmin_tmp;
-                        ret = &br;
-                    }
-                }
+        if (pool->boxIntersects(brIdx, min, max) && br.intersectsWith(obj) &&
+            NarrowPhase::test(br, obj, contact)) {
+            if (contacts) {
+                contacts->push_back(contact);
             }
             else {
-                std::cout << "Failed to coarse check, ";
+                NarrowPhase::resolve(contact);
             }
         }
-        // check childeren
-        if (children) {
-            for (unsigned char flags = activeOctants, i = 0;
-                flags;
-                flags >>= 1, i++) {
-                ret_tmp = children[i]->checkCollisionsRay(r, tmin);
-                if (ret_tmp) {
-                    ret = ret_tmp;
-                }
+    }
+
+    for (int flags = activeOctants, i = 0;
+        flags > 0;
+        flags >>= 1, i++) {
+        if (States::isIndexActive(&flags, 0) && children[i]) {
+            children[i]->checkCollisionsRegion(obj, min, max, contacts);
+        }
+    }
+}
+
+// add shape of tree to statistics
+void Octree::node::gatherStats(CollisionStats& stats) {
+    // nodes to visit with their depth
+    std::vector<std::pair<node*, unsigned int>> stack;
+    stack.push_back({ this, 0 });
+
+    while (stack.size() != 0) {
+        node* current = stack.back().first;
+        unsigned int depth = stack.back().second;
+        stack.pop_back();
+
+        stats.addNode(depth, (unsigned int)current->objects.size());
+        stats.pendingLength += (unsigned int)current->queue.size();
+
+        for (int i = 0; i < NO_CHILDREN; i++) {
+            if (States::isIndexActive(&current->activeOctants, i) && current->children[i]) {
+                stack.push_back({ current->children[i], depth + 1 });
             }
         }
-        return ret;
     }
-    return nullptr;
+
+    if (!parent) {
+        stats.noBlocksInUse += nodes->blocksInUse();
+        stats.noBlocksAllocated += nodes->blockCapacity();
+    }
 }
 
 // destroy object (free memory)
@@ -647,6 +772,13 @@ void Octree::node::destroy() {
             }
         }
     }
+    activeOctants = 0;
+
+    // return block of children
+    if (block) {
+        nodes->releaseBlock(block);
+        block = nullptr;
+    }
 
     // clear this node
     objects.clear();
@@ -654,4 +786,170 @@ void Octree::node::destroy() {
         queue.pop();
     }
 
+    // root owns the pools and the cache
+    if (!parent) {
+        if (pool) {
+            delete pool;
+            pool = nullptr;
+        }
+        if (nodes) {
+            nodes->cleanup();
+            delete nodes;
+            nodes = nullptr;
+        }
+        if (staticCache) {
+            delete staticCache;
+            staticCache = nullptr;
+        }
+    }
+}
+
+/*
+    range queries
+*/
+
+// find regions intersecting box
+void Octree::node::queryBox(glm::vec3 min, glm::vec3 max, QueryCallback callback) {
+    BoundingRegion box(min, max);
+
+    query([&](BoundingRegion& cell) -> Containment {
+        if (glm::any(glm::greaterThan(cell.min, max)) || glm::any(glm::lessThan(cell.max, min))) {
+            return Containment::OUTSIDE;
+        }
+        if (box.containsRegion(cell)) {
+            return Containment::INSIDE;
+        }
+        return Containment::INTERSECTS;
+    }, [&](BoundingRegion& br) -> bool {
+        return box.intersectsWith(br);
+    }, callback);
+}
+
+// find regions intersecting sphere
+void Octree::node::querySphere(glm::vec3 center, float radius, QueryCallback callback) {
+    BoundingRegion sphere(center, radius);
+
+    query([&](BoundingRegion& cell) -> Containment {
+        if (distanceToRegion(center, cell) > radius) {
+            return Containment::OUTSIDE;
+        }
+
+        // inside if the corner furthest from the center is
+        glm::vec3 furthest = glm::max(glm::abs(cell.min - center), glm::abs(cell.max - center));
+        if (glm::length(furthest) <= radius) {
+            return Containment::INSIDE;
+        }
+        return Containment::INTERSECTS;
+    }, [&](BoundingRegion& br) -> bool {
+        return sphere.intersectsWith(br);
+    }, callback);
+}
+
+// find regions intersecting frustum
+void Octree::node::queryFrustum(Frustum& frustum, QueryCallback callback) {
+    query([&](BoundingRegion& cell) -> Containment {
+        return frustum.classifyBox(cell.min, cell.max);
+    }, [&](BoundingRegion& br) -> bool {
+        return frustum.intersects(br);
+    }, callback);
+}
+
+// find k regions closest to point (nearest first)
+void Octree::node::queryNearest(glm::vec3 point, unsigned int k, NearestCallback callback) {
+    if (k == 0) {
+        return;
+    }
+
+    // nodes to visit, closest first
+    typedef std::pair<float, node*> NodeEntry;
+    std::priority_queue<NodeEntry, std::vector<NodeEntry>, std::greater<NodeEntry>> cells;
+    cells.push({ 0.0f, this });
+
+    // closest regions found so far, furthest on top
+    typedef std::pair<float, BoundingRegion*> RegionEntry;
+    std::priority_queue<RegionEntry> found;
+
+    while (cells.size() != 0) {
+        float cellDist = cells.top().first;
+        node* current = cells.top().second;
+        cells.pop();
+
+        if (found.size() == k && cellDist > found.top().first) {
+            // every remaining node is further than the k closest
+            break;
+        }
+
+        for (unsigned int obj : current->objects) {
+            BoundingRegion& br = (*pool)[obj];
+            float dist = distanceToRegion(point, br);
+            if (found.size() < k) {
+                found.push({ dist, &br });
+            }
+            else if (dist < found.top().first) {
+                found.pop();
+                found.push({ dist, &br });
+            }
+        }
+
+        for (int i = 0; i < NO_CHILDREN; i++) {
+            if (States::isIndexActive(&current->activeOctants, i) && current->children[i]) {
+                node* child = current->children[i];
+                // objects below the root fit in the loose regions
+                cells.push({ distanceToRegion(point, child->looseRegion), child });
+            }
+        }
+    }
+
+    // heap gives furthest first
+    std::vector<RegionEntry> ordered;
+    ordered.reserve(found.size());
+    while (found.size() != 0) {
+        ordered.push_back(found.top());
+        found.pop();
+    }
+    for (int i = (int)ordered.size() - 1; i >= 0; i--) {
+        callback(*ordered[i].second, ordered[i].first);
+    }
+}
+
+// walk tree with shape classifying loose regions of nodes and test for regions in intersected nodes
+void Octree::node::query(std::function<Containment(BoundingRegion&)> classify, std::function<bool(BoundingRegion&)> test, QueryCallback callback) {
+    // nodes to visit and if they are known to be inside of the shape
+    std::vector<std::pair<node*, bool>> stack;
+    stack.push_back({ this, false });
+
+    while (stack.size() != 0) {
+        node* current = stack.back().first;
+        bool inside = stack.back().second;
+        stack.pop_back();
+
+        bool outside = false;
+        if (!inside) {
+            Containment containment = classify(current->looseRegion);
+
+            // the root keeps objects that do not fit in it, so its objects are always tested
+            outside = containment == Containment::OUTSIDE;
+            if (outside && current->parent) {
+                continue;
+            }
+            inside = containment == Containment::INSIDE && current->parent;
+        }
+
+        for (unsigned int obj : current->objects) {
+            BoundingRegion& br = (*pool)[obj];
+            if (inside || test(br)) {
+                callback(br);
+            }
+        }
+
+        if (outside) {
+            continue;
+        }
+
+        for (int i = 0; i < NO_CHILDREN; i++) {
+            if (States::isIndexActive(&current->activeOctants, i) && current->children[i]) {
+                stack.push_back({ current->children[i], inside });
+            }
+        }
+    }
 }
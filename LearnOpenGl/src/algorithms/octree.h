@@ -3,24 +3,32 @@
 
 #define NO_CHILDREN 8
 #define MIN_BOUNDS 0.5
+#define LOOSENESS 2.0f
 
 #include <vector>
 #include <queue>
 #include <stack>
+#include <functional>
 
 #include <glm/glm.hpp>
 
 #include "list.hpp"
 #include "states.hpp"
 #include "bounds.h"
+#include "boundspool.h"
+#include "broadphase.h"
+#include "frustum.h"
+#include "nodepool.h"
+#include "octreecache.h"
 #include "ray.h"
 
-#include "../graphics/objects/model.h"
+#include "../physics/physicsmodel.h"
 
 // forward declaration
-class Model;
+class PhysicsModel;
 class BoundingRegion;
-class Box;
+class BoxList;
+struct Contact;
 
 /*
 	namespace to tie together all classes and functions relating to octree
@@ -42,6 +50,15 @@ namespace Octree {
 		O8 = 0x80	// = 0b10000000
 	};
 
+	/*
+		callbacks for range queries
+	*/
+
+	// receives each region found
+	typedef BroadPhase::QueryCallback QueryCallback;
+	// receives each region found with its distance to the query point
+	typedef std::function<void(BoundingRegion&, float)> NearestCallback;
+
 	/*
 		ulility methods callback
 	*/
@@ -49,19 +66,38 @@ namespace Octree {
 	// calculate bounds of specified quadrant in bounding region
 	void calculateBounds(BoundingRegion &out, Octant octant, BoundingRegion parentRegion);
 
+	// get octants in the order a ray with direction passes through them (nearest first)
+	void orderOctants(int order[NO_CHILDREN], glm::vec3 dir);
+
+	// calculate bounds of region scaled about its center by looseness
+	void calculateLooseBounds(BoundingRegion &out, BoundingRegion region, float looseness);
+
+	// get distance from point to region (0 if inside)
+	float distanceToRegion(glm::vec3 point, BoundingRegion& br);
+
 	/*
 		class to represent each node in the octree
 	*/
-	class node {
+	class node : public BroadPhase {
 	public:
 		// parent pointer
 		node* parent;
-		// array of children (8)
+		// array of children (8, pointers into block)
 		node* children[NO_CHILDREN];
+		// block of child nodes (nullptr if no children)
+		node* block;
 
 		// switch for active octants
 		unsigned char activeOctants;
 
+		// pool storing the regions of the tree (shared by all nodes)
+		BoundsPool* pool;
+		// pool allocating the nodes of the tree (shared by all nodes)
+		NodePool* nodes;
+
+		// file the static part of the tree is kept in between runs (root only, nullptr = always build)
+		OctreeCache* staticCache = nullptr;
+
 		// if tree is ready
 		bool treeReady = false;
 		// if tree is built
@@ -72,14 +108,19 @@ namespace Octree {
 		// current lifespace
 		short currentLifeSpan = -1;
 
-		// list of objects in node
-		std::vector<BoundingRegion> objects;
-		// queue of objects to be dynamically inserted
-		std::queue<BoundingRegion> queue;
+		// list of objects in node (indices in pool)
+		std::vector<unsigned int> objects;
+		// queue of objects to be dynamically inserted (indices in pool)
+		std::queue<unsigned int> queue;
 
 		// region of bounds of cell (AABB)
 		BoundingRegion region;
 
+		// factor child bounds are scaled by (1 = strict octree, shared by all nodes)
+		float looseness;
+		// region objects in the cell must fit in (region scaled by looseness)
+		BoundingRegion looseRegion;
+
 		/*
 			constructors
 		*/
@@ -87,42 +128,130 @@ namespace Octree {
 		// default
 		node();
 
-		// initialize with bounds (no objects yet)
-		node(BoundingRegion bound);
+		// initialize root with bounds and looseness (no objects yet, allocates pools)
+		node(BoundingRegion bound, float looseness = 1.0f);
 
-		// initialize with bounds and list of objects
-		node(BoundingRegion bounds, std::vector<BoundingRegion> objectsList);
+		// reset node taken from a block with bounds, pools of tree and looseness
+		void init(BoundingRegion bounds, BoundsPool* pool, NodePool* nodes, float looseness);
 
 		/*
 			functionality
 		*/
 
 		// add instance to pending queue
-		void addToPending(RigidBody* instance, Model* model);
+		void addToPending(RigidBody* instance, PhysicsModel* model);
 
 		// build tree (called during initialization)
 		void build();
 
 		// update objects in tree (called during each iteration of main loop)
-		void update(Box& box);
+		void update(BoxList& box);
+
+		// update objects in tree
+		// moved objects are gathered into movedList (collisions are tested once the whole tree is updated)
+		void update(BoxList& box, std::vector<unsigned int>* movedList);
 
 		// process pending queue
 		void processPending();
 
+		// place static objects from the cache, or build them and save the cache
+		void buildStatic();
+
 		// dynamically insert object into node
-		bool insert(BoundingRegion obj); 
+		bool insert(unsigned int obj);
+
+		// create child in octant with list of objects and build it
+		void createChild(int octant, BoundingRegion bounds, std::vector<unsigned int>& objectsList);
 
-		// check collision with all objects in node
-		void checkCollisionsSelf(BoundingRegion obj);
+		// destroy child in octant, releasing the block once no children are left
+		void releaseChild(int octant);
 
-		// check collisions with all objects in child nodes
-		void checkCollisionsChildren(BoundingRegion obj);
+		// add object to list of node
+		void addObject(unsigned int obj);
+
+		// remove object from list of node (swap with last)
+		void removeObject(unsigned int obj);
+
+		// check collisions of object stored in the tree with all objects in cells its box overlaps the loose region of (searched from the root)
+		// contacts are gathered into list if given, otherwise resolved immediately
+		void checkCollisionsObject(unsigned int obj, std::vector<Contact>* contacts = nullptr);
+
+		// check collisions of moved objects (on the worker pool if there is one)
+		void checkCollisionsMoved(std::vector<unsigned int>& movedList);
 
 		// check collisions with a ray
 		BoundingRegion* checkCollisionsRay(Ray r, float& tmin);
 
+		// check for any collision with a ray closer than tmax (returns first region found)
+		BoundingRegion* checkCollisionsRayAny(Ray r, float tmax);
+
+		// check collisions with a packet of rays
+		void checkCollisionsPacket(RayPacket& packet);
+
+		// check collisions of a region not stored in the structure
+		void checkCollisionsRegion(BoundingRegion& obj, std::vector<Contact>* contacts = nullptr);
+
+		// check collisions of a region with its world space box in this node and its children
+		void checkCollisionsRegion(BoundingRegion& obj, glm::vec3 min, glm::vec3 max, std::vector<Contact>* contacts);
+
+		// add shape of tree to statistics
+		void gatherStats(CollisionStats& stats);
+
 		// destroy object (free memory)
 		void destroy();
+
+		/*
+			range queries
+			- an instance with several regions is reported once for each region
+			- subtrees outside of the query are skipped, regions in subtrees inside of it are reported without tests
+		*/
+
+		// find regions intersecting box
+		void queryBox(glm::vec3 min, glm::vec3 max, QueryCallback callback);
+
+		// find regions intersecting sphere
+		void querySphere(glm::vec3 center, float radius, QueryCallback callback);
+
+		// find regions intersecting frustum
+		void queryFrustum(Frustum& frustum, QueryCallback callback);
+
+		// find k regions closest to point (nearest first)
+		void queryNearest(glm::vec3 point, unsigned int k, NearestCallback callback);
+
+		// walk tree with shape classifying loose regions of nodes and test for regions in intersected nodes
+		void query(std::function<Containment(BoundingRegion&)> classify, std::function<bool(BoundingRegion&)> test, QueryCallback callback);
+
+		/*
+			range queries writing region pointers to an output iterator
+		*/
+
+		// find regions intersecting box
+		template<typename OutputIt>
+		OutputIt collectBox(glm::vec3 min, glm::vec3 max, OutputIt out) {
+			queryBox(min, max, [&out](BoundingRegion& br) -> void { *out++ = &br; });
+			return out;
+		}
+
+		// find regions intersecting sphere
+		template<typename OutputIt>
+		OutputIt collectSphere(glm::vec3 center, float radius, OutputIt out) {
+			querySphere(center, radius, [&out](BoundingRegion& br) -> void { *out++ = &br; });
+			return out;
+		}
+
+		// find regions intersecting frustum
+		template<typename OutputIt>
+		OutputIt collectFrustum(Frustum& frustum, OutputIt out) {
+			queryFrustum(frustum, [&out](BoundingRegion& br) -> void { *out++ = &br; });
+			return out;
+		}
+
+		// find k regions closest to point (nearest first)
+		template<typename OutputIt>
+		OutputIt collectNearest(glm::vec3 point, unsigned int k, OutputIt out) {
+			queryNearest(point, k, [&out](BoundingRegion& br, float) -> void { *out++ = &br; });
+			return out;
+		}
 	};
 }
 
@@ -0,0 +1,302 @@
+#include "octreecache.h"
+
+// platform file mapping
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <fstream>
+
+#include "octree.h"
+
+// FNV-1a parameters
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+/*
+    read only mapping of an entire file
+*/
+
+typedef struct MappedFile {
+    const char* data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+} MappedFile;
+
+// map file into memory, data is nullptr if it could not be mapped
+static MappedFile mapFile(std::string path) {
+    MappedFile ret = {};
+
+#ifdef _WIN32
+    ret.file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (ret.file == INVALID_HANDLE_VALUE) {
+        return ret;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(ret.file, &size) || size.QuadPart == 0) {
+        return ret;
+    }
+
+    ret.mapping = CreateFileMappingA(ret.file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!ret.mapping) {
+        return ret;
+    }
+
+    ret.data = (const char*)MapViewOfFile(ret.mapping, FILE_MAP_READ, 0, 0, 0);
+    ret.size = (size_t)size.QuadPart;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return ret;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            ret.data = (const char*)data;
+            ret.size = (size_t)st.st_size;
+        }
+    }
+
+    // mapping stays valid after the descriptor is closed
+    close(fd);
+#endif
+
+    return ret;
+}
+
+// release mapping
+static void unmapFile(MappedFile& file) {
+#ifdef _WIN32
+    if (file.data) {
+        UnmapViewOfFile(file.data);
+    }
+    if (file.mapping) {
+        CloseHandle(file.mapping);
+    }
+    if (file.file && file.file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file.file);
+    }
+#else
+    if (file.data) {
+        munmap((void*)file.data, file.size);
+    }
+#endif
+
+    file = {};
+}
+
+/*
+    constructor
+*/
+
+// initialize with path of cache file
+OctreeCache::OctreeCache(std::string path)
+    : path(path), hash(FNV_OFFSET) {}
+
+/*
+    functionality
+*/
+
+// add static instance to hash (object space regions and transform)
+void OctreeCache::addInstance(RigidBody* instance, PhysicsModel* model) {
+    hash = hashBytes(hash, model->id.c_str(), model->id.size());
+    hash = hashBytes(hash, &instance->getModel(), sizeof(glm::mat4));
+
+    for (BoundingRegion& br : model->boundingRegions) {
+        hash = hashBytes(hash, &br.type, sizeof(br.type));
+        if (br.type != BoundTypes::SPHERE) {
+            hash = hashBytes(hash, &br.ogMin, sizeof(glm::vec3));
+            hash = hashBytes(hash, &br.ogMax, sizeof(glm::vec3));
+        }
+        else {
+            hash = hashBytes(hash, &br.ogCenter, sizeof(glm::vec3));
+            hash = hashBytes(hash, &br.ogRadius, sizeof(float));
+        }
+    }
+}
+
+// get key of the tree (hash combined with the parameters of the root)
+unsigned long long OctreeCache::key(Octree::node* root) {
+    float minBounds = (float)MIN_BOUNDS;
+
+    unsigned long long ret = hash;
+    ret = hashBytes(ret, &root->region.min, sizeof(glm::vec3));
+    ret = hashBytes(ret, &root->region.max, sizeof(glm::vec3));
+    ret = hashBytes(ret, &root->looseness, sizeof(float));
+    ret = hashBytes(ret, &minBounds, sizeof(float));
+
+    return ret;
+}
+
+// place static objects into empty tree from the file, returns false if missing or out of date
+bool OctreeCache::load(Octree::node* root) {
+    MappedFile file = mapFile(path);
+    if (!file.data || file.size < sizeof(OctreeCacheHeader)) {
+        unmapFile(file);
+        return false;
+    }
+
+    // check header
+    const OctreeCacheHeader* header = (const OctreeCacheHeader*)file.data;
+    if (header->magic != OCTREE_CACHE_MAGIC ||
+        header->version != OCTREE_CACHE_VERSION ||
+        header->hash != key(root) ||
+        header->noObjects != (unsigned int)statics.size() ||
+        file.size != sizeof(OctreeCacheHeader) +
+            (size_t)header->noNodes * sizeof(OctreeCacheNode) +
+            (size_t)header->noObjects * sizeof(unsigned int)) {
+        unmapFile(file);
+        return false;
+    }
+
+    const OctreeCacheNode* nodes = (const OctreeCacheNode*)(file.data + sizeof(OctreeCacheHeader));
+    const unsigned int* objects = (const unsigned int*)(nodes + header->noNodes);
+
+    // check records before touching the tree
+    unsigned int nodeIdx = 0, objectIdx = 0;
+    std::vector<bool> placed(statics.size(), false);
+    if (header->noNodes == 0 ||
+        !validate(nodes, header->noNodes, objects, header->noObjects, nodeIdx, objectIdx, placed) ||
+        nodeIdx != header->noNodes || objectIdx != header->noObjects) {
+        unmapFile(file);
+        return false;
+    }
+
+    read(root, nodes, objects);
+
+    unmapFile(file);
+    return true;
+}
+
+// write tree holding only the static objects to the file
+bool OctreeCache::save(Octree::node* root) {
+    // map pool indices back to the order the regions were added
+    std::vector<unsigned int> ordinals(root->pool->regions.size(), NULL_BOUNDS);
+    for (unsigned int i = 0, noStatics = (unsigned int)statics.size(); i < noStatics; i++) {
+        ordinals[statics[i]] = i;
+    }
+
+    std::vector<OctreeCacheNode> nodes;
+    std::vector<unsigned int> objects;
+    objects.reserve(statics.size());
+    write(root, nodes, objects, ordinals);
+
+    OctreeCacheHeader header = {};
+    header.magic = OCTREE_CACHE_MAGIC;
+    header.version = OCTREE_CACHE_VERSION;
+    header.hash = key(root);
+    header.noNodes = (unsigned int)nodes.size();
+    header.noObjects = (unsigned int)objects.size();
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file.write((const char*)&header, sizeof(OctreeCacheHeader));
+    file.write((const char*)nodes.data(), nodes.size() * sizeof(OctreeCacheNode));
+    file.write((const char*)objects.data(), objects.size() * sizeof(unsigned int));
+
+    return file.good();
+}
+
+/*
+    private methods
+*/
+
+// add bytes to hash (FNV-1a)
+unsigned long long OctreeCache::hashBytes(unsigned long long h, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        h ^= bytes[i];
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+// check records of subtree fit in the file and reference each object once
+bool OctreeCache::validate(const OctreeCacheNode* nodes, unsigned int noNodes, const unsigned int* objects, unsigned int noObjects,
+    unsigned int& nodeIdx, unsigned int& objectIdx, std::vector<bool>& placed) {
+    if (nodeIdx >= noNodes) {
+        return false;
+    }
+
+    const OctreeCacheNode& record = nodes[nodeIdx++];
+    if (record.noObjects > noObjects - objectIdx) {
+        return false;
+    }
+
+    for (unsigned int i = 0; i < record.noObjects; i++, objectIdx++) {
+        unsigned int ordinal = objects[objectIdx];
+        if (ordinal >= placed.size() || placed[ordinal]) {
+            return false;
+        }
+        placed[ordinal] = true;
+    }
+
+    for (int i = 0; i < NO_CHILDREN; i++) {
+        if (States::isIndexActive(&record.activeOctants, i) &&
+            !validate(nodes, noNodes, objects, noObjects, nodeIdx, objectIdx, placed)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// create subtree of node from records
+void OctreeCache::read(Octree::node* current, const OctreeCacheNode*& nodes, const unsigned int*& objects) {
+    const OctreeCacheNode& record = *(nodes++);
+
+    for (unsigned int i = 0; i < record.noObjects; i++) {
+        current->addObject(statics[*(objects++)]);
+    }
+
+    // children get their regions from the parent, so only the structure is stored
+    std::vector<unsigned int> empty;
+    for (int i = 0; i < NO_CHILDREN; i++) {
+        if (States::isIndexActive(&record.activeOctants, i)) {
+            BoundingRegion bounds;
+            Octree::calculateBounds(bounds, (Octree::Octant)(1 << i), current->region);
+            current->createChild(i, bounds, empty);
+            read(current->children[i], nodes, objects);
+        }
+    }
+
+    current->treeBuilt = true;
+    current->treeReady = true;
+}
+
+// add records of subtree of node
+void OctreeCache::write(Octree::node* current, std::vector<OctreeCacheNode>& nodes, std::vector<unsigned int>& objects,
+    std::vector<unsigned int>& ordinals) {
+    OctreeCacheNode record = {};
+    record.noObjects = (unsigned int)current->objects.size();
+    for (unsigned int obj : current->objects) {
+        objects.push_back(ordinals[obj]);
+    }
+
+    // record is added before the children, fill in octants after
+    unsigned int recordIdx = (unsigned int)nodes.size();
+    nodes.push_back(record);
+
+    for (int i = 0; i < NO_CHILDREN; i++) {
+        if (States::isIndexActive(&current->activeOctants, i) && current->children[i]) {
+            States::activateIndex(&nodes[recordIdx].activeOctants, i);
+            write(current->children[i], nodes, objects, ordinals);
+        }
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef OCTREECACHE_H
+#define OCTREECACHE_H
+
+#include <string>
+#include <vector>
+
+// forward declarations
+namespace Octree {
+	class node;
+}
+
+class PhysicsModel;
+class RigidBody;
+
+// identifies octree cache files ("OCTC")
+#define OCTREE_CACHE_MAGIC 0x4354434f
+// change when the file layout or the build rules change
+#define OCTREE_CACHE_VERSION 1
+
+/*
+	header at the start of a cache file
+*/
+
+typedef struct OctreeCacheHeader {
+	// file identification
+	unsigned int magic;
+	unsigned int version;
+
+	// content hash of the static instances and tree parameters
+	unsigned long long hash;
+
+	// number of node records
+	unsigned int noNodes;
+	// number of object entries
+	unsigned int noObjects;
+} OctreeCacheHeader;
+
+/*
+	record of each node, stored in preorder (children follow their parent in octant order)
+*/
+
+typedef struct OctreeCacheNode {
+	// active octants of the node
+	unsigned char activeOctants;
+	// number of objects in the node (entries follow those of the previous record)
+	unsigned int noObjects;
+} OctreeCacheNode;
+
+/*
+	class to keep the static part of an octree in a file between runs
+	- instances of CONST_INSTANCES models are hashed with their transforms as they are added
+	- when the hash matches, the file is memory mapped and the nodes are created from it instead of building the tree
+	- objects are stored by the order their regions were added, so the file does not depend on pool indices
+*/
+
+class OctreeCache {
+public:
+	// path of the cache file
+	std::string path;
+
+	// content hash of the static instances added so far
+	unsigned long long hash;
+
+	// pool indices of the static regions in the order they were added
+	std::vector<unsigned int> statics;
+
+	/*
+		constructor
+	*/
+
+	// initialize with path of cache file
+	OctreeCache(std::string path);
+
+	/*
+		functionality
+	*/
+
+	// add static instance to hash (object space regions and transform)
+	void addInstance(RigidBody* instance, PhysicsModel* model);
+
+	// get key of the tree (hash combined with the parameters of the root)
+	unsigned long long key(Octree::node* root);
+
+	// place static objects into empty tree from the file, returns false if missing or out of date
+	bool load(Octree::node* root);
+
+	// write tree holding only the static objects to the file
+	bool save(Octree::node* root);
+
+private:
+	// add bytes to hash (FNV-1a)
+	static unsigned long long hashBytes(unsigned long long h, const void* data, size_t size);
+
+	// check records of subtree fit in the file and reference each object once
+	bool validate(const OctreeCacheNode* nodes, unsigned int noNodes, const unsigned int* objects, unsigned int noObjects,
+		unsigned int& nodeIdx, unsigned int& objectIdx, std::vector<bool>& placed);
+
+	// create subtree of node from records
+	void read(Octree::node* current, const OctreeCacheNode*& nodes, const unsigned int*& objects);
+
+	// add records of subtree of node
+	void write(Octree::node* current, std::vector<OctreeCacheNode>& nodes, std::vector<unsigned int>& objects,
+		std::vector<unsigned int>& ordinals);
+};
+
+#endif // !OCTREECACHE_H
@@ -1,4 +1,5 @@
 #include "ray.h"
+#include "trianglebatch.h"
 #include "math/linalg.h"
 
 #include <limits>
@@ -10,7 +11,7 @@ Ray::Ray(glm::vec3 origin, glm::vec3 dir)
 	}
 }
 
-bool Ray::intersectsBoundingRegion(BoundingRegion br, float& tmin, float& tmax) {
+bool Ray::intersectsBoundingRegion(BoundingRegion& br, float& tmin, float& tmax) {
 	if (br.type == BoundTypes::AABB) {
 		// slab algorithm
 		tmin = std::numeric_limits<float>::lowest(); // maxOfMin
@@ -26,6 +27,24 @@ bool Ray::intersectsBoundingRegion(BoundingRegion br, float& tmin, float& tmax)
 
 		return (tmax >= tmin) && tmax >= 0.0f;
 	}
+	else if (br.type == BoundTypes::OBB) {
+		// slab algorithm in the frame of the box (distances along the ray stay the same)
+		tmin = std::numeric_limits<float>::lowest();
+		tmax = std::numeric_limits<float>::max();
+
+		glm::vec3 d = origin - br.center;
+		for (int i = 0; i < 3; i++) {
+			float o = glm::dot(d, br.axes[i]);
+			float inv = 1.0f / glm::dot(dir, br.axes[i]);
+			float t1 = (-br.halfSize[i] - o) * inv;
+			float t2 = (br.halfSize[i] - o) * inv;
+
+			tmin = std::fmaxf(tmin, std::fminf(t1, t2));
+			tmax = std::fminf(tmax, std::fmaxf(t1, t2));
+		}
+
+		return (tmax >= tmin) && tmax >= 0.0f;
+	}
 	else {
 		// ray-sphere collision
 		// plug in line equation of ray into sphere equation
@@ -50,42 +69,63 @@ bool Ray::intersectsBoundingRegion(BoundingRegion br, float& tmin, float& tmax)
 		tmax = (-b + D) / (2.0f * a);
 		tmin = (-b - D) / (2.0f * a);
 		
-		return true;
+		// sphere behind the origin
+		return tmax >= 0.0f;
 	}
 }
 
 bool Ray::intersectsMesh(CollisionMesh* mesh, RigidBody* rb, float& t) {
 	bool intersects = false;
 
-	for (Face& f : mesh->faces) {
-		float tmp = -1.0f;
-		glm::vec3 P1 = mat4vec3mult(rb->model, mesh->points[f.i1]);
-		glm::vec3 P2 = mat4vec3mult(rb->model, mesh->points[f.i2]) - P1;
-		glm::vec3 P3 = mat4vec3mult(rb->model, mesh->points[f.i3]) - P1;
-		glm::vec3 norm = rb->normalModel * f.norm;
-
-		glm::vec3 U1 = origin - P1;
+	// ray in local space of the mesh (t is the same in both spaces)
+	glm::mat4 toLocal = glm::inverse(rb->getModel());
+	glm::vec3 localOrigin = glm::vec3(toLocal * glm::vec4(origin, 1.0f));
+	glm::vec3 localDir = glm::mat3(toLocal) * dir;
+
+	// faces of each leaf hit by the ray are tested in a batch, closer leaves first
+	mesh->bvh.queryRay(localOrigin, localDir, t, [&](unsigned int* faces, unsigned int count) -> bool {
+		TriangleBatch batch;
+		for (unsigned int i = 0; i < count; i++) {
+			Face& f = mesh->faces[faces[i]];
+			batch.add(mesh->points[f.i1], mesh->points[f.i2], mesh->points[f.i3]);
+		}
 
-		LinePlaneIntCase intCase = linePlaneIntersection(glm::vec3(0.0f), norm, U1, dir, tmp);
+		float tmp;
+		if (batch.intersectsRay(localOrigin, localDir, tmp) && tmp <= t) {
+			// found closer collision
+			intersects = true;
+			t = tmp;
+		}
+		return false;
+	});
 
-		if ((char)intCase > 1) {
-			// intersection with the infine plane at one point
-			if (tmp < 0.0f || t < tmp) {
-				// collision happends behind the origin
-				// or found a closer collision
+	return intersects;
+}
 
-				continue;
-			}
+bool Ray::intersectsRegion(BoundingRegion& br, float& t) {
+	float tmin = std::numeric_limits<float>::max();
+	float tmax = std::numeric_limits<float>::lowest();
 
-			// get point of intersection
-			glm::vec3 intersection = U1 + tmp * dir;
+	// coarse check - check againts BR
+	if (!intersectsBoundingRegion(br, tmin, tmax) || tmin > t) {
+		return false;
+	}
 
-			if (faceContainsPoint(P2, P3, norm, intersection)) {
-				intersects = true;
-				t = fminf(t, tmp);
-			}
+	if (br.collisionMesh) {
+		// fine grain check with collision mesh
+		float tmesh = std::numeric_limits<float>::max();
+		if (intersectsMesh(br.collisionMesh, br.instance, tmesh) && tmesh < t) {
+			// found closer collision
+			t = tmesh;
+			return true;
 		}
+		return false;
 	}
 
-	return intersects;
+	// relly on coarse check
+	if (tmin < t) {
+		t = tmin;
+		return true;
+	}
+	return false;
 }
@@ -16,9 +16,12 @@ public:
 
 	Ray(glm::vec3 origin, glm::vec3 dir);
 
-	bool intersectsBoundingRegion(BoundingRegion br, float &tmin, float &tmax);
+	bool intersectsBoundingRegion(BoundingRegion& br, float &tmin, float &tmax);
 	bool intersectsMesh(CollisionMesh *mesh, RigidBody *rb, float &t);
 
+	// check region (collision mesh if it has one) for a hit closer than t, updates t if found
+	bool intersectsRegion(BoundingRegion& br, float& t);
+
 };
 
 #endif // !RAY_H
@@ -0,0 +1,303 @@
+#include "raypacket.h"
+#include "math/simd.h"
+
+#include <cmath>
+#include <limits>
+
+/*
+	constructor
+*/
+
+// initialize empty packet
+RayPacket::RayPacket() {
+	clear();
+}
+
+/*
+	packet management
+*/
+
+// add ray to packet, returns false if full
+bool RayPacket::add(Ray& r) {
+	if (count == RAY_PACKET_MAX) {
+		return false;
+	}
+
+	ox[count] = r.origin.x;
+	oy[count] = r.origin.y;
+	oz[count] = r.origin.z;
+	dx[count] = r.dir.x;
+	dy[count] = r.dir.y;
+	dz[count] = r.dir.z;
+	ix[count] = r.invdir.x;
+	iy[count] = r.invdir.y;
+	iz[count] = r.invdir.z;
+	t[count] = std::numeric_limits<float>::max();
+	hits[count] = nullptr;
+	count++;
+
+	return true;
+}
+
+// get ray at index
+Ray RayPacket::getRay(unsigned int i) {
+	return Ray(glm::vec3(ox[i], oy[i], oz[i]), glm::vec3(dx[i], dy[i], dz[i]));
+}
+
+// mask with a bit for each ray in the packet
+unsigned int RayPacket::activeMask() {
+	return (1u << count) - 1;
+}
+
+// remove all rays
+void RayPacket::clear() {
+	count = 0;
+
+	// unused lanes never hit anything
+	for (int i = 0; i < RAY_PACKET_MAX; i++) {
+		ox[i] = oy[i] = oz[i] = 0.0f;
+		dx[i] = dy[i] = dz[i] = 1.0f;
+		ix[i] = iy[i] = iz[i] = 1.0f;
+		t[i] = std::numeric_limits<float>::lowest();
+		hits[i] = nullptr;
+	}
+}
+
+/*
+	intersection tests (return mask of rays entering before their closest hit)
+*/
+
+// slab test against box, entry distances are written to tEnter
+unsigned int RayPacket::intersectsBox(glm::vec3 min, glm::vec3 max, float* tEnter) {
+	unsigned int mask = 0;
+
+#ifdef SIMD_WIDTH
+	simd_float minX = simd_set1(min.x), minY = simd_set1(min.y), minZ = simd_set1(min.z);
+	simd_float maxX = simd_set1(max.x), maxY = simd_set1(max.y), maxZ = simd_set1(max.z);
+	simd_float zero = simd_set1(0.0f);
+
+	for (unsigned int i = 0; i < count; i += SIMD_WIDTH) {
+		simd_float o, inv, t1, t2;
+
+		// x slab
+		o = simd_load(ox + i);
+		inv = simd_load(ix + i);
+		t1 = simd_mul(simd_sub(minX, o), inv);
+		t2 = simd_mul(simd_sub(maxX, o), inv);
+		simd_float tmin = simd_min(t1, t2);
+		simd_float tmax = simd_max(t1, t2);
+
+		// y slab
+		o = simd_load(oy + i);
+		inv = simd_load(iy + i);
+		t1 = simd_mul(simd_sub(minY, o), inv);
+		t2 = simd_mul(simd_sub(maxY, o), inv);
+		tmin = simd_max(tmin, simd_min(t1, t2));
+		tmax = simd_min(tmax, simd_max(t1, t2));
+
+		// z slab
+		o = simd_load(oz + i);
+		inv = simd_load(iz + i);
+		t1 = simd_mul(simd_sub(minZ, o), inv);
+		t2 = simd_mul(simd_sub(maxZ, o), inv);
+		tmin = simd_max(tmin, simd_min(t1, t2));
+		tmax = simd_min(tmax, simd_max(t1, t2));
+
+		// hit if slabs overlap in front of the origin and before the closest hit
+		simd_float hit = simd_and(simd_and(simd_ge(tmax, tmin), simd_ge(tmax, zero)), simd_le(tmin, simd_load(t + i)));
+
+		simd_store(tEnter + i, tmin);
+		mask |= simd_mask(hit) << i;
+	}
+#else
+	for (unsigned int i = 0; i < count; i++) {
+		float o[3] = { ox[i], oy[i], oz[i] };
+		float inv[3] = { ix[i], iy[i], iz[i] };
+
+		float tmin = std::numeric_limits<float>::lowest();
+		float tmax = std::numeric_limits<float>::max();
+		for (int j = 0; j < 3; j++) {
+			float t1 = (min[j] - o[j]) * inv[j];
+			float t2 = (max[j] - o[j]) * inv[j];
+
+			tmin = std::fmaxf(tmin, std::fminf(t1, t2));
+			tmax = std::fminf(tmax, std::fmaxf(t1, t2));
+		}
+
+		tEnter[i] = tmin;
+		if (tmax >= tmin && tmax >= 0.0f && tmin <= t[i]) {
+			mask |= 1u << i;
+		}
+	}
+#endif
+
+	return mask & activeMask();
+}
+
+// slab test against oriented box in its own frame, entry distances are written to tEnter
+unsigned int RayPacket::intersectsOrientedBox(glm::vec3 center, glm::mat3 axes, glm::vec3 halfSize, float* tEnter) {
+	unsigned int mask = 0;
+
+#ifdef SIMD_WIDTH
+	simd_float cx = simd_set1(center.x), cy = simd_set1(center.y), cz = simd_set1(center.z);
+	simd_float zero = simd_set1(0.0f), one = simd_set1(1.0f);
+
+	for (unsigned int i = 0; i < count; i += SIMD_WIDTH) {
+		simd_float relX = simd_sub(simd_load(ox + i), cx);
+		simd_float relY = simd_sub(simd_load(oy + i), cy);
+		simd_float relZ = simd_sub(simd_load(oz + i), cz);
+		simd_float dirX = simd_load(dx + i), dirY = simd_load(dy + i), dirZ = simd_load(dz + i);
+
+		simd_float tmin = simd_set1(std::numeric_limits<float>::lowest());
+		simd_float tmax = simd_set1(std::numeric_limits<float>::max());
+		for (int j = 0; j < 3; j++) {
+			simd_float axX = simd_set1(axes[j].x), axY = simd_set1(axes[j].y), axZ = simd_set1(axes[j].z);
+			simd_float h = simd_set1(halfSize[j]);
+
+			// origin and direction along the axis of the box
+			simd_float o = simd_add(simd_add(simd_mul(relX, axX), simd_mul(relY, axY)), simd_mul(relZ, axZ));
+			simd_float inv = simd_div(one, simd_add(simd_add(simd_mul(dirX, axX), simd_mul(dirY, axY)), simd_mul(dirZ, axZ)));
+
+			simd_float t1 = simd_mul(simd_sub(simd_sub(zero, h), o), inv);
+			simd_float t2 = simd_mul(simd_sub(h, o), inv);
+			tmin = simd_max(tmin, simd_min(t1, t2));
+			tmax = simd_min(tmax, simd_max(t1, t2));
+		}
+
+		// hit if slabs overlap in front of the origin and before the closest hit
+		simd_float hit = simd_and(simd_and(simd_ge(tmax, tmin), simd_ge(tmax, zero)), simd_le(tmin, simd_load(t + i)));
+
+		simd_store(tEnter + i, tmin);
+		mask |= simd_mask(hit) << i;
+	}
+#else
+	for (unsigned int i = 0; i < count; i++) {
+		glm::vec3 rel = glm::vec3(ox[i], oy[i], oz[i]) - center;
+		glm::vec3 dir(dx[i], dy[i], dz[i]);
+
+		float tmin = std::numeric_limits<float>::lowest();
+		float tmax = std::numeric_limits<float>::max();
+		for (int j = 0; j < 3; j++) {
+			float o = glm::dot(rel, axes[j]);
+			float inv = 1.0f / glm::dot(dir, axes[j]);
+			float t1 = (-halfSize[j] - o) * inv;
+			float t2 = (halfSize[j] - o) * inv;
+
+			tmin = std::fmaxf(tmin, std::fminf(t1, t2));
+			tmax = std::fminf(tmax, std::fmaxf(t1, t2));
+		}
+
+		tEnter[i] = tmin;
+		if (tmax >= tmin && tmax >= 0.0f && tmin <= t[i]) {
+			mask |= 1u << i;
+		}
+	}
+#endif
+
+	return mask & activeMask();
+}
+
+// test against sphere, entry distances are written to tEnter
+unsigned int RayPacket::intersectsSphere(glm::vec3 center, float radius, float* tEnter) {
+	unsigned int mask = 0;
+
+	// plug in line equation of ray into sphere equation, solve quadratic for t
+#ifdef SIMD_WIDTH
+	simd_float cx = simd_set1(center.x), cy = simd_set1(center.y), cz = simd_set1(center.z);
+	simd_float r2 = simd_set1(radius * radius);
+	simd_float two = simd_set1(2.0f), four = simd_set1(4.0f), zero = simd_set1(0.0f);
+
+	for (unsigned int i = 0; i < count; i += SIMD_WIDTH) {
+		simd_float dirX = simd_load(dx + i), dirY = simd_load(dy + i), dirZ = simd_load(dz + i);
+
+		// vector from center of sphere to ray origin
+		simd_float cpX = simd_sub(simd_load(ox + i), cx);
+		simd_float cpY = simd_sub(simd_load(oy + i), cy);
+		simd_float cpZ = simd_sub(simd_load(oz + i), cz);
+
+		// coefficients of the quadratic
+		simd_float a = simd_add(simd_add(simd_mul(dirX, dirX), simd_mul(dirY, dirY)), simd_mul(dirZ, dirZ));
+		simd_float b = simd_mul(two, simd_add(simd_add(simd_mul(dirX, cpX), simd_mul(dirY, cpY)), simd_mul(dirZ, cpZ)));
+		simd_float c = simd_sub(simd_add(simd_add(simd_mul(cpX, cpX), simd_mul(cpY, cpY)), simd_mul(cpZ, cpZ)), r2);
+
+		// discriminant (negative lanes give nan and are masked out)
+		simd_float D = simd_sub(simd_mul(b, b), simd_mul(four, simd_mul(a, c)));
+		simd_float hit = simd_ge(D, zero);
+
+		// sphere ahead of the origin and entered before the closest hit
+		simd_float sqrtD = simd_sqrt(D);
+		simd_float tmin = simd_div(simd_sub(simd_sub(zero, b), sqrtD), simd_mul(two, a));
+		simd_float tmax = simd_div(simd_add(simd_sub(zero, b), sqrtD), simd_mul(two, a));
+		hit = simd_and(hit, simd_and(simd_ge(tmax, zero), simd_le(tmin, simd_load(t + i))));
+
+		simd_store(tEnter + i, tmin);
+		mask |= simd_mask(hit) << i;
+	}
+#else
+	for (unsigned int i = 0; i < count; i++) {
+		glm::vec3 dir(dx[i], dy[i], dz[i]);
+		glm::vec3 cp = glm::vec3(ox[i], oy[i], oz[i]) - center;
+
+		float a = glm::dot(dir, dir);
+		float b = 2.0f * glm::dot(dir, cp);
+		float c = glm::dot(cp, cp) - radius * radius;
+
+		float D = b * b - 4.0f * a * c;
+		if (D < 0.0f) {
+			continue;
+		}
+
+		// sphere ahead of the origin and entered before the closest hit
+		D = sqrtf(D);
+		tEnter[i] = (-b - D) / (2.0f * a);
+		if ((-b + D) / (2.0f * a) >= 0.0f && tEnter[i] <= t[i]) {
+			mask |= 1u << i;
+		}
+	}
+#endif
+
+	return mask & activeMask();
+}
+
+// test against bounding region, entry distances are written to tEnter
+unsigned int RayPacket::intersectsBoundingRegion(BoundingRegion& br, float* tEnter) {
+	if (br.type == BoundTypes::AABB) {
+		return intersectsBox(br.min, br.max, tEnter);
+	}
+	else if (br.type == BoundTypes::OBB) {
+		return intersectsOrientedBox(br.center, br.axes, br.halfSize, tEnter);
+	}
+	else {
+		return intersectsSphere(br.center, br.radius, tEnter);
+	}
+}
+
+// test region for rays in mask and update their closest hits (collision mesh is checked per ray)
+void RayPacket::testRegion(BoundingRegion& br, unsigned int mask) {
+	alignas(32) float tEnter[RAY_PACKET_MAX];
+
+	// coarse check - check againts BR
+	mask &= intersectsBoundingRegion(br, tEnter);
+
+	for (unsigned int i = 0; mask; mask >>= 1, i++) {
+		if (!(mask & 1)) {
+			continue;
+		}
+
+		if (br.collisionMesh) {
+			// fine grain check with collision mesh
+			Ray r = getRay(i);
+			float t_tmp = std::numeric_limits<float>::max();
+			if (r.intersectsMesh(br.collisionMesh, br.instance, t_tmp) && t_tmp < t[i]) {
+				// found closer collision
+				t[i] = t_tmp;
+				hits[i] = &br;
+			}
+		}
+		else if (tEnter[i] < t[i]) {
+			// relly on coarse check
+			t[i] = tEnter[i];
+			hits[i] = &br;
+		}
+	}
+}
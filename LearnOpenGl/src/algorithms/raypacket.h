@@ -0,0 +1,87 @@
+#ifndef RAYPACKET_H
+#define RAYPACKET_H
+
+#include <glm/glm.hpp>
+
+#include "bounds.h"
+#include "ray.h"
+
+// maximum number of rays in a packet (packets of 4, 8 or 16 rays)
+#define RAY_PACKET_MAX 16
+
+/*
+	class to represent a packet of rays tested together
+	- ray data is stored as arrays of components so each test runs on 4 (SSE) or 8 (AVX) rays at once
+	- keeps the closest hit of each ray, rays only enter regions closer than their current hit
+*/
+
+class RayPacket {
+public:
+	// number of rays in packet
+	unsigned int count;
+
+	// origins
+	alignas(32) float ox[RAY_PACKET_MAX];
+	alignas(32) float oy[RAY_PACKET_MAX];
+	alignas(32) float oz[RAY_PACKET_MAX];
+
+	// directions
+	alignas(32) float dx[RAY_PACKET_MAX];
+	alignas(32) float dy[RAY_PACKET_MAX];
+	alignas(32) float dz[RAY_PACKET_MAX];
+
+	// inverse directions
+	alignas(32) float ix[RAY_PACKET_MAX];
+	alignas(32) float iy[RAY_PACKET_MAX];
+	alignas(32) float iz[RAY_PACKET_MAX];
+
+	// distance to closest hit of each ray
+	alignas(32) float t[RAY_PACKET_MAX];
+	// region of closest hit of each ray (nullptr = no hit)
+	BoundingRegion* hits[RAY_PACKET_MAX];
+
+	/*
+		constructor
+	*/
+
+	// initialize empty packet
+	RayPacket();
+
+	/*
+		packet management
+	*/
+
+	// add ray to packet, returns false if full
+	bool add(Ray& r);
+
+	// get ray at index
+	Ray getRay(unsigned int i);
+
+	// mask with a bit for each ray in the packet
+	unsigned int activeMask();
+
+	// remove all rays
+	void clear();
+
+	/*
+		intersection tests (return mask of rays entering before their closest hit)
+		- tEnter must hold RAY_PACKET_MAX floats aligned to 32 bytes
+	*/
+
+	// slab test against box, entry distances are written to tEnter
+	unsigned int intersectsBox(glm::vec3 min, glm::vec3 max, float* tEnter);
+
+	// slab test against oriented box in its own frame, entry distances are written to tEnter
+	unsigned int intersectsOrientedBox(glm::vec3 center, glm::mat3 axes, glm::vec3 halfSize, float* tEnter);
+
+	// test against sphere, entry distances are written to tEnter
+	unsigned int intersectsSphere(glm::vec3 center, float radius, float* tEnter);
+
+	// test against bounding region, entry distances are written to tEnter
+	unsigned int intersectsBoundingRegion(BoundingRegion& br, float* tEnter);
+
+	// test region for rays in mask and update their closest hits (collision mesh is checked per ray)
+	void testRegion(BoundingRegion& br, unsigned int mask);
+};
+
+#endif // !RAYPACKET_H
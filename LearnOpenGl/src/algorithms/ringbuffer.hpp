@@ -0,0 +1,108 @@
+#ifndef RINGBUFFER_HPP
+#define RINGBUFFER_HPP
+
+#include <atomic>
+
+/*
+	fixed capacity lock-free ring buffer
+	- any number of threads can push, one thread pops (drains)
+	- each slot has a sequence number telling whether it is free or holds a value for the current lap
+	- pushing to a full buffer fails instead of blocking, failed pushes are counted
+	- capacity must be a power of 2
+*/
+
+template<typename T, unsigned int capacity>
+class RingBuffer {
+	static_assert((capacity & (capacity - 1)) == 0, "capacity must be a power of 2");
+
+public:
+	/*
+		constructor
+	*/
+
+	// initialize empty buffer
+	RingBuffer()
+		: head(0), tail(0), dropped(0) {
+		for (unsigned int i = 0; i < capacity; i++) {
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	/*
+		functionality
+	*/
+
+	// add value, returns false if buffer is full (safe from any thread)
+	bool push(const T& value) {
+		unsigned int pos = head.load(std::memory_order_relaxed);
+
+		while (true) {
+			Slot& slot = slots[pos & (capacity - 1)];
+			unsigned int sequence = slot.sequence.load(std::memory_order_acquire);
+			int diff = (int)(sequence - pos);
+
+			if (diff == 0) {
+				// slot is free, claim position
+				if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					slot.value = value;
+					slot.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0) {
+				// slot still holds value of previous lap
+				dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			else {
+				// another thread claimed position
+				pos = head.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// remove oldest value, returns false if buffer is empty (consumer thread only)
+	bool pop(T& value) {
+		Slot& slot = slots[tail & (capacity - 1)];
+		unsigned int sequence = slot.sequence.load(std::memory_order_acquire);
+		if ((int)(sequence - (tail + 1)) < 0) {
+			// not written yet
+			return false;
+		}
+
+		value = slot.value;
+		// free slot for next lap
+		slot.sequence.store(tail + capacity, std::memory_order_release);
+		tail++;
+
+		return true;
+	}
+
+	// get number of failed pushes since last call and reset it
+	unsigned int takeDropped() {
+		return dropped.exchange(0, std::memory_order_relaxed);
+	}
+
+private:
+	/*
+		slot holding a value and its sequence number
+	*/
+
+	struct Slot {
+		std::atomic<unsigned int> sequence;
+		T value;
+	};
+
+	// slots of buffer
+	Slot slots[capacity];
+
+	// next position to push to (kept on its own cache line)
+	alignas(64) std::atomic<unsigned int> head;
+	// next position to pop from
+	alignas(64) unsigned int tail;
+
+	// number of failed pushes
+	std::atomic<unsigned int> dropped;
+};
+
+#endif // !RINGBUFFER_HPP
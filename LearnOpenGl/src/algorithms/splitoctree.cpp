@@ -0,0 +1,181 @@
+#include "splitoctree.h"
+#include "states.hpp"
+
+#include "boxlist.h"
+#include "../physics/physicsmodel.h"
+#include "../physics/narrowphase.h"
+
+#include <algorithm>
+
+/*
+    constructor
+*/
+
+// initialize with trees for static and moving instances
+SplitOctree::SplitOctree(Octree::node* statics, Octree::node* dynamics)
+    : statics(statics), dynamics(dynamics), staticsDirty(false) {}
+
+/*
+    broad phase methods
+*/
+
+// add instance to pending queue of its tree
+void SplitOctree::addToPending(RigidBody* instance, PhysicsModel* model) {
+    if (isStatic(model)) {
+        staticInstances.insert(instance);
+        statics->addToPending(instance, model);
+    }
+    else {
+        dynamics->addToPending(instance, model);
+    }
+}
+
+// process pending queues
+void SplitOctree::processPending() {
+    statics->processPending();
+    dynamics->processPending();
+}
+
+// update objects and check collisions (called during each iteration of main loop)
+void SplitOctree::update(BoxList& box) {
+    if (staticsDirty || !statics->treeBuilt) {
+        // remove regions of dead static instances (nothing in the tree moves, so no collisions are tested)
+        statics->update(box);
+        staticsDirty = false;
+    }
+    else {
+        // static instances generated after the tree was built
+        statics->processPending();
+    }
+
+    // update dynamic tree, moved objects are tested once it is updated
+    std::vector<unsigned int> movedList;
+    dynamics->update(box, &movedList);
+
+    // test moved objects (on the workers if there are any, trees are only read)
+    checkCollisionsList((unsigned int)movedList.size(), [&](unsigned int start, unsigned int end, std::vector<Contact>& contacts) -> void {
+        for (unsigned int i = start; i < end; i++) {
+            checkCollisionsObject(movedList[i], &contacts);
+        }
+    });
+}
+
+// check collisions with a ray
+BoundingRegion* SplitOctree::checkCollisionsRay(Ray r, float& tmin) {
+    BoundingRegion* ret = statics->checkCollisionsRay(r, tmin);
+
+    // only closer hits are returned
+    BoundingRegion* ret_tmp = dynamics->checkCollisionsRay(r, tmin);
+    if (ret_tmp) {
+        ret = ret_tmp;
+    }
+
+    return ret;
+}
+
+// check for any collision with a ray closer than tmax (returns first region found)
+BoundingRegion* SplitOctree::checkCollisionsRayAny(Ray r, float tmax) {
+    BoundingRegion* ret = statics->checkCollisionsRayAny(r, tmax);
+    return ret ? ret : dynamics->checkCollisionsRayAny(r, tmax);
+}
+
+// check collisions with a packet of rays
+void SplitOctree::checkCollisionsPacket(RayPacket& packet) {
+    statics->checkCollisionsPacket(packet);
+    dynamics->checkCollisionsPacket(packet);
+}
+
+// check collisions of a region not stored in the structure
+void SplitOctree::checkCollisionsRegion(BoundingRegion& obj, std::vector<Contact>* contacts) {
+    statics->checkCollisionsRegion(obj, contacts);
+    dynamics->checkCollisionsRegion(obj, contacts);
+}
+
+// instance was marked for deletion (static tree is updated on the next frame)
+void SplitOctree::markDead(RigidBody* instance) {
+    if (staticInstances.erase(instance)) {
+        staticsDirty = true;
+    }
+}
+
+// add shape of both trees to statistics
+void SplitOctree::gatherStats(CollisionStats& stats) {
+    statics->gatherStats(stats);
+    dynamics->gatherStats(stats);
+}
+
+// destroy object (free memory)
+void SplitOctree::destroy() {
+    if (statics) {
+        statics->destroy();
+        delete statics;
+        statics = nullptr;
+    }
+
+    if (dynamics) {
+        dynamics->destroy();
+        delete dynamics;
+        dynamics = nullptr;
+    }
+
+    staticInstances.clear();
+}
+
+/*
+    split methods
+*/
+
+// if model instances are stored in the static tree
+bool SplitOctree::isStatic(PhysicsModel* model) {
+    return !States::isActive(&model->switches, DYNAMIC);
+}
+
+// check collisions of moved object in the dynamic tree with both trees
+void SplitOctree::checkCollisionsObject(unsigned int obj, std::vector<Contact>* contacts) {
+    // dynamic vs dynamic
+    dynamics->checkCollisionsObject(obj, contacts);
+
+    // dynamic vs static
+    statics->checkCollisionsRegion((*dynamics->pool)[obj], contacts);
+}
+
+/*
+    range queries (both trees)
+*/
+
+// find regions intersecting box
+void SplitOctree::queryBox(glm::vec3 min, glm::vec3 max, Octree::QueryCallback callback) {
+    statics->queryBox(min, max, callback);
+    dynamics->queryBox(min, max, callback);
+}
+
+// find regions intersecting sphere
+void SplitOctree::querySphere(glm::vec3 center, float radius, Octree::QueryCallback callback) {
+    statics->querySphere(center, radius, callback);
+    dynamics->querySphere(center, radius, callback);
+}
+
+// find regions intersecting frustum
+void SplitOctree::queryFrustum(Frustum& frustum, Octree::QueryCallback callback) {
+    statics->queryFrustum(frustum, callback);
+    dynamics->queryFrustum(frustum, callback);
+}
+
+// find k regions closest to point (nearest first)
+void SplitOctree::queryNearest(glm::vec3 point, unsigned int k, Octree::NearestCallback callback) {
+    // k closest of each tree, merged by distance
+    std::vector<std::pair<float, BoundingRegion*>> found;
+    auto gather = [&found](BoundingRegion& br, float dist) -> void {
+        found.push_back({ dist, &br });
+    };
+    statics->queryNearest(point, k, gather);
+    dynamics->queryNearest(point, k, gather);
+
+    std::stable_sort(found.begin(), found.end(), [](const std::pair<float, BoundingRegion*>& a, const std::pair<float, BoundingRegion*>& b) -> bool {
+        return a.first < b.first;
+    });
+
+    for (unsigned int i = 0; i < k && i < (unsigned int)found.size(); i++) {
+        callback(*found[i].second, found[i].first);
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef SPLITOCTREE_H
+#define SPLITOCTREE_H
+
+#include <vector>
+#include <unordered_set>
+
+#include "broadphase.h"
+#include "octree.h"
+
+/*
+	class splitting the broad phase into a static and a dynamic octree
+	- instances of models that never move are built into a strict static tree once (can be cached on disk)
+	- moving instances are stored in a loose dynamic tree that is updated every frame
+	- moved objects are tested against the dynamic tree (dynamic vs dynamic) and the static tree (dynamic vs static)
+	- the static tree is only walked again when one of its instances is removed, so per frame work scales with the moving bodies
+*/
+
+class SplitOctree : public BroadPhase {
+public:
+	// tree of instances that never move (owned)
+	Octree::node* statics;
+	// tree of moving instances (owned)
+	Octree::node* dynamics;
+
+	// instances stored in the static tree
+	std::unordered_set<RigidBody*> staticInstances;
+	// if a static instance was removed since the last update
+	bool staticsDirty;
+
+	/*
+		constructor
+	*/
+
+	// initialize with trees for static and moving instances
+	SplitOctree(Octree::node* statics, Octree::node* dynamics);
+
+	/*
+		broad phase methods
+	*/
+
+	// add instance to pending queue of its tree
+	void addToPending(RigidBody* instance, PhysicsModel* model);
+
+	// process pending queues
+	void processPending();
+
+	// update objects and check collisions (called during each iteration of main loop)
+	void update(BoxList& box);
+
+	// check collisions with a ray
+	BoundingRegion* checkCollisionsRay(Ray r, float& tmin);
+
+	// check for any collision with a ray closer than tmax (returns first region found)
+	BoundingRegion* checkCollisionsRayAny(Ray r, float tmax);
+
+	// check collisions with a packet of rays
+	void checkCollisionsPacket(RayPacket& packet);
+
+	// check collisions of a region not stored in the structure
+	void checkCollisionsRegion(BoundingRegion& obj, std::vector<Contact>* contacts = nullptr);
+
+	// instance was marked for deletion (static tree is updated on the next frame)
+	void markDead(RigidBody* instance);
+
+	// add shape of both trees to statistics
+	void gatherStats(CollisionStats& stats);
+
+	// destroy object (free memory)
+	void destroy();
+
+	/*
+		split methods
+	*/
+
+	// if model instances are stored in the static tree
+	bool isStatic(PhysicsModel* model);
+
+	// check collisions of moved object in the dynamic tree with both trees
+	void checkCollisionsObject(unsigned int obj, std::vector<Contact>* contacts);
+
+	/*
+		range queries (both trees)
+	*/
+
+	// find regions intersecting box
+	void queryBox(glm::vec3 min, glm::vec3 max, Octree::QueryCallback callback);
+
+	// find regions intersecting sphere
+	void querySphere(glm::vec3 center, float radius, Octree::QueryCallback callback);
+
+	// find regions intersecting frustum
+	void queryFrustum(Frustum& frustum, Octree::QueryCallback callback);
+
+	// find k regions closest to point (nearest first)
+	void queryNearest(glm::vec3 point, unsigned int k, Octree::NearestCallback callback);
+};
+
+#endif // !SPLITOCTREE_H
@@ -0,0 +1,281 @@
+#include "sweepandprune.h"
+#include "states.hpp"
+
+#include "boxlist.h"
+#include "../physics/physicsmodel.h"
+#include "../physics/narrowphase.h"
+
+#include <algorithm>
+#include <limits>
+
+/*
+    broad phase methods
+*/
+
+// add instance to pending queue
+void SweepAndPrune::addToPending(RigidBody* instance, PhysicsModel* model) {
+    // getting all the bounding regions of the model
+    for (BoundingRegion br : model->boundingRegions) {
+        br.instance = instance;
+        br.transform();
+        queue.push(pool.allocate(br));
+    }
+}
+
+// process pending queue
+void SweepAndPrune::processPending() {
+    if (queue.size() == 0) {
+        return;
+    }
+
+    // append endpoints of new regions
+    while (queue.size() != 0) {
+        unsigned int obj = queue.front();
+        queue.pop();
+
+        objects.push_back(obj);
+        maxLength = std::max(maxLength, pool.hot[obj].max.x - pool.hot[obj].min.x);
+        for (int axis = 0; axis < 3; axis++) {
+            axes[axis].push_back({ pool.hot[obj].min[axis], obj, false });
+            axes[axis].push_back({ pool.hot[obj].max[axis], obj, true });
+        }
+    }
+
+    // sort new endpoints into place (generates pairs with new regions)
+    for (int axis = 0; axis < 3; axis++) {
+        sortAxis(axis);
+    }
+}
+
+// update objects and check collisions (called during each iteration of main loop)
+void SweepAndPrune::update(BoxList& box) {
+    removeDead();
+
+    // transform moved regions
+    maxLength = 0.0f;
+    for (unsigned int obj : objects) {
+        BoundingRegion& br = pool[obj];
+        if (States::isActive(&br.instance->state, INSTANCE_MOVED)) {
+            pool.transform(obj);
+        }
+        maxLength = std::max(maxLength, pool.hot[obj].max.x - pool.hot[obj].min.x);
+        box.positions.push_back(br.calculateCenter());
+        box.sizes.push_back(br.calculateDimensions());
+    }
+
+    // refresh endpoints and restore order
+    for (int axis = 0; axis < 3; axis++) {
+        for (Endpoint& e : axes[axis]) {
+            e.value = e.isMax ? pool.hot[e.obj].max[axis] : pool.hot[e.obj].min[axis];
+        }
+        sortAxis(axis);
+    }
+
+    // gather overlapping pairs with a moved region as (br, obj), obj being the moved region
+    std::vector<std::pair<unsigned int, unsigned int>> tests;
+    for (unsigned long long key : pairs) {
+        unsigned int obj1 = (unsigned int)(key >> 32);
+        unsigned int obj2 = (unsigned int)(key & 0xffffffff);
+        RigidBody* instance1 = pool[obj1].instance;
+        RigidBody* instance2 = pool[obj2].instance;
+
+        if (instance1 == instance2) {
+            // do not test collision with the same instance
+            continue;
+        }
+
+        if (States::isActive(&instance1->state, INSTANCE_MOVED)) {
+            tests.push_back({ obj2, obj1 });
+        }
+        if (States::isActive(&instance2->state, INSTANCE_MOVED)) {
+            tests.push_back({ obj1, obj2 });
+        }
+    }
+    // hash set order is arbitrary, sort for deterministic responses
+    std::sort(tests.begin(), tests.end());
+
+    // fine grain tests of the pairs (on the workers if there are any)
+    checkCollisionsList((unsigned int)tests.size(), [&](unsigned int start, unsigned int end, std::vector<Contact>& contacts) -> void {
+        Contact contact;
+        for (unsigned int i = start; i < end; i++) {
+            BoundingRegion& br = pool[tests[i].first];
+            BoundingRegion& obj = pool[tests[i].second];
+            if (br.intersectsWith(obj) && NarrowPhase::test(br, obj, contact)) {
+                contacts.push_back(contact);
+            }
+        }
+    });
+
+    processPending();
+}
+
+// check collisions with a ray
+BoundingRegion* SweepAndPrune::checkCollisionsRay(Ray r, float& tmin) {
+    BoundingRegion* ret = nullptr;
+
+    for (unsigned int obj : objects) {
+        BoundingRegion& br = pool[obj];
+        if (r.intersectsRegion(br, tmin)) {
+            ret = &br;
+        }
+    }
+
+    return ret;
+}
+
+// check collisions of a region not stored in the structure
+void SweepAndPrune::checkCollisionsRegion(BoundingRegion& obj, std::vector<Contact>* contacts) {
+    glm::vec3 min, max;
+    BoundsPool::calculateBox(obj, min, max);
+
+    // min endpoints on the x axis are sorted, start at the first region that can reach the box and stop after its end
+    Contact contact;
+    for (auto it = firstEndpoint(min.x); it != axes[0].end(); it++) {
+        Endpoint& e = *it;
+        if (e.value > max.x) {
+            break;
+        }
+
+        if (!e.isMax && pool.boxIntersects(e.obj, min, max)) {
+            BoundingRegion& br = pool[e.obj];
+            if (br.instance == obj.instance) {
+                // do not test collision with the same instance
+                continue;
+            }
+
+            if (br.intersectsWith(obj) && NarrowPhase::test(br, obj, contact)) {
+                if (contacts) {
+                    contacts->push_back(contact);
+                }
+                else {
+                    NarrowPhase::resolve(contact);
+                }
+            }
+        }
+    }
+}
+
+// find regions intersecting box
+void SweepAndPrune::queryBox(glm::vec3 min, glm::vec3 max, QueryCallback callback) {
+    BoundingRegion box(min, max);
+
+    // min endpoints on the x axis are sorted, start at the first region that can reach the box and stop after its end
+    for (auto it = firstEndpoint(min.x); it != axes[0].end(); it++) {
+        Endpoint& e = *it;
+        if (e.value > max.x) {
+            break;
+        }
+
+        if (!e.isMax && pool.boxIntersects(e.obj, min, max) && box.intersectsWith(pool[e.obj])) {
+            callback(pool[e.obj]);
+        }
+    }
+}
+
+// add objects to statistics (one list, so one node)
+void SweepAndPrune::gatherStats(CollisionStats& stats) {
+    stats.addNode(0, (unsigned int)objects.size());
+    stats.pendingLength += (unsigned int)queue.size();
+}
+
+// destroy object (free memory)
+void SweepAndPrune::destroy() {
+    objects.clear();
+    while (queue.size() != 0) {
+        queue.pop();
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        axes[axis].clear();
+    }
+    pairs.clear();
+    maxLength = 0.0f;
+    pool.clear();
+}
+
+/*
+    sweep and prune methods
+*/
+
+// remove regions of dead instances
+void SweepAndPrune::removeDead() {
+    bool found = false;
+
+    // release regions (iterate backwards so swapped objects have already been checked)
+    for (int i = (int)objects.size() - 1; i >= 0; i--) {
+        unsigned int obj = objects[i];
+        if (States::isActive(&pool[obj].instance->state, INSTANCE_DEAD)) {
+            pool.release(obj);
+            objects[i] = objects.back();
+            objects.pop_back();
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return;
+    }
+
+    // released regions have no instance
+    for (int axis = 0; axis < 3; axis++) {
+        axes[axis].erase(std::remove_if(axes[axis].begin(), axes[axis].end(), [this](Endpoint& e) -> bool {
+            return !pool[e.obj].instance;
+        }), axes[axis].end());
+    }
+
+    for (auto it = pairs.begin(); it != pairs.end();) {
+        if (!pool[(unsigned int)(*it >> 32)].instance ||
+            !pool[(unsigned int)(*it & 0xffffffff)].instance) {
+            it = pairs.erase(it);
+        }
+        else {
+            it++;
+        }
+    }
+}
+
+// sort axis, adding or removing pairs on each swap
+void SweepAndPrune::sortAxis(int axis) {
+    std::vector<Endpoint>& list = axes[axis];
+
+    for (int i = 1, len = (int)list.size(); i < len; i++) {
+        Endpoint e = list[i];
+        int j = i - 1;
+
+        // move endpoint left until in order
+        while (j >= 0 && list[j].value > e.value) {
+            Endpoint& f = list[j];
+
+            if (!e.isMax && f.isMax) {
+                // min moved before max, intervals start overlapping
+                if (pool.boxesIntersect(e.obj, f.obj)) {
+                    pairs.insert(pairKey(e.obj, f.obj));
+                }
+            }
+            else if (e.isMax && !f.isMax) {
+                // max moved before min, intervals stop overlapping
+                pairs.erase(pairKey(e.obj, f.obj));
+            }
+
+            list[j + 1] = f;
+            j--;
+        }
+
+        list[j + 1] = e;
+    }
+}
+
+// get first endpoint on the x axis of a region that may reach value (binary search)
+std::vector<Endpoint>::iterator SweepAndPrune::firstEndpoint(float value) {
+    // a region reaching value starts at most the longest interval before it
+    return std::lower_bound(axes[0].begin(), axes[0].end(), value - maxLength, [](const Endpoint& e, float v) -> bool {
+        return e.value < v;
+    });
+}
+
+// get key of pair
+unsigned long long SweepAndPrune::pairKey(unsigned int obj1, unsigned int obj2) {
+    if (obj1 > obj2) {
+        std::swap(obj1, obj2);
+    }
+    return ((unsigned long long)obj1 << 32) | obj2;
+}
@@ -0,0 +1,97 @@
+#ifndef SWEEPANDPRUNE_H
+#define SWEEPANDPRUNE_H
+
+#include <vector>
+#include <queue>
+#include <unordered_set>
+
+#include <glm/glm.hpp>
+
+#include "broadphase.h"
+#include "boundspool.h"
+
+/*
+	structure representing one end of a region's interval on an axis
+*/
+
+typedef struct Endpoint {
+	// coordinate on the axis
+	float value;
+	// region index in pool
+	unsigned int obj;
+	// if this is the max end of the interval
+	bool isMax;
+} Endpoint;
+
+/*
+	class for incremental sweep and prune
+	- endpoints are kept sorted on all three axes with insertion sort
+	- overlapping pairs are added/removed only when a min and max endpoint swap
+	- order barely changes between frames, so each update is close to linear
+*/
+
+class SweepAndPrune : public BroadPhase {
+public:
+	// pool storing the regions
+	BoundsPool pool;
+
+	// list of regions in structure (indices in pool)
+	std::vector<unsigned int> objects;
+	// queue of regions to be inserted (indices in pool)
+	std::queue<unsigned int> queue;
+
+	// sorted endpoint list for each axis
+	std::vector<Endpoint> axes[3];
+
+	// set of overlapping pairs (keyed by both indices)
+	std::unordered_set<unsigned long long> pairs;
+
+	// longest interval on the x axis (regions starting further left cannot reach a query)
+	float maxLength = 0.0f;
+
+	/*
+		broad phase methods
+	*/
+
+	// add instance to pending queue
+	void addToPending(RigidBody* instance, PhysicsModel* model);
+
+	// process pending queue
+	void processPending();
+
+	// update objects and check collisions (called during each iteration of main loop)
+	void update(BoxList& box);
+
+	// check collisions with a ray
+	BoundingRegion* checkCollisionsRay(Ray r, float& tmin);
+
+	// check collisions of a region not stored in the structure
+	void checkCollisionsRegion(BoundingRegion& obj, std::vector<Contact>* contacts = nullptr);
+
+	// find regions intersecting box
+	void queryBox(glm::vec3 min, glm::vec3 max, QueryCallback callback);
+
+	// add objects to statistics (one list, so one node)
+	void gatherStats(CollisionStats& stats);
+
+	// destroy object (free memory)
+	void destroy();
+
+	/*
+		sweep and prune methods
+	*/
+
+	// remove regions of dead instances
+	void removeDead();
+
+	// sort axis, adding or removing pairs on each swap
+	void sortAxis(int axis);
+
+	// get first endpoint on the x axis of a region that may reach value (binary search)
+	std::vector<Endpoint>::iterator firstEndpoint(float value);
+
+	// get key of pair
+	static unsigned long long pairKey(unsigned int obj1, unsigned int obj2);
+};
+
+#endif // !SWEEPANDPRUNE_H
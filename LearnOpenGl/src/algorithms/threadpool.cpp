@@ -0,0 +1,115 @@
+#include "threadpool.h"
+
+/*
+    constructor
+*/
+
+// initialize with number of threads (0 = number of hardware threads)
+ThreadPool::ThreadPool(unsigned int noThreads)
+    : jobCount(0), generation(0), remaining(0), stop(false) {
+    if (noThreads == 0) {
+        noThreads = std::thread::hardware_concurrency();
+        if (noThreads == 0) {
+            // could not be determined
+            noThreads = 1;
+        }
+    }
+
+    // calling thread runs the first chunk
+    for (unsigned int i = 1; i < noThreads; i++) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+/*
+    functionality
+*/
+
+// number of chunks work is split into
+unsigned int ThreadPool::size() {
+    return (unsigned int)threads.size() + 1;
+}
+
+// call func(start, end, chunk) for each chunk of [0, count), returns when all chunks are done
+void ThreadPool::parallelFor(unsigned int count, std::function<void(unsigned int, unsigned int, unsigned int)> func) {
+    if (count == 0) {
+        return;
+    }
+
+    if (threads.size() == 0 || count < size()) {
+        // not worth waking the workers
+        func(0, count, 0);
+        return;
+    }
+
+    {
+        // publish job
+        std::lock_guard<std::mutex> lock(mtx);
+        job = func;
+        jobCount = count;
+        remaining = (unsigned int)threads.size();
+        generation++;
+    }
+    startCond.notify_all();
+
+    // run own chunk
+    runChunk(0);
+
+    // wait for workers
+    std::unique_lock<std::mutex> lock(mtx);
+    doneCond.wait(lock, [this]() -> bool { return remaining == 0; });
+    job = nullptr;
+}
+
+// stop and join all worker threads
+void ThreadPool::cleanup() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stop = true;
+    }
+    startCond.notify_all();
+
+    for (std::thread& t : threads) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+    threads.clear();
+}
+
+// run chunk of current job
+void ThreadPool::runChunk(unsigned int chunk) {
+    unsigned int noChunks = size();
+    unsigned int start = (unsigned int)((unsigned long long)jobCount * chunk / noChunks);
+    unsigned int end = (unsigned int)((unsigned long long)jobCount * (chunk + 1) / noChunks);
+
+    if (start < end) {
+        job(start, end, chunk);
+    }
+}
+
+// loop run by each worker
+void ThreadPool::workerLoop(unsigned int chunk) {
+    unsigned int lastGeneration = 0;
+
+    while (true) {
+        {
+            // wait for new job or stop signal
+            std::unique_lock<std::mutex> lock(mtx);
+            startCond.wait(lock, [&]() -> bool { return stop || generation != lastGeneration; });
+            if (stop) {
+                return;
+            }
+            lastGeneration = generation;
+        }
+
+        runChunk(chunk);
+
+        {
+            // signal completion
+            std::lock_guard<std::mutex> lock(mtx);
+            remaining--;
+        }
+        doneCond.notify_one();
+    }
+}
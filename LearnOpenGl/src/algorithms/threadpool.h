@@ -0,0 +1,64 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/*
+	class to represent a pool of persistent worker threads
+	- work is split into contiguous chunks, one for each thread (calling thread included)
+*/
+
+class ThreadPool {
+public:
+	/*
+		constructor
+	*/
+
+	// initialize with number of threads (0 = number of hardware threads)
+	ThreadPool(unsigned int noThreads = 0);
+
+	/*
+		functionality
+	*/
+
+	// number of chunks work is split into
+	unsigned int size();
+
+	// call func(start, end, chunk) for each chunk of [0, count), returns when all chunks are done
+	void parallelFor(unsigned int count, std::function<void(unsigned int, unsigned int, unsigned int)> func);
+
+	// stop and join all worker threads
+	void cleanup();
+
+private:
+	// worker threads (chunk 0 is run by the calling thread)
+	std::vector<std::thread> threads;
+
+	// synchronization
+	std::mutex mtx;
+	std::condition_variable startCond;
+	std::condition_variable doneCond;
+
+	// current job
+	std::function<void(unsigned int, unsigned int, unsigned int)> job;
+	unsigned int jobCount;
+	// incremented for each new job
+	unsigned int generation;
+	// number of workers still running the current job
+	unsigned int remaining;
+
+	// if workers should exit
+	bool stop;
+
+	// run chunk of current job
+	void runChunk(unsigned int chunk);
+
+	// loop run by each worker
+	void workerLoop(unsigned int chunk);
+};
+
+#endif // !THREADPOOL_H
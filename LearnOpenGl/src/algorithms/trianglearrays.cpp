@@ -0,0 +1,153 @@
+#include "trianglearrays.h"
+#include "math/linalg.h"
+#include "math/simd.h"
+
+#include <cmath>
+#include <limits>
+
+/*
+	constructor
+*/
+
+// initialize empty list
+TriangleArrays::TriangleArrays() {
+	resize(0);
+}
+
+/*
+	list management
+*/
+
+// set number of triangles, new triangles are degenerate
+void TriangleArrays::resize(unsigned int count) {
+	this->count = count;
+
+	// padding so the last step of a range never reads past the arrays
+	unsigned int size = count + TRIANGLE_BATCH_SIZE;
+	for (std::vector<float>* arr : { &px, &py, &pz, &ax, &ay, &az, &bx, &by, &bz, &nx, &ny, &nz }) {
+		arr->resize(size, 0.0f);
+	}
+}
+
+// set triangle at index
+void TriangleArrays::set(unsigned int i, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3) {
+	glm::vec3 A = P2 - P1;
+	glm::vec3 B = P3 - P1;
+	glm::vec3 N = glm::cross(A, B);
+	float len = glm::length(N);
+	if (len > 0.0f) {
+		N /= len;
+	}
+
+	px[i] = P1.x;
+	py[i] = P1.y;
+	pz[i] = P1.z;
+	ax[i] = A.x;
+	ay[i] = A.y;
+	az[i] = A.z;
+	bx[i] = B.x;
+	by[i] = B.y;
+	bz[i] = B.z;
+	nx[i] = N.x;
+	ny[i] = N.y;
+	nz[i] = N.z;
+}
+
+// point of triangle at index closest to point
+glm::vec3 TriangleArrays::closestPoint(unsigned int i, glm::vec3 point) {
+	glm::vec3 P1(px[i], py[i], pz[i]);
+	return closestPointOnTriangle(point, P1, P1 + glm::vec3(ax[i], ay[i], az[i]), P1 + glm::vec3(bx[i], by[i], bz[i]));
+}
+
+/*
+	intersection tests
+*/
+
+// triangle in [first, first + n) closest to the sphere center if it is within radius (deepest contact), with the distance to it
+bool TriangleArrays::collidesWithSphere(unsigned int first, unsigned int n, glm::vec3 center, float radius, unsigned int& index, float& distance) {
+	float best = radius * radius;
+	bool ret = false;
+
+#ifdef SIMD_WIDTH
+	alignas(32) float dist2[SIMD_WIDTH];
+
+	simd_float cx = simd_set1(center.x), cy = simd_set1(center.y), cz = simd_set1(center.z);
+	simd_float zero = simd_set1(0.0f), one = simd_set1(1.0f);
+	simd_float tiny = simd_set1(std::numeric_limits<float>::min());
+
+	for (unsigned int i = 0; i < n; i += SIMD_WIDTH) {
+		unsigned int j = first + i;
+		simd_float eAx = simd_loadu(&ax[j]), eAy = simd_loadu(&ay[j]), eAz = simd_loadu(&az[j]);
+		simd_float eBx = simd_loadu(&bx[j]), eBy = simd_loadu(&by[j]), eBz = simd_loadu(&bz[j]);
+
+		// d = center - P1
+		simd_float dX = simd_sub(cx, simd_loadu(&px[j]));
+		simd_float dY = simd_sub(cy, simd_loadu(&py[j]));
+		simd_float dZ = simd_sub(cz, simd_loadu(&pz[j]));
+
+		simd_float da = simd_add(simd_add(simd_mul(dX, eAx), simd_mul(dY, eAy)), simd_mul(dZ, eAz));
+		simd_float db = simd_add(simd_add(simd_mul(dX, eBx), simd_mul(dY, eBy)), simd_mul(dZ, eBz));
+		simd_float d00 = simd_add(simd_add(simd_mul(eAx, eAx), simd_mul(eAy, eAy)), simd_mul(eAz, eAz));
+		simd_float d01 = simd_add(simd_add(simd_mul(eAx, eBx), simd_mul(eAy, eBy)), simd_mul(eAz, eBz));
+		simd_float d11 = simd_add(simd_add(simd_mul(eBx, eBx), simd_mul(eBy, eBy)), simd_mul(eBz, eBz));
+
+		// barycentric coordinates of the projection onto the plane (degenerate triangles are never inside)
+		simd_float denom = simd_sub(simd_mul(d00, d11), simd_mul(d01, d01));
+		simd_float u = simd_div(simd_sub(simd_mul(d11, da), simd_mul(d01, db)), denom);
+		simd_float v = simd_div(simd_sub(simd_mul(d00, db), simd_mul(d01, da)), denom);
+		simd_float inside = simd_and(simd_gt(denom, zero),
+			simd_and(simd_and(simd_ge(u, zero), simd_ge(v, zero)), simd_le(simd_add(u, v), one)));
+
+		// squared distance to the plane
+		simd_float s = simd_add(simd_add(simd_mul(dX, simd_loadu(&nx[j])), simd_mul(dY, simd_loadu(&ny[j]))), simd_mul(dZ, simd_loadu(&nz[j])));
+		simd_float plane = simd_mul(s, s);
+
+		// squared distance to the first edge
+		simd_float t = simd_min(one, simd_max(zero, simd_div(da, simd_max(d00, tiny))));
+		simd_float eX = simd_sub(dX, simd_mul(t, eAx)), eY = simd_sub(dY, simd_mul(t, eAy)), eZ = simd_sub(dZ, simd_mul(t, eAz));
+		simd_float edges = simd_add(simd_add(simd_mul(eX, eX), simd_mul(eY, eY)), simd_mul(eZ, eZ));
+
+		// squared distance to the second edge
+		t = simd_min(one, simd_max(zero, simd_div(db, simd_max(d11, tiny))));
+		eX = simd_sub(dX, simd_mul(t, eBx)); eY = simd_sub(dY, simd_mul(t, eBy)); eZ = simd_sub(dZ, simd_mul(t, eBz));
+		edges = simd_min(edges, simd_add(simd_add(simd_mul(eX, eX), simd_mul(eY, eY)), simd_mul(eZ, eZ)));
+
+		// squared distance to the third edge (from second corner to third corner)
+		simd_float fX = simd_sub(eBx, eAx), fY = simd_sub(eBy, eAy), fZ = simd_sub(eBz, eAz);
+		simd_float gX = simd_sub(dX, eAx), gY = simd_sub(dY, eAy), gZ = simd_sub(dZ, eAz);
+		simd_float ff = simd_add(simd_add(simd_mul(fX, fX), simd_mul(fY, fY)), simd_mul(fZ, fZ));
+		simd_float gf = simd_add(simd_add(simd_mul(gX, fX), simd_mul(gY, fY)), simd_mul(gZ, fZ));
+		t = simd_min(one, simd_max(zero, simd_div(gf, simd_max(ff, tiny))));
+		eX = simd_sub(gX, simd_mul(t, fX)); eY = simd_sub(gY, simd_mul(t, fY)); eZ = simd_sub(gZ, simd_mul(t, fZ));
+		edges = simd_min(edges, simd_add(simd_add(simd_mul(eX, eX), simd_mul(eY, eY)), simd_mul(eZ, eZ)));
+
+		// plane distance if the projection is inside, else closest edge
+		simd_store(dist2, simd_or(simd_and(inside, plane), simd_andnot(inside, edges)));
+
+		// deepest lane of the step within range
+		unsigned int lanes = n - i < SIMD_WIDTH ? n - i : SIMD_WIDTH;
+		for (unsigned int k = 0; k < lanes; k++) {
+			if (dist2[k] <= best) {
+				best = dist2[k];
+				index = j + k;
+				ret = true;
+			}
+		}
+	}
+#else
+	for (unsigned int i = first; i < first + n; i++) {
+		glm::vec3 d = center - closestPoint(i, center);
+		float dist2 = glm::dot(d, d);
+		if (dist2 <= best) {
+			best = dist2;
+			index = i;
+			ret = true;
+		}
+	}
+#endif
+
+	if (ret) {
+		distance = std::sqrt(best);
+	}
+	return ret;
+}
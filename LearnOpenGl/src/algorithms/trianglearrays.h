@@ -0,0 +1,61 @@
+#ifndef TRIANGLEARRAYS_H
+#define TRIANGLEARRAYS_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "trianglebatch.h"
+
+/*
+	class to represent a list of triangles stored as arrays of components
+	- each triangle is its first corner, two edges and unit normal, so any range of triangles is tested on 4 (SSE) or 8 (AVX) faces at once
+	- arrays are padded with degenerate triangles so a range can be read in whole steps
+*/
+
+class TriangleArrays {
+public:
+	// number of triangles
+	unsigned int count;
+
+	// first corners
+	std::vector<float> px, py, pz;
+
+	// edges from first corner to second corner
+	std::vector<float> ax, ay, az;
+
+	// edges from first corner to third corner
+	std::vector<float> bx, by, bz;
+
+	// unit normals (0 for degenerate triangles)
+	std::vector<float> nx, ny, nz;
+
+	/*
+		constructor
+	*/
+
+	// initialize empty list
+	TriangleArrays();
+
+	/*
+		list management
+	*/
+
+	// set number of triangles, new triangles are degenerate
+	void resize(unsigned int count);
+
+	// set triangle at index
+	void set(unsigned int i, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3);
+
+	// point of triangle at index closest to point
+	glm::vec3 closestPoint(unsigned int i, glm::vec3 point);
+
+	/*
+		intersection tests
+	*/
+
+	// triangle in [first, first + n) closest to the sphere center if it is within radius (deepest contact), with the distance to it
+	bool collidesWithSphere(unsigned int first, unsigned int n, glm::vec3 center, float radius, unsigned int& index, float& distance);
+};
+
+#endif // !TRIANGLEARRAYS_H
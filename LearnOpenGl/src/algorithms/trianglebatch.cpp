@@ -0,0 +1,131 @@
+#include "trianglebatch.h"
+#include "math/linalg.h"
+#include "math/simd.h"
+
+/*
+	constructor
+*/
+
+// initialize empty batch
+TriangleBatch::TriangleBatch() {
+	clear();
+}
+
+/*
+	batch management
+*/
+
+// add triangle to batch, returns false if full
+bool TriangleBatch::add(glm::vec3 P1, glm::vec3 P2, glm::vec3 P3) {
+	if (count == TRIANGLE_BATCH_SIZE) {
+		return false;
+	}
+
+	glm::vec3 A = P2 - P1;
+	glm::vec3 B = P3 - P1;
+
+	px[count] = P1.x;
+	py[count] = P1.y;
+	pz[count] = P1.z;
+	ax[count] = A.x;
+	ay[count] = A.y;
+	az[count] = A.z;
+	bx[count] = B.x;
+	by[count] = B.y;
+	bz[count] = B.z;
+	count++;
+
+	return true;
+}
+
+// if batch is full
+bool TriangleBatch::full() {
+	return count == TRIANGLE_BATCH_SIZE;
+}
+
+// remove all triangles
+void TriangleBatch::clear() {
+	count = 0;
+
+	// unused lanes are degenerate and never hit anything
+	for (int i = 0; i < TRIANGLE_BATCH_SIZE; i++) {
+		px[i] = py[i] = pz[i] = 0.0f;
+		ax[i] = ay[i] = az[i] = 0.0f;
+		bx[i] = by[i] = bz[i] = 0.0f;
+	}
+}
+
+/*
+	intersection tests
+*/
+
+// closest parameter t of the ray { origin + dir * t } where it hits a triangle of the batch (Moller-Trumbore), only t >= 0
+bool TriangleBatch::intersectsRay(glm::vec3 origin, glm::vec3 dir, float& t) {
+	alignas(32) float tHit[TRIANGLE_BATCH_SIZE];
+	unsigned int mask = 0;
+
+#ifdef SIMD_WIDTH
+	simd_float ox = simd_set1(origin.x), oy = simd_set1(origin.y), oz = simd_set1(origin.z);
+	simd_float dx = simd_set1(dir.x), dy = simd_set1(dir.y), dz = simd_set1(dir.z);
+	simd_float zero = simd_set1(0.0f), one = simd_set1(1.0f);
+
+	for (unsigned int i = 0; i < count; i += SIMD_WIDTH) {
+		simd_float eAx = simd_load(ax + i), eAy = simd_load(ay + i), eAz = simd_load(az + i);
+		simd_float eBx = simd_load(bx + i), eBy = simd_load(by + i), eBz = simd_load(bz + i);
+
+		// p = dir x B
+		simd_float pX = simd_sub(simd_mul(dy, eBz), simd_mul(dz, eBy));
+		simd_float pY = simd_sub(simd_mul(dz, eBx), simd_mul(dx, eBz));
+		simd_float pZ = simd_sub(simd_mul(dx, eBy), simd_mul(dy, eBx));
+
+		// determinant (0 if ray is parallel to the plane or lane is unused)
+		simd_float det = simd_add(simd_add(simd_mul(eAx, pX), simd_mul(eAy, pY)), simd_mul(eAz, pZ));
+		simd_float hit = simd_or(simd_lt(det, zero), simd_gt(det, zero));
+		simd_float invDet = simd_div(one, det);
+
+		// s = origin - P1
+		simd_float sX = simd_sub(ox, simd_load(px + i));
+		simd_float sY = simd_sub(oy, simd_load(py + i));
+		simd_float sZ = simd_sub(oz, simd_load(pz + i));
+
+		// first barycentric coordinate
+		simd_float u = simd_mul(simd_add(simd_add(simd_mul(sX, pX), simd_mul(sY, pY)), simd_mul(sZ, pZ)), invDet);
+		hit = simd_and(hit, simd_and(simd_ge(u, zero), simd_le(u, one)));
+
+		// q = s x A
+		simd_float qX = simd_sub(simd_mul(sY, eAz), simd_mul(sZ, eAy));
+		simd_float qY = simd_sub(simd_mul(sZ, eAx), simd_mul(sX, eAz));
+		simd_float qZ = simd_sub(simd_mul(sX, eAy), simd_mul(sY, eAx));
+
+		// second barycentric coordinate
+		simd_float v = simd_mul(simd_add(simd_add(simd_mul(dx, qX), simd_mul(dy, qY)), simd_mul(dz, qZ)), invDet);
+		hit = simd_and(hit, simd_and(simd_ge(v, zero), simd_le(simd_add(u, v), one)));
+
+		// distance along ray, in front of the origin
+		simd_float tt = simd_mul(simd_add(simd_add(simd_mul(eBx, qX), simd_mul(eBy, qY)), simd_mul(eBz, qZ)), invDet);
+		hit = simd_and(hit, simd_ge(tt, zero));
+
+		simd_store(tHit + i, tt);
+		mask |= simd_mask(hit) << i;
+	}
+#else
+	for (unsigned int i = 0; i < count; i++) {
+		glm::vec3 P1(px[i], py[i], pz[i]);
+		if (rayTriangleIntersection(origin, dir, P1, P1 + glm::vec3(ax[i], ay[i], az[i]), P1 + glm::vec3(bx[i], by[i], bz[i]), tHit[i])) {
+			mask |= 1u << i;
+		}
+	}
+#endif
+
+	// closest hit of the batch
+	mask &= (1u << count) - 1;
+	bool ret = false;
+	for (unsigned int i = 0; mask; mask >>= 1, i++) {
+		if ((mask & 1) && (!ret || tHit[i] < t)) {
+			t = tHit[i];
+			ret = true;
+		}
+	}
+
+	return ret;
+}
@@ -0,0 +1,63 @@
+#ifndef TRIANGLEBATCH_H
+#define TRIANGLEBATCH_H
+
+#include <glm/glm.hpp>
+
+// number of triangles in a batch (tested in 1 AVX or 2 SSE steps)
+#define TRIANGLE_BATCH_SIZE 8
+
+/*
+	class to represent a batch of triangles tested together
+	- triangles are stored as their first corner and two edges, as arrays of components so each test runs on 4 (SSE) or 8 (AVX) faces at once
+	- faces are hit from both sides, points on an edge count as inside (same as rayTriangleIntersection)
+*/
+
+class TriangleBatch {
+public:
+	// number of triangles in batch
+	unsigned int count;
+
+	// first corners
+	alignas(32) float px[TRIANGLE_BATCH_SIZE];
+	alignas(32) float py[TRIANGLE_BATCH_SIZE];
+	alignas(32) float pz[TRIANGLE_BATCH_SIZE];
+
+	// edges from first corner to second corner
+	alignas(32) float ax[TRIANGLE_BATCH_SIZE];
+	alignas(32) float ay[TRIANGLE_BATCH_SIZE];
+	alignas(32) float az[TRIANGLE_BATCH_SIZE];
+
+	// edges from first corner to third corner
+	alignas(32) float bx[TRIANGLE_BATCH_SIZE];
+	alignas(32) float by[TRIANGLE_BATCH_SIZE];
+	alignas(32) float bz[TRIANGLE_BATCH_SIZE];
+
+	/*
+		constructor
+	*/
+
+	// initialize empty batch
+	TriangleBatch();
+
+	/*
+		batch management
+	*/
+
+	// add triangle to batch, returns false if full
+	bool add(glm::vec3 P1, glm::vec3 P2, glm::vec3 P3);
+
+	// if batch is full
+	bool full();
+
+	// remove all triangles
+	void clear();
+
+	/*
+		intersection tests
+	*/
+
+	// closest parameter t of the ray { origin + dir * t } where it hits a triangle of the batch (Moller-Trumbore), only t >= 0
+	bool intersectsRay(glm::vec3 origin, glm::vec3 dir, float& t);
+};
+
+#endif // !TRIANGLEBATCH_H
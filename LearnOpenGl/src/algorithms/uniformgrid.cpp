@@ -0,0 +1,429 @@
+#include "uniformgrid.h"
+#include "states.hpp"
+
+#include "boxlist.h"
+#include "../physics/physicsmodel.h"
+#include "../physics/narrowphase.h"
+
+#include <algorithm>
+#include <limits>
+
+/*
+    constructor
+*/
+
+// initialize with structure for all other regions
+UniformGrid::UniformGrid(BroadPhase* statics)
+    : statics(statics), cellSize(1.0f), noBuckets(0) {}
+
+/*
+    broad phase methods
+*/
+
+// add instance to pending queue
+void UniformGrid::addToPending(RigidBody* instance, PhysicsModel* model) {
+    if (!accepts(model)) {
+        if (States::isActive(&model->switches, DYNAMIC)) {
+            // moves, but is not stored in the grid
+            otherDynamics.push_back({ instance, model });
+        }
+        statics->addToPending(instance, model);
+        return;
+    }
+
+    // getting all the bounding regions of the model
+    for (BoundingRegion br : model->boundingRegions) {
+        br.instance = instance;
+        br.transform();
+        queue.push(pool.allocate(br));
+    }
+}
+
+// process pending queue
+void UniformGrid::processPending() {
+    statics->processPending();
+
+    // spheres are sorted into cells on the next rebuild
+    while (queue.size() != 0) {
+        objects.push_back(queue.front());
+        queue.pop();
+    }
+}
+
+// update objects and check collisions (called during each iteration of main loop)
+void UniformGrid::update(BoxList& box) {
+    // dynamic objects in the statics are tested there
+    statics->workers = workers;
+    statics->update(box);
+
+    removeDead();
+    rebuild();
+
+    // get moved spheres
+    std::vector<unsigned int> movedList;
+    for (unsigned int obj : objects) {
+        BoundingRegion& br = pool[obj];
+        if (States::isActive(&br.instance->state, INSTANCE_MOVED)) {
+            movedList.push_back(obj);
+        }
+        box.positions.push_back(br.calculateCenter());
+        box.sizes.push_back(br.calculateDimensions());
+    }
+
+    // get regions of other moved dynamic instances (spheres at rest in the grid do not test them)
+    std::vector<BoundingRegion> movedRegions;
+    for (std::pair<RigidBody*, PhysicsModel*>& dynamic : otherDynamics) {
+        if (States::isActive(&dynamic.first->state, INSTANCE_MOVED)) {
+            for (BoundingRegion br : dynamic.second->boundingRegions) {
+                br.instance = dynamic.first;
+                br.transform();
+                movedRegions.push_back(br);
+            }
+        }
+    }
+
+    // test moved objects (on the workers if there are any, grid and statics are only read)
+    unsigned int noMoved = (unsigned int)movedList.size();
+    checkCollisionsList(noMoved + (unsigned int)movedRegions.size(), [&](unsigned int start, unsigned int end, std::vector<Contact>& contacts) -> void {
+        for (unsigned int i = start; i < end; i++) {
+            if (i < noMoved) {
+                checkCollisionsObject(movedList[i], &contacts);
+            }
+            else {
+                checkCollisionsCells(movedRegions[i - noMoved], &contacts);
+            }
+        }
+    });
+
+    processPending();
+}
+
+// check collisions with a ray
+BoundingRegion* UniformGrid::checkCollisionsRay(Ray r, float& tmin) {
+    BoundingRegion* ret = statics->checkCollisionsRay(r, tmin);
+
+    for (unsigned int obj : objects) {
+        BoundingRegion& br = pool[obj];
+        if (r.intersectsRegion(br, tmin)) {
+            ret = &br;
+        }
+    }
+
+    return ret;
+}
+
+// check collisions of a region not stored in the structure
+void UniformGrid::checkCollisionsRegion(BoundingRegion& obj, std::vector<Contact>* contacts) {
+    statics->checkCollisionsRegion(obj, contacts);
+
+    glm::vec3 min, max;
+    BoundsPool::calculateBox(obj, min, max);
+
+    Contact contact;
+    for (unsigned int other : objects) {
+        BoundingRegion& br = pool[other];
+        if (br.instance == obj.instance) {
+            // do not test collision with the same instance
+            continue;
+        }
+
+        if (pool.boxIntersects(other, min, max) && br.intersectsWith(obj) &&
+            NarrowPhase::test(br, obj, contact)) {
+            if (contacts) {
+                contacts->push_back(contact);
+            }
+            else {
+                NarrowPhase::resolve(contact);
+            }
+        }
+    }
+}
+
+// find regions intersecting box
+void UniformGrid::queryBox(glm::vec3 min, glm::vec3 max, QueryCallback callback) {
+    statics->queryBox(min, max, callback);
+
+    BoundingRegion box(min, max);
+    for (unsigned int other : objects) {
+        if (pool.boxIntersects(other, min, max) && box.intersectsWith(pool[other])) {
+            callback(pool[other]);
+        }
+    }
+}
+
+// add shape of statics and grid to statistics (each occupied bucket counts as a node)
+void UniformGrid::gatherStats(CollisionStats& stats) {
+    statics->gatherStats(stats);
+
+    for (unsigned int i = 0; i + 1 < (unsigned int)bucketStart.size(); i++) {
+        unsigned int noBucketObjects = bucketStart[i + 1] - bucketStart[i];
+        if (noBucketObjects) {
+            stats.addNode(0, noBucketObjects);
+        }
+    }
+    stats.pendingLength += (unsigned int)queue.size();
+}
+
+// destroy object (free memory)
+void UniformGrid::destroy() {
+    if (statics) {
+        statics->destroy();
+        delete statics;
+        statics = nullptr;
+    }
+
+    objects.clear();
+    while (queue.size() != 0) {
+        queue.pop();
+    }
+    otherDynamics.clear();
+    objectBuckets.clear();
+    bucketStart.clear();
+    cellX.clear();
+    cellY.clear();
+    cellZ.clear();
+    cellRadius.clear();
+    cellObjects.clear();
+    pool.clear();
+}
+
+/*
+    grid methods
+*/
+
+// if model instances are stored in the grid (dynamic and only spheres)
+bool UniformGrid::accepts(PhysicsModel* model) {
+    if (!States::isActive(&model->switches, DYNAMIC) || model->boundingRegions.size() == 0) {
+        return false;
+    }
+
+    for (BoundingRegion& br : model->boundingRegions) {
+        if (br.type != BoundTypes::SPHERE) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// remove spheres of dead instances
+void UniformGrid::removeDead() {
+    // iterate backwards so swapped objects have already been checked
+    for (int i = (int)objects.size() - 1; i >= 0; i--) {
+        unsigned int obj = objects[i];
+        if (States::isActive(&pool[obj].instance->state, INSTANCE_DEAD)) {
+            pool.release(obj);
+            objects[i] = objects.back();
+            objects.pop_back();
+        }
+    }
+
+    // other dynamic instances (removed from the statics by their own update)
+    otherDynamics.erase(std::remove_if(otherDynamics.begin(), otherDynamics.end(),
+        [](std::pair<RigidBody*, PhysicsModel*>& dynamic) -> bool {
+            return States::isActive(&dynamic.first->state, INSTANCE_DEAD);
+        }), otherDynamics.end());
+}
+
+// transform moved spheres and sort all spheres into buckets
+void UniformGrid::rebuild() {
+    unsigned int noObjects = (unsigned int)objects.size();
+    objectBuckets.resize(noObjects);
+
+    // run over chunks of the object list, on the workers if there are any
+    auto forEachChunk = [&](std::function<void(unsigned int, unsigned int, unsigned int)> func) -> void {
+        if (workers) {
+            workers->parallelFor(noObjects, func);
+        }
+        else if (noObjects != 0) {
+            func(0, noObjects, 0);
+        }
+    };
+
+    // transform moved spheres and find the largest radius
+    std::vector<float> chunkRadius(workers ? workers->size() : 1, 0.0f);
+    forEachChunk([&](unsigned int start, unsigned int end, unsigned int chunk) -> void {
+        for (unsigned int i = start; i < end; i++) {
+            unsigned int obj = objects[i];
+            if (States::isActive(&pool[obj].instance->state, INSTANCE_MOVED)) {
+                pool.transform(obj);
+            }
+            chunkRadius[chunk] = std::max(chunkRadius[chunk], pool[obj].radius);
+        }
+    });
+
+    float maxRadius = *std::max_element(chunkRadius.begin(), chunkRadius.end());
+    cellSize = maxRadius > 0.0f ? 2.0f * maxRadius : 1.0f;
+
+    // keep buckets sparse so few cells share one
+    noBuckets = 64;
+    while (noBuckets < 2 * noObjects) {
+        noBuckets <<= 1;
+    }
+
+    // hash cells and count spheres of each chunk in each bucket
+    std::vector<std::vector<unsigned int>> chunkCounts(chunkRadius.size(), std::vector<unsigned int>(noBuckets, 0));
+    forEachChunk([&](unsigned int start, unsigned int end, unsigned int chunk) -> void {
+        for (unsigned int i = start; i < end; i++) {
+            objectBuckets[i] = hashCell(getCell(pool[objects[i]].center));
+            chunkCounts[chunk][objectBuckets[i]]++;
+        }
+    });
+
+    // first entry of each bucket, counts become the first entry of each chunk in the bucket (chunks are in object order)
+    bucketStart.resize(noBuckets + 1);
+    unsigned int offset = 0;
+    for (unsigned int i = 0; i < noBuckets; i++) {
+        bucketStart[i] = offset;
+        for (std::vector<unsigned int>& counts : chunkCounts) {
+            unsigned int count = counts[i];
+            counts[i] = offset;
+            offset += count;
+        }
+    }
+    bucketStart[noBuckets] = offset;
+
+    // scatter spheres into the cell arrays
+    cellX.resize(noObjects);
+    cellY.resize(noObjects);
+    cellZ.resize(noObjects);
+    cellRadius.resize(noObjects);
+    cellObjects.resize(noObjects);
+
+    forEachChunk([&](unsigned int start, unsigned int end, unsigned int chunk) -> void {
+        std::vector<unsigned int>& next = chunkCounts[chunk];
+        for (unsigned int i = start; i < end; i++) {
+            unsigned int k = next[objectBuckets[i]]++;
+            BoundingRegion& br = pool[objects[i]];
+            cellX[k] = br.center.x;
+            cellY[k] = br.center.y;
+            cellZ[k] = br.center.z;
+            cellRadius[k] = br.radius;
+            cellObjects[k] = objects[i];
+        }
+    });
+}
+
+// check collisions of sphere with spheres in neighboring cells and with the statics
+void UniformGrid::checkCollisionsObject(unsigned int obj, std::vector<Contact>* contacts) {
+    BoundingRegion& sphere = pool[obj];
+    glm::ivec3 cell = getCell(sphere.center);
+
+    // get buckets of the 27 neighboring cells (cells may share a bucket)
+    unsigned int buckets[27];
+    unsigned int noNeighbors = 0;
+    for (int x = -1; x <= 1; x++) {
+        for (int y = -1; y <= 1; y++) {
+            for (int z = -1; z <= 1; z++) {
+                buckets[noNeighbors++] = hashCell(cell + glm::ivec3(x, y, z));
+            }
+        }
+    }
+    std::sort(buckets, buckets + noNeighbors);
+    noNeighbors = (unsigned int)(std::unique(buckets, buckets + noNeighbors) - buckets);
+
+    Contact contact;
+    for (unsigned int i = 0; i < noNeighbors; i++) {
+        for (unsigned int k = bucketStart[buckets[i]], end = bucketStart[buckets[i] + 1]; k < end; k++) {
+            // coarse check with the cell arrays
+            float dx = cellX[k] - sphere.center.x;
+            float dy = cellY[k] - sphere.center.y;
+            float dz = cellZ[k] - sphere.center.z;
+            float sumRadius = cellRadius[k] + sphere.radius;
+            if (dx * dx + dy * dy + dz * dz > sumRadius * sumRadius) {
+                continue;
+            }
+
+            BoundingRegion& br = pool[cellObjects[k]];
+            if (br.instance == sphere.instance) {
+                // do not test collision with the same instance
+                continue;
+            }
+
+            // course check passed, fine grain check
+            if (NarrowPhase::test(br, sphere, contact)) {
+                if (contacts) {
+                    contacts->push_back(contact);
+                }
+                else {
+                    NarrowPhase::resolve(contact);
+                }
+            }
+        }
+    }
+
+    // dynamic vs static
+    statics->checkCollisionsRegion(sphere, contacts);
+}
+
+// check collisions of a region with the spheres in the cells its box overlaps
+void UniformGrid::checkCollisionsCells(BoundingRegion& obj, std::vector<Contact>* contacts) {
+    glm::vec3 min, max;
+    BoundsPool::calculateBox(obj, min, max);
+
+    // centers of overlapping spheres are at most half a cell outside of the box
+    glm::ivec3 minCell = getCell(min - 0.5f * cellSize);
+    glm::ivec3 maxCell = getCell(max + 0.5f * cellSize);
+    glm::ivec3 noCells = maxCell - minCell + 1;
+
+    // get buckets of the cells (cells may share a bucket)
+    std::vector<unsigned int> buckets;
+    if ((unsigned long long)noCells.x * noCells.y * noCells.z < noBuckets) {
+        for (int x = minCell.x; x <= maxCell.x; x++) {
+            for (int y = minCell.y; y <= maxCell.y; y++) {
+                for (int z = minCell.z; z <= maxCell.z; z++) {
+                    buckets.push_back(hashCell(glm::ivec3(x, y, z)));
+                }
+            }
+        }
+        std::sort(buckets.begin(), buckets.end());
+        buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+    }
+    else {
+        // box covers more cells than there are buckets
+        for (unsigned int i = 0; i < noBuckets; i++) {
+            buckets.push_back(i);
+        }
+    }
+
+    Contact contact;
+    for (unsigned int bucket : buckets) {
+        for (unsigned int k = bucketStart[bucket], end = bucketStart[bucket + 1]; k < end; k++) {
+            // coarse check of the sphere with the box
+            glm::vec3 center(cellX[k], cellY[k], cellZ[k]);
+            glm::vec3 d = center - glm::clamp(center, min, max);
+            if (glm::dot(d, d) > cellRadius[k] * cellRadius[k]) {
+                continue;
+            }
+
+            BoundingRegion& br = pool[cellObjects[k]];
+            if (br.instance == obj.instance) {
+                // do not test collision with the same instance
+                continue;
+            }
+
+            if (br.intersectsWith(obj) && NarrowPhase::test(br, obj, contact)) {
+                if (contacts) {
+                    contacts->push_back(contact);
+                }
+                else {
+                    NarrowPhase::resolve(contact);
+                }
+            }
+        }
+    }
+}
+
+// get cell coordinates of point
+glm::ivec3 UniformGrid::getCell(glm::vec3 pos) {
+    return glm::ivec3(glm::floor(pos / cellSize));
+}
+
+// get bucket of cell
+unsigned int UniformGrid::hashCell(glm::ivec3 cell) {
+    // large primes to spread neighboring cells over the buckets
+    unsigned int hash = ((unsigned int)cell.x * 73856093u) ^
+        ((unsigned int)cell.y * 19349663u) ^
+        ((unsigned int)cell.z * 83492791u);
+    return hash & (noBuckets - 1);
+}
@@ -0,0 +1,116 @@
+#ifndef UNIFORMGRID_H
+#define UNIFORMGRID_H
+
+#include <vector>
+#include <queue>
+#include <utility>
+
+#include <glm/glm.hpp>
+
+#include "broadphase.h"
+#include "boundspool.h"
+
+/*
+	class for a hashed uniform grid holding small dynamic spheres (projectiles)
+	- everything else is stored in a second structure (statics, usually the octree)
+	- cell size is twice the largest sphere radius, so overlapping spheres are in neighboring cells
+	- cells are hashed into buckets, the grid is rebuilt every frame with a counting sort
+	- dynamic vs dynamic tests are done in the grid, dynamic vs static tests in the statics
+	- other dynamic instances live in the statics and are tested against the grid when they move
+*/
+
+class UniformGrid : public BroadPhase {
+public:
+	// structure storing all other regions (owned by grid)
+	BroadPhase* statics;
+
+	// pool storing the spheres
+	BoundsPool pool;
+
+	// list of spheres in grid (indices in pool)
+	std::vector<unsigned int> objects;
+	// queue of spheres to be inserted (indices in pool)
+	std::queue<unsigned int> queue;
+
+	// dynamic instances stored in the statics with their models (tested against the grid when they move)
+	std::vector<std::pair<RigidBody*, PhysicsModel*>> otherDynamics;
+
+	// edge length of a cell
+	float cellSize;
+	// number of hash buckets (power of 2)
+	unsigned int noBuckets;
+
+	// bucket of each sphere (same order as objects)
+	std::vector<unsigned int> objectBuckets;
+	// first entry of each bucket in the cell arrays (noBuckets + 1 entries)
+	std::vector<unsigned int> bucketStart;
+
+	// cell arrays, spheres grouped by bucket
+	std::vector<float> cellX;
+	std::vector<float> cellY;
+	std::vector<float> cellZ;
+	std::vector<float> cellRadius;
+	std::vector<unsigned int> cellObjects;
+
+	/*
+		constructor
+	*/
+
+	// initialize with structure for all other regions
+	UniformGrid(BroadPhase* statics);
+
+	/*
+		broad phase methods
+	*/
+
+	// add instance to pending queue
+	void addToPending(RigidBody* instance, PhysicsModel* model);
+
+	// process pending queue
+	void processPending();
+
+	// update objects and check collisions (called during each iteration of main loop)
+	void update(BoxList& box);
+
+	// check collisions with a ray
+	BoundingRegion* checkCollisionsRay(Ray r, float& tmin);
+
+	// check collisions of a region not stored in the structure
+	void checkCollisionsRegion(BoundingRegion& obj, std::vector<Contact>* contacts = nullptr);
+
+	// find regions intersecting box
+	void queryBox(glm::vec3 min, glm::vec3 max, QueryCallback callback);
+
+	// add shape of statics and grid to statistics (each occupied bucket counts as a node)
+	void gatherStats(CollisionStats& stats);
+
+	// destroy object (free memory)
+	void destroy();
+
+	/*
+		grid methods
+	*/
+
+	// if model instances are stored in the grid (dynamic and only spheres)
+	bool accepts(PhysicsModel* model);
+
+	// remove spheres of dead instances
+	void removeDead();
+
+	// transform moved spheres and sort all spheres into buckets
+	void rebuild();
+
+	// check collisions of sphere with spheres in neighboring cells and with the statics
+	void checkCollisionsObject(unsigned int obj, std::vector<Contact>* contacts);
+
+	// check collisions of a region with the spheres in the cells its box overlaps
+	void checkCollisionsCells(BoundingRegion& obj, std::vector<Contact>* contacts);
+
+	// get cell coordinates of point
+	glm::ivec3 getCell(glm::vec3 pos);
+
+	// get bucket of cell
+	unsigned int hashCell(glm::ivec3 cell);
+};
+
+#endif // !UNIFORMGRID_H
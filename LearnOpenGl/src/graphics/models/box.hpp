@@ -10,15 +10,13 @@
 #include "../memory/vertexmemory.hpp"
 
 #include "../../algorithms/bounds.h"
+#include "../../algorithms/boxlist.h"
 #include "../rendering/shader.h"
 
 #define UPPER_BOUND 100
 
-class Box {
+class Box : public BoxList {
 public:
-    std::vector<glm::vec3> positions;
-    std::vector<glm::vec3> sizes;
-
 	void init() {
         vertices = {
             // position             x   y   z   i
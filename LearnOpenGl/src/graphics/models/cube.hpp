@@ -92,8 +92,7 @@ public:
             7, 3, 2
         };
 
-        //BoundingRegion br(glm::vec3(-0.5f), glm::vec3(0.5f));
-        BoundingRegion br(glm::vec3(0.0f), sqrt(3.0f) / 2.0f);
+        BoundingRegion br(glm::vec3(-0.5f), glm::vec3(0.5f), BoundTypes::OBB);
 
         Mesh ret = processMesh(br,
             noVertices, vertices,
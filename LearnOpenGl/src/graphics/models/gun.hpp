@@ -26,7 +26,7 @@ public:
 	void render(Shader shader, float dt, Scene *scene, bool shadow, bool gun) {
 		glm::mat4 model = glm::mat4(1.0f);
 
-		currentPos = instances[0]->pos;
+		currentPos = instances[0]->getPos();
 
 		if (Mouse::button(GLFW_MOUSE_BUTTON_2)) {
 			targetPos = scene->getActiveCamera()->cameraPos + glm::vec3(scene->getActiveCamera()->cameraFront * 0.18f) - glm::vec3(scene->getActiveCamera()->cameraUp * 0.060f);
@@ -38,13 +38,13 @@ public:
 		}
 
 		if (Keyboard::key(GLFW_KEY_W) || Keyboard::key(GLFW_KEY_S) || Keyboard::key(GLFW_KEY_A) || Keyboard::key(GLFW_KEY_D) || Keyboard::key(GLFW_KEY_SPACE) || Keyboard::key(GLFW_KEY_LEFT_SHIFT)) {
-			instances[0]->pos = targetPos;
+			instances[0]->setPos(targetPos);
 		}
 		else {
 			// Interpolate between the current position and the target position
 			interpolationFactor += 0.05f; // Adjust this value for speed of interpolation
 			interpolationFactor = std::min(interpolationFactor, 1.0f); // Clamp to 1.0 to avoid overshooting
-			instances[0]->pos = instances[0]->pos + (targetPos - instances[0]->pos) * interpolationFactor;
+			instances[0]->setPos(currentPos + (targetPos - currentPos) * interpolationFactor);
 		}
 		
 
@@ -60,7 +60,7 @@ public:
 		theta = acos(glm::dot(glm::vec2(1.0f, 0.0f), front2d) / glm::length(front2d));
 		model = glm::rotate(model, scene->getActiveCamera()->cameraFront.z < 0 ? theta : -theta, Environment::worldUp);
 		
-		instances[0]->rotationMatrix = model;
+		instances[0]->setRotationMatrix(glm::mat3(model));
 
 		Model::render(shader, dt, scene, shadow, true);
 	}
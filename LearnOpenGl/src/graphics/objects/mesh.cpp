@@ -150,11 +150,11 @@ void Mesh::loadData(std::vector<Vertex> _vertices, std::vector<unsigned int> _in
 	ArrayObjects::clear();
 }
 
-// setup collision mesh
+// setup collision mesh (attached to the bounding region of the mesh, which keeps its type)
 void Mesh::loadCollisionMesh(unsigned int noPoints, float* coordinates, unsigned int noFaces, unsigned int* indices)
 {
 	this->collision = new CollisionMesh(noPoints, coordinates, noFaces, indices);
-	this->br = this->collision->br;
+	this->br.collisionMesh = this->collision;
 }
 
 // setup textures
@@ -90,7 +90,7 @@ public:
     // load vertex and index data
     void loadData(std::vector<Vertex> vertices, std::vector<unsigned int> indices, bool pad = false);
 
-    // setup collision mesh
+    // setup collision mesh (attached to the bounding region of the mesh, which keeps its type)
     void loadCollisionMesh(unsigned int noPoints, float* coordinates, unsigned int noFaces, unsigned int* indices);
 
     // setup textures
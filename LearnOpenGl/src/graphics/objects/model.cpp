@@ -12,9 +12,7 @@
 
 // initialize with parameters
 Model::Model(std::string id, unsigned int maxNoInstances, unsigned int flags)
-	: id(id), switches(flags),
-	currentNoInstances(0), maxNoInstances(maxNoInstances), instances(maxNoInstances),
-	collision(nullptr)
+	: PhysicsModel(id, maxNoInstances, flags), collisionImport(nullptr)
 {}
 
 /*
@@ -25,7 +23,8 @@ Model::Model(std::string id, unsigned int maxNoInstances, unsigned int flags)
 void Model::init() {}
 
 // load model from path
-void Model::loadModel(std::string path)
+// meshes get collision meshes simplified to collisionFaces faces if it is not 0 (cached next to the file, see CollisionImport)
+void Model::loadModel(std::string path, unsigned int collisionFaces)
 {
 	// use ASSIMP to read file
 	Assimp::Importer import;
@@ -41,15 +40,20 @@ void Model::loadModel(std::string path)
 	// parse directory from path
 	directory = path.substr(0, path.find_last_of("/"));
 
+	if (collisionFaces) {
+		// read simplified meshes of earlier runs
+		collisionImport = new CollisionImport(path, collisionFaces);
+	}
+
 	// process root node
 	processNode(scene->mRootNode, scene);
-}
 
-// enable a collision model
-void Model::enableCollisionModel()
-{
-	if (!this->collision) {
-		this->collision = new CollisionModel(this);
+	if (collisionImport) {
+		if (collisionImport->changed && !collisionImport->save()) {
+			std::cout << "Could not write collision meshes to " << collisionImport->path << std::endl;
+		}
+		delete collisionImport;
+		collisionImport = nullptr;
 	}
 }
 
@@ -66,37 +70,27 @@ void Model::render(Shader shader, float dt, Scene* scene, bool shadow, bool gun)
 	if (!States::isActive(&switches, CONST_INSTANCES)) {
 		// dynamic instances - update VBO data
 
-		// create list of each
-		std::vector<glm::mat4> models(currentNoInstances);
-		std::vector<glm::mat3> normalModels(currentNoInstances);
-
 		// determine if instances are moving
-		bool doUpdate = States::isActive(&switches, DYNAMIC);
-		
-		// iterate through each instance
-		for (unsigned int i = 0; i < currentNoInstances; i++) {
-			if (doUpdate && !shadow) {
-				// update rigidbody 
-				instances[i]->update(dt, gun);
-				// activate moved switch
-				States::activate(&instances[i]->state, INSTANCE_MOVED);
-			}
-			else {
-				// deactivate moved switch
+		bool doUpdate = States::isActive(&switches, DYNAMIC) && !shadow;
+		if (doUpdate) {
+			// update rigidbodies (swept against the broad phase if continuous collisions are on, the gun follows the camera)
+			bool sweep = !gun && scene->variableLog["continuousCollisions"].val<bool>();
+			updateInstances(dt, sweep ? scene->broadPhase : nullptr);
+		}
+		else {
+			// deactivate moved switches
+			for (unsigned int i = 0; i < currentNoInstances; i++) {
 				States::deactivate(&instances[i]->state, INSTANCE_MOVED);
 			}
-			// add updated matrices
-			models[i] = instances[i]->model;
-			normalModels[i] = instances[i]->normalModel;
 		}
 
 		if (currentNoInstances) {
-			// set transformation data
+			// set transformation data (matrices are packed in the store)
 			modelVBO.bind();
-			modelVBO.updateData<glm::mat4>(0, currentNoInstances, &models[0]);
+			modelVBO.updateData<glm::mat4>(0, currentNoInstances, &bodies.models[0]);
 
 			normalModelVBO.bind();
-			normalModelVBO.updateData<glm::mat3>(0, currentNoInstances, &normalModels[0]);
+			normalModelVBO.updateData<glm::mat3>(0, currentNoInstances, &bodies.normalModels[0]);
 		}
 	}
 
@@ -134,18 +128,6 @@ void Model::cleanup()
 	instance methods
 */
 
-// generate instance with parameters
-RigidBody* Model::generateInstances(glm::vec3 size, float mass, glm::vec3 pos, glm::vec3 rot)
-{
-	if (currentNoInstances >= maxNoInstances) {
-		return nullptr; // all slots full
-	}
-
-	// instantiate new instance
-	instances[currentNoInstances] = new RigidBody(id, size, mass, pos, rot);
-	return instances[currentNoInstances++];
-}
-
 // initialize memory for instances
 void Model::initInstances()
 {
@@ -154,20 +136,11 @@ void Model::initInstances()
 	glm::mat4* modelData = nullptr;
 	glm::mat3* normalModelData = nullptr;
 
-	std::vector<glm::mat4> models(currentNoInstances);
-	std::vector<glm::mat3> normalModels(currentNoInstances);
-
 	if (States::isActive(&switches, CONST_INSTANCES)) {
-		// instances won't change, set data pointers
-
-		for (unsigned int i = 0; i < currentNoInstances; i++) {
-			models[i] = instances[i]->model;
-			normalModels[i] = instances[i]->normalModel;
-		}
-
+		// instances won't change, set data pointers (matrices are packed in the store)
 		if (currentNoInstances) {
-			modelData = &models[0];
-			normalModelData = &normalModels[0];
+			modelData = &bodies.models[0];
+			normalModelData = &bodies.normalModels[0];
 		}
 
 		usage = GL_STATIC_DRAW;
@@ -207,39 +180,6 @@ void Model::initInstances()
 
 }
 
-// remove instance at idx
-void Model::removeInstance(unsigned int idx)
-{
-	if (idx < maxNoInstances) {
-		// shift down
-		for (unsigned int i = idx + 1; i < currentNoInstances; i++) {
-			instances[i - 1] = instances[i];
-		}
-		currentNoInstances--;
-	}
-}
-
-// remove instance with id
-void Model::removeInstance(std::string instanceId)
-{
-	int idx = getIdx(instanceId);
-	if (idx != -1) {
-		removeInstance(idx);
-	}
-}
-
-// get index of instance with id
-unsigned int Model::getIdx(std::string id)
-{
-	// test each instance
-	for (unsigned int i = 0; i < currentNoInstances; i++) {
-		if (instances[i]->instanceId == id) {
-			return i;
-		}
-	}
-	return -1;
-}
-
 /*
 	model loading functions (ASSIMP)
 */
@@ -250,7 +190,7 @@ void Model::processNode(aiNode* node, const aiScene* scene)
 	// process all the meshes
 	for (unsigned int i = 0; i < node->mNumMeshes; i++) {
 		aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-		Mesh newMesh = processMesh(mesh, scene);
+		Mesh newMesh = processMesh(mesh, scene, node->mMeshes[i]);
 		addMesh(&newMesh);
 	}
 	
@@ -260,17 +200,18 @@ void Model::processNode(aiNode* node, const aiScene* scene)
 	}
 }
 
-// process mesh in object file
-Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene)
+// process mesh at index idx in object file
+Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene, unsigned int idx)
 {
 	std::vector<Vertex> vertices(mesh->mNumVertices);
-	std::vector<unsigned int> indices(3 * mesh->mNumFaces);
+	std::vector<unsigned int> indices;
+	indices.reserve(3 * mesh->mNumFaces);
 	std::vector<Texture> textures;
 
 	// setup bounding region
 	BoundingRegion br(BoundTypes::SPHERE);
 	glm::vec3 min(std::numeric_limits<float>::max()); // min point = max float
-	glm::vec3 max(std::numeric_limits<float>::min()); // max point = min float
+	glm::vec3 max(std::numeric_limits<float>::lowest()); // max point = lowest float
 
 	// vertices
 	for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
@@ -337,6 +278,12 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene)
 	br.radius = sqrt(maxRadiusSquared);
 	br.ogRadius = br.radius;
 
+	// use an oriented box if it is tighter than the sphere (long or flat meshes)
+	glm::vec3 dimensions = max - min;
+	if (dimensions.x * dimensions.y * dimensions.z < 4.0f / 3.0f * 3.14159265f * br.radius * br.radius * br.radius) {
+		br = BoundingRegion(min, max, BoundTypes::OBB);
+	}
+
 	// process indices
 	for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
 		aiFace face = mesh->mFaces[i];
@@ -384,6 +331,24 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene)
 
 	// load vertex and index data
 	ret.loadData(vertices, indices);
+
+	if (collisionImport) {
+		// simplified collision mesh (attached to the bounding region of the mesh)
+		std::vector<glm::vec3> points(vertices.size());
+		for (unsigned int i = 0; i < vertices.size(); i++) {
+			points[i] = vertices[i].pos;
+		}
+		collisionImport->build(idx, points, indices);
+
+		std::vector<float>& collisionPoints = collisionImport->points[idx];
+		std::vector<unsigned int>& collisionIndices = collisionImport->indices[idx];
+		if (!collisionIndices.empty()) {
+			enableCollisionModel();
+			ret.loadCollisionMesh((unsigned int)collisionPoints.size() / 3, collisionPoints.data(),
+				(unsigned int)collisionIndices.size() / 3, collisionIndices.data());
+		}
+	}
+
 	return ret;
 }
 
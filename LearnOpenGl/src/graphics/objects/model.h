@@ -18,44 +18,24 @@
 #include "../models/box.hpp"
 
 #include "../../physics/rigidbody.h"
+#include "../../physics/collisionimport.h"
 #include "../../physics/collisionmodel.h"
+#include "../../physics/physicsmodel.h"
 
 #include "../../algorithms/bounds.h"
 
-// model switches
-#define DYNAMIC					(unsigned int)1 // 0b00000001
-#define CONST_INSTANCES			(unsigned int)2 // 0b00000010
-#define NO_TEX					(unsigned int)4	// 0b00000100
-
 // forward decleration
 class Scene; 
 
 /*
 	class to represent model
+	- instances, bounding regions and collision model are in PhysicsModel
 */
 
-class Model {
+class Model : public PhysicsModel {
 public:
-	// id of model in scene
-	std::string id;
-
 	// list of meshes
 	std::vector<Mesh> meshes;
-	// pointer to the collision model
-	CollisionModel* collision;
-	// list of bounding regions (1 for each mesh)
-	std::vector<BoundingRegion> boundingRegions;
-
-	// list of instances
-	std::vector<RigidBody*> instances;
-
-	// maximum number of instances
-	unsigned int maxNoInstances;
-	// current number of instances
-	unsigned int currentNoInstances;
-
-	// combination of switches above
-	unsigned int switches;
 
 	/*
 		constructor
@@ -72,10 +52,8 @@ public:
 	virtual void init();
 
 	// load model from path
-	void loadModel(std::string path);
-
-	// enable collision model
-	void enableCollisionModel();
+	// meshes get collision meshes simplified to collisionFaces faces if it is not 0 (cached next to the file, see CollisionImport)
+	void loadModel(std::string path, unsigned int collisionFaces = 0);
 
 	// add a mesh to list
 	void addMesh(Mesh* mesh);
@@ -90,21 +68,9 @@ public:
 		instance methods
 	*/
 
-	// generate instance with parameters
-	RigidBody* generateInstances(glm::vec3 size, float mass, glm::vec3 pos, glm::vec3 rot);
-
 	// initialize memory for instances
 	void initInstances();
 
-	// remove instance at idx
-	void removeInstance(unsigned int idx);
-
-	// remove instance with id
-	void removeInstance(std::string instanceId);
-
-	// get index of instance with id
-	unsigned int getIdx(std::string id);
-
 protected:
 	// true if doesn't have textures
 	bool noTex;
@@ -115,6 +81,9 @@ protected:
 	// list of loaded textures
 	std::vector<Texture> textures_loaded;
 
+	// collision meshes of the file being loaded (nullptr = not built)
+	CollisionImport* collisionImport;
+
 	/*
 		model loading functions (ASSIMP)
 	*/
@@ -122,8 +91,8 @@ protected:
 	// process node in object file
 	void processNode(aiNode* node, const aiScene* scene);
 
-	// process mesh in object file
-	Mesh processMesh(aiMesh* mesh, const aiScene* scene);
+	// process mesh at index idx in object file
+	Mesh processMesh(aiMesh* mesh, const aiScene* scene, unsigned int idx);
 
 	// process custom mesh
 	Mesh processMesh(BoundingRegion br,
@@ -79,6 +79,7 @@ void renderLamps(Shader shader);
 void processInput(double dt);
 void launchItem();
 void emitRay();
+void useBoxesIfNoFaces(Model& model, std::vector<BoundingRegion> boxes);
 void keyChanged(GLFWwindow* window, int key, int scancode, int action, int mods);
 void cursorChanged(GLFWwindow* window, double _x, double _y);
 void mouseButtonChanged(GLFWwindow* window, int button, int action, int mods);
@@ -137,56 +138,27 @@ int main() {
 
     scene.registerModel(&cube);
 
-    ev.loadModel("assets/models/CV/ev/utku_street.gltf");
-    ev.boundingRegions.clear();
-
-    glm::vec3 solBinaMin(-104.856216, -1.868685, -21.621166);
-    glm::vec3 solBinaMax(136.939651, 89.524246, 2.686391);
-
-    BoundingRegion solBinaAABB(solBinaMin, solBinaMax);
-    ev.boundingRegions.push_back(solBinaAABB);
-
-    glm::vec3 sagBinaMin(-104.856216, 1.826021, 140.782227);
-    glm::vec3 sagBinaMax(136.939651, 89.524246, 165.089783);
-
-    BoundingRegion sagBinaAABB(sagBinaMin, sagBinaMax);
-    ev.boundingRegions.push_back(sagBinaAABB);
-
-    glm::vec3 ortaBinaMin(271.685028, -3.641843, -26.273689);
-    glm::vec3 ortaBinaMax(295.992584, 89.524246, 215.522171);
-
-    BoundingRegion ortaBinaAABB(ortaBinaMin, ortaBinaMax);
-    ev.boundingRegions.push_back(ortaBinaAABB);
-
+    // street models collide with simplified meshes of their triangles (built on the first run, then read from the cache next to the asset)
+    // the measured boxes are kept for when the import gives no faces
+    ev.loadModel("assets/models/CV/ev/utku_street.gltf", COLLISION_IMPORT_FACES);
+    useBoxesIfNoFaces(ev, {
+        BoundingRegion(glm::vec3(-104.856216, -1.868685, -21.621166), glm::vec3(136.939651, 89.524246, 2.686391)), // sol bina
+        BoundingRegion(glm::vec3(-104.856216, 1.826021, 140.782227), glm::vec3(136.939651, 89.524246, 165.089783)), // sag bina
+        BoundingRegion(glm::vec3(271.685028, -3.641843, -26.273689), glm::vec3(295.992584, 89.524246, 215.522171)) // orta bina
+    });
     scene.registerModel(&ev);
 
-    yol.loadModel("assets/models/CV/yol/utku_street.gltf");
-    yol.boundingRegions.clear();
-
-    glm::vec3 yolMin(-110.937218, -5.913838, -65.131943);
-    glm::vec3 yolMax(269.668243, -1.972113, 197.865646);
-
-    BoundingRegion yolAABB(yolMin, yolMax);
-    yol.boundingRegions.push_back(yolAABB);
-
+    yol.loadModel("assets/models/CV/yol/utku_street.gltf", COLLISION_IMPORT_FACES);
+    useBoxesIfNoFaces(yol, {
+        BoundingRegion(glm::vec3(-110.937218, -5.913838, -65.131943), glm::vec3(269.668243, -1.972113, 197.865646))
+    });
     scene.registerModel(&yol);
 
-    kaldirim.loadModel("assets/models/CV/kaldirim/utku_street.gltf");
-    kaldirim.boundingRegions.clear();
-    
-    glm::vec3 solKaldirimMin(-103.743050, -2.401778, -65.131943);
-    glm::vec3 solKaldirimMax(155.178009, -0.377109, 22.295204);
-
-    BoundingRegion solKaldirimAABB(solKaldirimMin, solKaldirimMax);
-    kaldirim.boundingRegions.push_back(solKaldirimAABB);
-
-    glm::vec3 sagKaldirimMin(-103.743050, -2.401778, 121.954636);
-    glm::vec3 sagKaldirimMax(155.178009, -0.377109, 209.381775);
-
-    BoundingRegion sagKaldirimAABB(sagKaldirimMin, sagKaldirimMax);
-    kaldirim.boundingRegions.push_back(sagKaldirimAABB);
-    
-
+    kaldirim.loadModel("assets/models/CV/kaldirim/utku_street.gltf", COLLISION_IMPORT_FACES);
+    useBoxesIfNoFaces(kaldirim, {
+        BoundingRegion(glm::vec3(-103.743050, -2.401778, -65.131943), glm::vec3(155.178009, -0.377109, 22.295204)), // sol kaldirim
+        BoundingRegion(glm::vec3(-103.743050, -2.401778, 121.954636), glm::vec3(155.178009, -0.377109, 209.381775)) // sag kaldirim
+    });
     scene.registerModel(&kaldirim);
 
     g.init();
@@ -329,7 +301,7 @@ int main() {
 
         // remove launch objects if too far
         for (unsigned int i = 0; i < sphere.currentNoInstances; i++) {
-            if (glm::length(cam.cameraPos - sphere.instances[i]->pos) > 250.0f) {
+            if (glm::length(cam.cameraPos - sphere.instances[i]->getPos()) > 250.0f) {
                 scene.markForDeletion(sphere.instances[i]->instanceId);
             }
         }
@@ -466,7 +438,7 @@ void processInput(double dt) {
 }
 
 void launchItem() {
-    RigidBody* rb = scene.generateInstance(sphere.id, glm::vec3(0.3f), 1.0f, g.instances[0]->pos + glm::vec3(cam.cameraFront * 0.48f) + glm::vec3(cam.cameraUp * 0.006f));
+    RigidBody* rb = scene.generateInstance(sphere.id, glm::vec3(0.3f), 1.0f, g.instances[0]->getPos() + glm::vec3(cam.cameraFront * 0.48f) + glm::vec3(cam.cameraUp * 0.006f));
     if (rb) {
         // instance generated successfully
         rb->transferEnergy(100.0f, cam.cameraFront);
@@ -475,16 +447,18 @@ void launchItem() {
 }
 
 void emitRay() {
-    Ray r(cam.cameraPos, cam.cameraFront);
+    std::vector<Ray> rays = { Ray(cam.cameraPos, cam.cameraFront) };
+    std::vector<BoundingRegion*> hits;
+    std::vector<float> t;
 
-    float tmin = std::numeric_limits<float>::max();
-    BoundingRegion* intersected = scene.octree->checkCollisionsRay(r, tmin);
+    scene.castRays(rays, hits, t);
+    BoundingRegion* intersected = hits[0];
     if (intersected) {
-        std::cout << "Hits " << intersected->instance->instanceId << " at t = " << tmin << std::endl;
+        scene.collisionLog->addRayHit(intersected->instance, t[0]);
         scene.markForDeletion(intersected->instance->instanceId);
     }
     else {
-        std::cout << "No hit" << std::endl;
+        scene.collisionLog->addRayHit(nullptr, t[0]);
     }
 }
 
@@ -534,4 +508,16 @@ void mouseButtonChanged(GLFWwindow* window, int button, int action, int mods)
 void scrollChanged(GLFWwindow* window, double dx, double dy)
 {
     scene.scrollChanged(window, dx, dy);
-}
\ No newline at end of file
+}
+
+// replace bounding regions of model with boxes if its collision import gave no faces (asset or its meshes missing)
+void useBoxesIfNoFaces(Model& model, std::vector<BoundingRegion> boxes) {
+    for (BoundingRegion& br : model.boundingRegions) {
+        if (br.collisionMesh && br.collisionMesh->faces.size() != 0) {
+            return;
+        }
+    }
+
+    std::cout << "No collision faces imported for " << model.id << ", using boxes" << std::endl;
+    model.boundingRegions = boxes;
+}
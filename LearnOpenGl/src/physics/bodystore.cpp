@@ -0,0 +1,233 @@
+#include "bodystore.h"
+
+#include "../algorithms/math/simd.h"
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+
+/*
+	constructor
+*/
+
+// initialize empty store with room for capacity bodies
+BodyStore::BodyStore(unsigned int capacity)
+	: count(0), capacity(capacity)
+{
+	for (std::vector<float>* arr : { &px, &py, &pz, &vx, &vy, &vz, &ax, &ay, &az, &sx, &sy, &sz, &mass }) {
+		arr->resize(capacity, 0.0f);
+	}
+	for (unsigned int i = 0; i < 9; i++) {
+		rotation[i].resize(capacity, 0.0f);
+	}
+	rot.resize(capacity, glm::vec3(0.0f));
+	models.resize(capacity, glm::mat4(1.0f));
+	normalModels.resize(capacity, glm::mat3(1.0f));
+	transformVersions.resize(capacity, 0);
+}
+
+/*
+	body management
+*/
+
+// add body with parameters, returns its index (-1 if full)
+unsigned int BodyStore::add(glm::vec3 size, float mass, glm::vec3 pos, glm::vec3 rot)
+{
+	if (count >= capacity) {
+		return -1;
+	}
+
+	unsigned int idx = count++;
+	px[idx] = pos.x;
+	py[idx] = pos.y;
+	pz[idx] = pos.z;
+	vx[idx] = vy[idx] = vz[idx] = 0.0f;
+	ax[idx] = ay[idx] = az[idx] = 0.0f;
+	sx[idx] = size.x;
+	sy[idx] = size.y;
+	sz[idx] = size.z;
+	this->mass[idx] = mass;
+	setRot(idx, rot);
+
+	models[idx] = glm::mat4(1.0f);
+	normalModels[idx] = glm::mat3(1.0f);
+	transformVersions[idx] = 0;
+	updateMatrices(idx, 1);
+
+	return idx;
+}
+
+// remove body at idx
+void BodyStore::remove(unsigned int idx)
+{
+	if (idx >= count) {
+		return;
+	}
+
+	// shift down
+	for (std::vector<float>* arr : { &px, &py, &pz, &vx, &vy, &vz, &ax, &ay, &az, &sx, &sy, &sz, &mass }) {
+		std::copy(arr->begin() + idx + 1, arr->begin() + count, arr->begin() + idx);
+	}
+	for (unsigned int i = 0; i < 9; i++) {
+		std::copy(rotation[i].begin() + idx + 1, rotation[i].begin() + count, rotation[i].begin() + idx);
+	}
+	std::copy(rot.begin() + idx + 1, rot.begin() + count, rot.begin() + idx);
+	std::copy(models.begin() + idx + 1, models.begin() + count, models.begin() + idx);
+	std::copy(normalModels.begin() + idx + 1, normalModels.begin() + count, normalModels.begin() + idx);
+	std::copy(transformVersions.begin() + idx + 1, transformVersions.begin() + count, transformVersions.begin() + idx);
+	count--;
+}
+
+// set rotation from euler angles
+void BodyStore::setRot(unsigned int idx, glm::vec3 rot)
+{
+	this->rot[idx] = rot;
+	setRotationMatrix(idx, glm::mat3_cast(glm::quat(rot)));
+}
+
+// set rotation matrix directly (must be a rotation)
+void BodyStore::setRotationMatrix(unsigned int idx, glm::mat3 rotation)
+{
+	for (unsigned int c = 0; c < 3; c++) {
+		for (unsigned int r = 0; r < 3; r++) {
+			this->rotation[3 * c + r][idx] = rotation[c][r];
+		}
+	}
+}
+
+/*
+	step functions
+*/
+
+// integrate and update the matrices of all bodies
+void BodyStore::update(float dt)
+{
+	integrate(0, count, dt);
+	updateMatrices(0, count);
+}
+
+// update positions and velocities of bodies in [first, first + n)
+// positions only change when both the velocity and the acceleration are non-zero (bodies at rest clear both)
+void BodyStore::integrate(unsigned int first, unsigned int n, float dt)
+{
+	unsigned int i = first, last = first + n;
+
+#ifdef SIMD_WIDTH
+	simd_float zero = simd_set1(0.0f);
+	simd_float step = simd_set1(dt);
+	simd_float step2 = simd_set1(dt * dt);
+	simd_float half = simd_set1(0.5f);
+
+	for (; i + SIMD_WIDTH <= last; i += SIMD_WIDTH) {
+		simd_float vX = simd_loadu(&vx[i]), vY = simd_loadu(&vy[i]), vZ = simd_loadu(&vz[i]);
+		simd_float aX = simd_loadu(&ax[i]), aY = simd_loadu(&ay[i]), aZ = simd_loadu(&az[i]);
+
+		// lanes of the bodies that move
+		simd_float moving = simd_and(
+			simd_or(simd_or(simd_neq(vX, zero), simd_neq(vY, zero)), simd_neq(vZ, zero)),
+			simd_or(simd_or(simd_neq(aX, zero), simd_neq(aY, zero)), simd_neq(aZ, zero)));
+
+		// pos += velocity * dt + 0.5 * acceleration * dt^2
+		simd_float dX = simd_add(simd_mul(vX, step), simd_mul(simd_mul(half, aX), step2));
+		simd_float dY = simd_add(simd_mul(vY, step), simd_mul(simd_mul(half, aY), step2));
+		simd_float dZ = simd_add(simd_mul(vZ, step), simd_mul(simd_mul(half, aZ), step2));
+		simd_storeu(&px[i], simd_add(simd_loadu(&px[i]), simd_and(moving, dX)));
+		simd_storeu(&py[i], simd_add(simd_loadu(&py[i]), simd_and(moving, dY)));
+		simd_storeu(&pz[i], simd_add(simd_loadu(&pz[i]), simd_and(moving, dZ)));
+
+		// velocity += acceleration * dt
+		simd_storeu(&vx[i], simd_add(vX, simd_mul(aX, step)));
+		simd_storeu(&vy[i], simd_add(vY, simd_mul(aY, step)));
+		simd_storeu(&vz[i], simd_add(vZ, simd_mul(aZ, step)));
+	}
+#endif
+
+	// rest of the range
+	for (; i < last; i++) {
+		bool moving = (vx[i] != 0.0f || vy[i] != 0.0f || vz[i] != 0.0f) &&
+			(ax[i] != 0.0f || ay[i] != 0.0f || az[i] != 0.0f);
+		if (moving) {
+			px[i] += vx[i] * dt + 0.5f * ax[i] * (dt * dt);
+			py[i] += vy[i] * dt + 0.5f * ay[i] * (dt * dt);
+			pz[i] += vz[i] * dt + 0.5f * az[i] * (dt * dt);
+		}
+
+		vx[i] += ax[i] * dt;
+		vy[i] += ay[i] * dt;
+		vz[i] += az[i] * dt;
+	}
+}
+
+// update model matrices of bodies in [first, first + n), versions are only incremented for matrices that changed
+void BodyStore::updateMatrices(unsigned int first, unsigned int n)
+{
+	unsigned int i = first, last = first + n;
+
+	// rotations are orthonormal, so the inverse transpose of rotation * scale is rotation / scale
+
+#ifdef SIMD_WIDTH
+	alignas(32) float rotationScale[9][SIMD_WIDTH];
+	alignas(32) float normal[9][SIMD_WIDTH];
+	simd_float one = simd_set1(1.0f);
+
+	for (; i + SIMD_WIDTH <= last; i += SIMD_WIDTH) {
+		simd_float scale[3] = { simd_loadu(&sx[i]), simd_loadu(&sy[i]), simd_loadu(&sz[i]) };
+
+		for (unsigned int c = 0; c < 3; c++) {
+			simd_float invScale = simd_div(one, scale[c]);
+			for (unsigned int r = 0; r < 3; r++) {
+				simd_float R = simd_loadu(&rotation[3 * c + r][i]);
+				simd_store(rotationScale[3 * c + r], simd_mul(R, scale[c]));
+				simd_store(normal[3 * c + r], simd_mul(R, invScale));
+			}
+		}
+
+		// write out the lanes
+		for (unsigned int k = 0; k < SIMD_WIDTH; k++) {
+			setMatrices(i + k, &rotationScale[0][k], &normal[0][k], SIMD_WIDTH);
+		}
+	}
+#endif
+
+	// rest of the range
+	for (; i < last; i++) {
+		float rotationScale[9], normal[9];
+		float scale[3] = { sx[i], sy[i], sz[i] };
+
+		for (unsigned int c = 0; c < 3; c++) {
+			float invScale = 1.0f / scale[c];
+			for (unsigned int r = 0; r < 3; r++) {
+				float R = rotation[3 * c + r][i];
+				rotationScale[3 * c + r] = R * scale[c];
+				normal[3 * c + r] = R * invScale;
+			}
+		}
+
+		setMatrices(i, rotationScale, normal, 1);
+	}
+}
+
+/*
+	private methods
+*/
+
+// set matrices of body at idx from its rotation * scale elements and their inverse transpose (element e at e * stride)
+void BodyStore::setMatrices(unsigned int idx, float* rotationScale, float* normal, unsigned int stride)
+{
+	glm::mat4 model(1.0f);
+	glm::mat3 normalModel;
+	for (unsigned int c = 0; c < 3; c++) {
+		for (unsigned int r = 0; r < 3; r++) {
+			model[c][r] = rotationScale[(3 * c + r) * stride];
+			normalModel[c][r] = normal[(3 * c + r) * stride];
+		}
+	}
+	model[3] = glm::vec4(px[idx], py[idx], pz[idx], 1.0f);
+
+	if (model != models[idx]) {
+		// world space collision meshes are out of date
+		models[idx] = model;
+		normalModels[idx] = normalModel;
+		transformVersions[idx]++;
+	}
+}
@@ -0,0 +1,87 @@
+#ifndef BODYSTORE_H
+#define BODYSTORE_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/*
+	class to hold the physical state of the bodies of a model as arrays
+	- each value has its own array indexed by body (structure of arrays), so the step can be done for many bodies at once (see math/simd.h)
+	- sized once for the maximum number of bodies, so references to the matrices stay valid (see RigidBody)
+	- bodies are kept packed in [0, count), removing one moves the bodies after it down
+*/
+
+class BodyStore {
+public:
+	// number of bodies in use
+	unsigned int count;
+	// maximum number of bodies
+	unsigned int capacity;
+
+	// positions in m
+	std::vector<float> px, py, pz;
+	// velocities in m/s
+	std::vector<float> vx, vy, vz;
+	// accelerations in m/s^2
+	std::vector<float> ax, ay, az;
+
+	// dimensions
+	std::vector<float> sx, sy, sz;
+	// masses in kg
+	std::vector<float> mass;
+
+	// rotations in euler angles
+	std::vector<glm::vec3> rot;
+	// rotation matrices by element (rotation[3 * c + r] is row r of column c)
+	std::vector<float> rotation[9];
+
+	// model matrices (model = translation * rotation * scale), packed to be copied to the instance buffers
+	std::vector<glm::mat4> models;
+	std::vector<glm::mat3> normalModels;
+	// incremented each time the model matrix changes
+	std::vector<unsigned int> transformVersions;
+
+	/*
+		constructor
+	*/
+
+	// initialize empty store with room for capacity bodies
+	BodyStore(unsigned int capacity = 0);
+
+	/*
+		body management
+	*/
+
+	// add body with parameters, returns its index (-1 if full)
+	unsigned int add(glm::vec3 size, float mass, glm::vec3 pos, glm::vec3 rot);
+
+	// remove body at idx
+	void remove(unsigned int idx);
+
+	// set rotation from euler angles
+	void setRot(unsigned int idx, glm::vec3 rot);
+
+	// set rotation matrix directly (must be a rotation)
+	void setRotationMatrix(unsigned int idx, glm::mat3 rotation);
+
+	/*
+		step functions
+	*/
+
+	// integrate and update the matrices of all bodies
+	void update(float dt);
+
+	// update positions and velocities of bodies in [first, first + n)
+	// positions only change when both the velocity and the acceleration are non-zero (bodies at rest clear both)
+	void integrate(unsigned int first, unsigned int n, float dt);
+
+	// update model matrices of bodies in [first, first + n), versions are only incremented for matrices that changed
+	void updateMatrices(unsigned int first, unsigned int n);
+
+private:
+	// set matrices of body at idx from its rotation * scale elements and their inverse transpose (element e at e * stride)
+	void setMatrices(unsigned int idx, float* rotationScale, float* normal, unsigned int stride);
+};
+
+#endif // !BODYSTORE_H
@@ -0,0 +1,378 @@
+#include "ccd.h"
+
+#include <cmath>
+
+#include "collisionmesh.h"
+#include "narrowphase.h"
+#include "physicsmodel.h"
+
+#include "../algorithms/broadphase.h"
+#include "../algorithms/collisionstats.h"
+
+// sphere starting in contact, hit at t = 0 if it moves into the other shape (sep points from the other shape towards the sphere)
+// separating or sliding motion is left to the discrete tests
+static bool startsInContact(glm::vec3 d, glm::vec3 sep, float& t, glm::vec3& norm) {
+	float len = glm::length(sep);
+	glm::vec3 n = len > CCD_TOLERANCE ? sep / len : -glm::normalize(d);
+	if (glm::dot(d, n) >= 0.0f) {
+		return false;
+	}
+
+	t = 0.0f;
+	norm = n;
+	return true;
+}
+
+// time the center of a sphere moving from c0 along d hits the side of the cylinder around segment pq
+static bool sweepSegmentSide(glm::vec3 c0, glm::vec3 d, glm::vec3 p, glm::vec3 q, float r, float& t, glm::vec3& norm) {
+	glm::vec3 axis = q - p;
+	glm::vec3 m = c0 - p;
+
+	float md = glm::dot(m, axis);
+	float nd = glm::dot(d, axis);
+	float dd = glm::dot(axis, axis);
+
+	float a = dd * glm::dot(d, d) - nd * nd;
+	if (a < CCD_TOLERANCE) {
+		// moving along the segment, ends are tested as spheres
+		return false;
+	}
+
+	float b = dd * glm::dot(m, d) - nd * md;
+	float c = dd * (glm::dot(m, m) - r * r) - md * md;
+	if (c <= 0.0f) {
+		// starts in contact with the side (ends are tested as spheres)
+		if (md < 0.0f || md > dd) {
+			return false;
+		}
+		return startsInContact(d, m - (md / dd) * axis, t, norm);
+	}
+
+	float disc = b * b - a * c;
+	if (b >= 0.0f || disc < 0.0f) {
+		// moving away or missing
+		return false;
+	}
+
+	float tHit = (-b - sqrt(disc)) / a;
+	float s = md + tHit * nd;
+	if (tHit > 1.0f || s < 0.0f || s > dd) {
+		// too far or past the ends of the segment
+		return false;
+	}
+
+	t = tHit;
+	norm = glm::normalize(c0 + tHit * d - (p + (s / dd) * axis));
+	return true;
+}
+
+/*
+	swept sphere tests
+*/
+
+// time of impact of sphere with sphere
+bool CCD::sweepSphereSphere(glm::vec3 c0, glm::vec3 d, float r, glm::vec3 center, float radius, float& t, glm::vec3& norm) {
+	glm::vec3 m = c0 - center;
+	float rs = r + radius;
+
+	float c = glm::dot(m, m) - rs * rs;
+	if (c <= 0.0f) {
+		return startsInContact(d, m, t, norm);
+	}
+
+	float b = glm::dot(m, d);
+	float a = glm::dot(d, d);
+	float disc = b * b - a * c;
+	if (b >= 0.0f || disc < 0.0f) {
+		// moving away or missing
+		return false;
+	}
+
+	float tHit = (-b - sqrt(disc)) / a;
+	if (tHit > 1.0f) {
+		return false;
+	}
+
+	t = tHit;
+	norm = glm::normalize(c0 + tHit * d - center);
+	return true;
+}
+
+// time of impact of sphere with box
+bool CCD::sweepSphereAABB(glm::vec3 c0, glm::vec3 d, float r, glm::vec3 min, glm::vec3 max, float& t, glm::vec3& norm) {
+	glm::vec3 closest = glm::clamp(c0, min, max);
+	if (glm::dot(c0 - closest, c0 - closest) <= r * r) {
+		if (closest == c0) {
+			// center inside of the box, pushed out through the closest face
+			glm::vec3 toMin = c0 - min, toMax = max - c0;
+			glm::vec3 sep(0.0f);
+			int axis = 0;
+			float faceDist = std::min(toMin[0], toMax[0]);
+			for (int i = 1; i < 3; i++) {
+				if (std::min(toMin[i], toMax[i]) < faceDist) {
+					faceDist = std::min(toMin[i], toMax[i]);
+					axis = i;
+				}
+			}
+			sep[axis] = toMin[axis] < toMax[axis] ? -1.0f : 1.0f;
+			return startsInContact(d, sep, t, norm);
+		}
+		return startsInContact(d, c0 - closest, t, norm);
+	}
+
+	// slab test against box grown by the radius (its entry is never later than the hit on the rounded box)
+	glm::vec3 grownMin = min - r;
+	glm::vec3 grownMax = max + r;
+	float tEnter = 0.0f;
+	float tExit = 1.0f;
+	int axis = -1;
+	for (int i = 0; i < 3; i++) {
+		if (std::abs(d[i]) < CCD_TOLERANCE) {
+			if (c0[i] < grownMin[i] || c0[i] > grownMax[i]) {
+				return false;
+			}
+			continue;
+		}
+
+		float t1 = (grownMin[i] - c0[i]) / d[i];
+		float t2 = (grownMax[i] - c0[i]) / d[i];
+		if (t1 > t2) {
+			std::swap(t1, t2);
+		}
+
+		if (t1 > tEnter) {
+			tEnter = t1;
+			axis = i;
+		}
+		tExit = std::min(tExit, t2);
+		if (tEnter > tExit) {
+			return false;
+		}
+	}
+
+	// entered through a face (other axes within the box)
+	glm::vec3 p = c0 + tEnter * d;
+	if (axis != -1 &&
+		p[(axis + 1) % 3] >= min[(axis + 1) % 3] && p[(axis + 1) % 3] <= max[(axis + 1) % 3] &&
+		p[(axis + 2) % 3] >= min[(axis + 2) % 3] && p[(axis + 2) % 3] <= max[(axis + 2) % 3]) {
+		t = tEnter;
+		norm = glm::vec3(0.0f);
+		norm[axis] = d[axis] > 0.0f ? -1.0f : 1.0f;
+		return true;
+	}
+
+	// near an edge or corner, advance by the distance to the box until touching
+	float len = glm::length(d);
+	float tHit = tEnter;
+	for (int i = 0; i < CCD_ITERATIONS; i++) {
+		p = c0 + tHit * d;
+		closest = glm::clamp(p, min, max);
+		float dist = glm::length(p - closest) - r;
+
+		if (dist < CCD_TOLERANCE) {
+			t = tHit;
+			norm = glm::normalize(p - closest);
+			return true;
+		}
+
+		tHit += dist / len;
+		if (tHit > tExit) {
+			return false;
+		}
+	}
+
+	return false;
+}
+
+// time of impact of sphere with triangle
+bool CCD::sweepSphereTriangle(glm::vec3 c0, glm::vec3 d, float r, glm::vec3 a, glm::vec3 b, glm::vec3 c, float& t, glm::vec3& norm) {
+	glm::vec3 faceNorm = glm::cross(b - a, c - a);
+	float area = glm::length(faceNorm);
+	if (area < CCD_TOLERANCE) {
+		// degenerate face
+		return false;
+	}
+	faceNorm /= area;
+
+	// normal on the side the sphere starts on
+	float dist = glm::dot(c0 - a, faceNorm);
+	glm::vec3 n = dist < 0.0f ? -faceNorm : faceNorm;
+	dist = std::abs(dist);
+
+	// if point in plane is inside the triangle
+	auto inside = [&](glm::vec3 p) -> bool {
+		return glm::dot(glm::cross(b - a, p - a), faceNorm) >= 0.0f &&
+			glm::dot(glm::cross(c - b, p - b), faceNorm) >= 0.0f &&
+			glm::dot(glm::cross(a - c, p - c), faceNorm) >= 0.0f;
+	};
+
+	if (dist > r) {
+		// hit face where the sphere first touches the plane
+		float dn = glm::dot(d, n);
+		if (dn >= 0.0f) {
+			// moving away from plane
+			return false;
+		}
+
+		float tPlane = (dist - r) / -dn;
+		if (tPlane > 1.0f) {
+			return false;
+		}
+
+		if (inside(c0 + tPlane * d - r * n)) {
+			t = tPlane;
+			norm = n;
+			return true;
+		}
+	}
+	else if (inside(c0 - dist * n)) {
+		// starts in contact with the face
+		return startsInContact(d, n, t, norm);
+	}
+
+	// otherwise the first contact is on an edge or a vertex
+	bool ret = false;
+	float tHit = 1.0f;
+	glm::vec3 normHit;
+	glm::vec3 vertices[3] = { a, b, c };
+	for (int i = 0; i < 3; i++) {
+		float tTest;
+		glm::vec3 normTest;
+		if (sweepSegmentSide(c0, d, vertices[i], vertices[(i + 1) % 3], r, tTest, normTest) && tTest <= tHit) {
+			tHit = tTest;
+			normHit = normTest;
+			ret = true;
+		}
+		if (sweepSphereSphere(c0, d, r, vertices[i], 0.0f, tTest, normTest) && tTest <= tHit) {
+			tHit = tTest;
+			normHit = normTest;
+			ret = true;
+		}
+	}
+
+	if (ret) {
+		t = tHit;
+		norm = normHit;
+	}
+	return ret;
+}
+
+// time of impact of sphere with region (faces of its collision mesh if it has one)
+bool CCD::sweepSphereRegion(glm::vec3 c0, glm::vec3 d, float r, BoundingRegion& br, float& t, glm::vec3& norm) {
+	if (br.collisionMesh && br.instance) {
+		CollisionMesh* mesh = br.collisionMesh;
+		WorldMesh& worldMesh = mesh->getWorldMesh(br.instance);
+		bool ret = false;
+		float tHit = 1.0f;
+
+		// only faces near the swept sphere
+		unsigned int noFaceTests = 0;
+		mesh->queryBox(br.instance, glm::min(c0, c0 + d) - r, glm::max(c0, c0 + d) + r, [&](unsigned int i) -> bool {
+			Face& face = mesh->faces[i];
+			float tFace;
+			glm::vec3 normFace;
+			noFaceTests++;
+			if (sweepSphereTriangle(c0, d, r,
+				worldMesh.points[face.i1], worldMesh.points[face.i2], worldMesh.points[face.i3],
+				tFace, normFace) && tFace <= tHit) {
+				tHit = tFace;
+				norm = normFace;
+				ret = true;
+			}
+			return false;
+		});
+		Stats::add(Stats::FACE_TESTS, noFaceTests);
+
+		if (ret) {
+			t = tHit;
+		}
+		return ret;
+	}
+
+	if (br.type == BoundTypes::AABB) {
+		return sweepSphereAABB(c0, d, r, br.min, br.max, t, norm);
+	}
+	else if (br.type == BoundTypes::OBB) {
+		// sweep in the frame of the box
+		glm::mat3 toLocal = glm::transpose(br.axes);
+		glm::vec3 normLocal;
+		if (sweepSphereAABB(toLocal * (c0 - br.center), toLocal * d, r, -br.halfSize, br.halfSize, t, normLocal)) {
+			norm = br.axes * normLocal;
+			return true;
+		}
+		return false;
+	}
+	else {
+		return sweepSphereSphere(c0, d, r, br.center, br.radius, t, norm);
+	}
+}
+
+/*
+	sub-stepping
+*/
+
+// move instance back to its first contact since start if it went through something, returns if it was moved
+bool CCD::sweepInstance(BroadPhase* broadPhase, PhysicsModel* model, RigidBody* instance, glm::vec3 start) {
+	glm::vec3 d = instance->getPos() - start;
+	float len2 = glm::dot(d, d);
+	if (len2 == 0.0f) {
+		return false;
+	}
+
+	// first contact of all sphere regions of the instance
+	float tFirst = 1.0f;
+	Contact contact;
+	contact.instance = instance;
+	contact.other = nullptr;
+	contact.depth = 0.0f;
+
+	for (BoundingRegion region : model->boundingRegions) {
+		if (region.type != BoundTypes::SPHERE) {
+			// only spheres are swept
+			continue;
+		}
+
+		region.instance = instance;
+		region.transform();
+		float r = region.radius;
+		if (len2 < CCD_MIN_MOTION * CCD_MIN_MOTION * r * r) {
+			// too slow to go through anything, discrete tests are enough
+			continue;
+		}
+
+		// find regions in the box around the path
+		glm::vec3 c0 = region.center - d;
+		glm::vec3 min = glm::min(c0, region.center) - r;
+		glm::vec3 max = glm::max(c0, region.center) + r;
+
+		broadPhase->queryBox(min, max, [&](BoundingRegion& br) -> void {
+			if (br.instance == instance) {
+				// do not test collision with the same instance
+				return;
+			}
+
+			float t;
+			glm::vec3 norm;
+			if (sweepSphereRegion(c0, d, r, br, t, norm) && t < tFirst) {
+				tFirst = t;
+				contact.other = br.instance;
+				contact.norm = norm;
+				contact.point = c0 + t * d - r * norm;
+			}
+		});
+	}
+
+	if (!contact.other) {
+		return false;
+	}
+
+	// sub-step to the first contact (rest of the motion in this frame is dropped, keep rotation of this frame)
+	instance->setPos(start + tFirst * d);
+	instance->update(0.0f);
+
+	// responded to with the other contacts of the frame
+	contact.type = 5;
+	NarrowPhase::resolve(contact);
+
+	return true;
+}
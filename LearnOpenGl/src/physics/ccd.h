@@ -0,0 +1,53 @@
+#ifndef CCD_H
+#define CCD_H
+
+#include <glm/glm.hpp>
+
+#include "../algorithms/bounds.h"
+
+#include "rigidbody.h"
+
+// fraction of its radius a sphere has to move in a frame before it is swept
+#define CCD_MIN_MOTION 0.5f
+// iterations of conservative advancement near box edges and corners
+#define CCD_ITERATIONS 16
+// distance a sphere is considered touching at
+#define CCD_TOLERANCE 1e-4f
+
+// forward declaration
+class BroadPhase;
+class PhysicsModel;
+
+/*
+	namespace to tie together the continuous collision tests
+	- a sphere moving from c0 to c0 + d is swept against other shapes, t is the fraction of d travelled at the first contact
+	- normals point from the other shape towards the sphere
+	- starting in contact is a hit at t = 0 if the sphere moves into the other shape, separating or sliding motion is not
+*/
+
+namespace CCD {
+	/*
+		swept sphere tests
+	*/
+
+	// time of impact of sphere with sphere
+	bool sweepSphereSphere(glm::vec3 c0, glm::vec3 d, float r, glm::vec3 center, float radius, float& t, glm::vec3& norm);
+
+	// time of impact of sphere with box
+	bool sweepSphereAABB(glm::vec3 c0, glm::vec3 d, float r, glm::vec3 min, glm::vec3 max, float& t, glm::vec3& norm);
+
+	// time of impact of sphere with triangle
+	bool sweepSphereTriangle(glm::vec3 c0, glm::vec3 d, float r, glm::vec3 a, glm::vec3 b, glm::vec3 c, float& t, glm::vec3& norm);
+
+	// time of impact of sphere with region (faces of its collision mesh if it has one)
+	bool sweepSphereRegion(glm::vec3 c0, glm::vec3 d, float r, BoundingRegion& br, float& t, glm::vec3& norm);
+
+	/*
+		sub-stepping
+	*/
+
+	// move instance back to its first contact since start if it went through something, returns if it was moved
+	bool sweepInstance(BroadPhase* broadPhase, PhysicsModel* model, RigidBody* instance, glm::vec3 start);
+}
+
+#endif // !CCD_H
@@ -0,0 +1,182 @@
+#include "collisionimport.h"
+
+#include "../algorithms/meshsimplifier.h"
+
+#include <fstream>
+#include <limits>
+
+// FNV-1a parameters
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+/*
+	constructor
+*/
+
+// initialize with the path of the asset and the face budget, reads the cache file if there is one
+CollisionImport::CollisionImport(std::string assetPath, unsigned int maxFaces)
+	: path(assetPath + COLLISION_IMPORT_EXTENSION), maxFaces(maxFaces), changed(false)
+{
+	load();
+}
+
+/*
+	functionality
+*/
+
+// make sure mesh idx of the asset is up to date in the lists (simplified from the source if the file has no matching record)
+void CollisionImport::build(unsigned int idx, std::vector<glm::vec3>& sourcePoints, std::vector<unsigned int>& sourceIndices)
+{
+	unsigned long long sourceHash = hash(sourcePoints, sourceIndices);
+	if (idx < records.size() && records[idx].hash == sourceHash) {
+		// cached
+		return;
+	}
+
+	if (idx >= records.size()) {
+		records.resize(idx + 1, CollisionImportMesh());
+		points.resize(idx + 1);
+		indices.resize(idx + 1);
+	}
+
+	// size of the mesh for the weld distance
+	glm::vec3 min(std::numeric_limits<float>::max());
+	glm::vec3 max(std::numeric_limits<float>::lowest());
+	for (glm::vec3& p : sourcePoints) {
+		min = glm::min(min, p);
+		max = glm::max(max, p);
+	}
+	float size = sourcePoints.empty() ? 0.0f : glm::length(max - min);
+
+	// render meshes split points at texture seams, weld them so the seams can collapse
+	std::vector<glm::vec3> meshPoints = sourcePoints;
+	std::vector<unsigned int> meshIndices = sourceIndices;
+	if (size > 0.0f) {
+		MeshSimplifier::weld(meshPoints, meshIndices, COLLISION_IMPORT_WELD * size);
+	}
+	MeshSimplifier::simplify(meshPoints, meshIndices, maxFaces);
+
+	records[idx].hash = sourceHash;
+	records[idx].noPoints = (unsigned int)meshPoints.size();
+	records[idx].noFaces = (unsigned int)meshIndices.size() / 3;
+
+	points[idx].resize(3 * meshPoints.size());
+	for (unsigned int i = 0; i < meshPoints.size(); i++) {
+		points[idx][3 * i + 0] = meshPoints[i].x;
+		points[idx][3 * i + 1] = meshPoints[i].y;
+		points[idx][3 * i + 2] = meshPoints[i].z;
+	}
+	indices[idx] = meshIndices;
+
+	changed = true;
+}
+
+// read records from the file, returns false if missing or invalid
+bool CollisionImport::load()
+{
+	records.clear();
+	points.clear();
+	indices.clear();
+
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file.is_open()) {
+		return false;
+	}
+	unsigned long long remaining = (unsigned long long)file.tellg();
+	file.seekg(0);
+
+	CollisionImportHeader header = {};
+	if (remaining < sizeof(CollisionImportHeader) ||
+		!file.read((char*)&header, sizeof(CollisionImportHeader)) ||
+		header.magic != COLLISION_IMPORT_MAGIC || header.version != COLLISION_IMPORT_VERSION) {
+		return false;
+	}
+	remaining -= sizeof(CollisionImportHeader);
+
+	for (unsigned int i = 0; i < header.noMeshes; i++) {
+		CollisionImportMesh record = {};
+		if (remaining < sizeof(CollisionImportMesh) || !file.read((char*)&record, sizeof(CollisionImportMesh))) {
+			break;
+		}
+		remaining -= sizeof(CollisionImportMesh);
+
+		// lists must fit in the rest of the file
+		unsigned long long size = 3ULL * record.noPoints * sizeof(float) + 3ULL * record.noFaces * sizeof(unsigned int);
+		if (size > remaining) {
+			break;
+		}
+		remaining -= size;
+
+		std::vector<float> meshPoints(3 * record.noPoints);
+		std::vector<unsigned int> meshIndices(3 * record.noFaces);
+		file.read((char*)meshPoints.data(), meshPoints.size() * sizeof(float));
+		file.read((char*)meshIndices.data(), meshIndices.size() * sizeof(unsigned int));
+
+		bool valid = file.good();
+		for (unsigned int idx : meshIndices) {
+			valid &= idx < record.noPoints;
+		}
+		if (!valid) {
+			break;
+		}
+
+		records.push_back(record);
+		points.push_back(meshPoints);
+		indices.push_back(meshIndices);
+	}
+
+	if (records.size() != header.noMeshes) {
+		// keep nothing from a damaged file
+		records.clear();
+		points.clear();
+		indices.clear();
+		return false;
+	}
+	return true;
+}
+
+// write records to the file
+bool CollisionImport::save()
+{
+	CollisionImportHeader header = {};
+	header.magic = COLLISION_IMPORT_MAGIC;
+	header.version = COLLISION_IMPORT_VERSION;
+	header.noMeshes = (unsigned int)records.size();
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	file.write((const char*)&header, sizeof(CollisionImportHeader));
+	for (unsigned int i = 0; i < records.size(); i++) {
+		file.write((const char*)&records[i], sizeof(CollisionImportMesh));
+		file.write((const char*)points[i].data(), points[i].size() * sizeof(float));
+		file.write((const char*)indices[i].data(), indices[i].size() * sizeof(unsigned int));
+	}
+
+	changed = false;
+	return file.good();
+}
+
+/*
+	private methods
+*/
+
+// hash of a source mesh and the face budget (FNV-1a)
+unsigned long long CollisionImport::hash(std::vector<glm::vec3>& sourcePoints, std::vector<unsigned int>& sourceIndices)
+{
+	unsigned long long h = FNV_OFFSET;
+	auto add = [&h](const void* data, size_t size) -> void {
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i = 0; i < size; i++) {
+			h ^= bytes[i];
+			h *= FNV_PRIME;
+		}
+	};
+
+	add(&maxFaces, sizeof(unsigned int));
+	add(sourcePoints.data(), sourcePoints.size() * sizeof(glm::vec3));
+	add(sourceIndices.data(), sourceIndices.size() * sizeof(unsigned int));
+	return h;
+}
@@ -0,0 +1,94 @@
+#ifndef COLLISIONIMPORT_H
+#define COLLISIONIMPORT_H
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+// identifies collision import cache files ("CMSH")
+#define COLLISION_IMPORT_MAGIC 0x48534d43
+// change when the file layout or the simplification rules change
+#define COLLISION_IMPORT_VERSION 1
+// extension added to the path of the asset for its cache file
+#define COLLISION_IMPORT_EXTENSION ".collision"
+// default number of faces each simplified mesh is reduced to
+#define COLLISION_IMPORT_FACES 1024
+// distance points are welded at before simplifying (fraction of the size of the mesh)
+#define COLLISION_IMPORT_WELD 1e-5f
+
+/*
+	header at the start of a cache file
+*/
+
+typedef struct CollisionImportHeader {
+	// file identification
+	unsigned int magic;
+	unsigned int version;
+
+	// number of mesh records
+	unsigned int noMeshes;
+} CollisionImportHeader;
+
+/*
+	record of each mesh, followed by its points (3 floats each) and faces (3 indices each)
+*/
+
+typedef struct CollisionImportMesh {
+	// hash of the source mesh and the face budget it was simplified with
+	unsigned long long hash;
+
+	// number of points and faces of the simplified mesh
+	unsigned int noPoints;
+	unsigned int noFaces;
+} CollisionImportMesh;
+
+/*
+	class to build simplified collision meshes for the meshes of an imported model
+	- each mesh is welded and simplified to a face budget, since the render triangles are too many to test and boxes are too rough
+	- results are kept in a file next to the asset and only rebuilt when the source mesh or the budget changes
+*/
+
+class CollisionImport {
+public:
+	// path of the cache file
+	std::string path;
+
+	// number of faces each mesh is reduced to
+	unsigned int maxFaces;
+
+	// records of the meshes by their index in the asset
+	std::vector<CollisionImportMesh> records;
+	// points (3 floats each) and face indices of the meshes
+	std::vector<std::vector<float>> points;
+	std::vector<std::vector<unsigned int>> indices;
+
+	// if a mesh was built since the file was read
+	bool changed;
+
+	/*
+		constructor
+	*/
+
+	// initialize with the path of the asset and the face budget, reads the cache file if there is one
+	CollisionImport(std::string assetPath, unsigned int maxFaces = COLLISION_IMPORT_FACES);
+
+	/*
+		functionality
+	*/
+
+	// make sure mesh idx of the asset is up to date in the lists (simplified from the source if the file has no matching record)
+	void build(unsigned int idx, std::vector<glm::vec3>& sourcePoints, std::vector<unsigned int>& sourceIndices);
+
+	// read records from the file, returns false if missing or invalid
+	bool load();
+
+	// write records to the file
+	bool save();
+
+private:
+	// hash of a source mesh and the face budget (FNV-1a)
+	unsigned long long hash(std::vector<glm::vec3>& sourcePoints, std::vector<unsigned int>& sourceIndices);
+};
+
+#endif // !COLLISIONIMPORT_H
@@ -0,0 +1,84 @@
+#include "collisionlog.h"
+#include "narrowphase.h"
+
+#include <iostream>
+
+/*
+	constructor
+*/
+
+// initialize with verbosity
+CollisionLog::CollisionLog(CollisionVerbosity verbosity)
+	: verbosity(verbosity) {}
+
+/*
+	recording (safe from any thread)
+*/
+
+// record contact that was responded to
+void CollisionLog::addContact(Contact& contact) {
+	if (verbosity == CollisionVerbosity::SILENT) {
+		return;
+	}
+
+	records.push({ CollisionRecordType::CONTACT, contact.type, contact.instance, contact.other, 0.0f });
+}
+
+// record result of a ray query
+void CollisionLog::addRayHit(RigidBody* instance, float t) {
+	if (verbosity == CollisionVerbosity::SILENT) {
+		return;
+	}
+
+	records.push({ CollisionRecordType::RAY_HIT, 0, instance, nullptr, t });
+}
+
+/*
+	output
+*/
+
+// print and remove all records (called once per frame)
+void CollisionLog::drain() {
+	unsigned int noContacts = 0, noRayHits = 0;
+	bool printEvents = verbosity == CollisionVerbosity::EVENTS;
+
+	CollisionRecord record;
+	while (records.pop(record)) {
+		if (record.type == CollisionRecordType::CONTACT) {
+			noContacts++;
+			if (printEvents) {
+				std::cout << "Case " << (int)record.contactType << ": Instance " << record.other->instanceId
+					<< "(" << record.other->modelId << ") collides with instance "
+					<< record.instance->instanceId << "(" << record.instance->modelId << ")\n";
+			}
+		}
+		else {
+			noRayHits++;
+			if (printEvents) {
+				if (record.instance) {
+					std::cout << "Hits " << record.instance->instanceId << " at t = " << record.t << "\n";
+				}
+				else {
+					std::cout << "No hit\n";
+				}
+			}
+		}
+	}
+
+	unsigned int noDropped = records.takeDropped();
+	if (verbosity == CollisionVerbosity::SUMMARY && (noContacts || noRayHits || noDropped)) {
+		std::cout << noContacts << " contacts, " << noRayHits << " ray queries";
+		if (noDropped) {
+			std::cout << ", " << noDropped << " records dropped";
+		}
+		std::cout << "\n";
+	}
+	else if (printEvents && noDropped) {
+		std::cout << noDropped << " records dropped\n";
+	}
+
+	if (noContacts || noRayHits || noDropped) {
+		// one flush per frame
+		std::cout.flush();
+	}
+}
@@ -0,0 +1,94 @@
+#ifndef COLLISIONLOG_H
+#define COLLISIONLOG_H
+
+#include <glm/glm.hpp>
+
+#include "../algorithms/ringbuffer.hpp"
+
+#include "rigidbody.h"
+
+// forward declaration
+struct Contact;
+
+// number of records kept between drains
+#define COLLISION_LOG_CAPACITY 1024
+
+/*
+	enum for how much the log prints when drained
+*/
+
+enum class CollisionVerbosity : unsigned char {
+	SILENT = 0x00,	// nothing is recorded
+	SUMMARY = 0x01,	// one line of counts per frame
+	EVENTS = 0x02	// one line per record
+};
+
+/*
+	enum for the kinds of records
+*/
+
+enum class CollisionRecordType : unsigned char {
+	CONTACT = 0x00,
+	RAY_HIT = 0x01
+};
+
+/*
+	structure representing a logged contact or ray hit
+	- instances are only dereferenced when draining (before dead instances are freed)
+*/
+
+typedef struct CollisionRecord {
+	// kind of record
+	CollisionRecordType type;
+	// test case of contact (1-4)
+	unsigned char contactType;
+
+	// instance responding to the contact or hit by the ray (nullptr = ray missed)
+	RigidBody* instance;
+	// instance it collided with (contacts only)
+	RigidBody* other;
+
+	// distance along ray (ray hits only)
+	float t;
+} CollisionRecord;
+
+/*
+	class to record collision events without printing in the collision loops
+	- records go into a lock-free ring buffer and are formatted once per frame
+*/
+
+class CollisionLog {
+public:
+	// how much is recorded and printed
+	CollisionVerbosity verbosity;
+
+	/*
+		constructor
+	*/
+
+	// initialize with verbosity
+	CollisionLog(CollisionVerbosity verbosity = CollisionVerbosity::SILENT);
+
+	/*
+		recording (safe from any thread)
+	*/
+
+	// record contact that was responded to
+	void addContact(Contact& contact);
+
+	// record result of a ray query
+	void addRayHit(RigidBody* instance, float t);
+
+	/*
+		output
+	*/
+
+	// print and remove all records (called once per frame)
+	void drain();
+
+private:
+	// records waiting to be drained
+	RingBuffer<CollisionRecord, COLLISION_LOG_CAPACITY> records;
+};
+
+#endif // !COLLISIONLOG_H
@@ -4,131 +4,22 @@
 
 #include "../algorithms/math/linalg.h"
 
+#include <cmath>
 #include <iostream>
 #include <limits>
+#include <mutex>
 
-bool Face::collidesWithFace(RigidBody* thisRB, Face& face, RigidBody* faceRB, glm::vec3& retNorm) {
-	// transform coordinates so that P1 is the origin
-	glm::vec3 P1 = mat4vec3mult(thisRB->model, this->mesh->points[this->i1]);
-	glm::vec3 P2 = mat4vec3mult(thisRB->model, this->mesh->points[this->i2]) - P1;
-	glm::vec3 P3 = mat4vec3mult(thisRB->model, this->mesh->points[this->i3]) - P1;
-
-	glm::vec3 lines[3] = {
-		P2, // P2 - P1 = A
-		P3, // P3 - P1 = B
-		P3 - P2 // = CS
-	};
-
-	glm::vec3 thisNorm = thisRB->normalModel * this->norm;
-
-	glm::vec3 U1 = mat4vec3mult(faceRB->model, face.mesh->points[face.i1]) - P1;
-	glm::vec3 U2 = mat4vec3mult(faceRB->model, face.mesh->points[face.i2]) - P1;
-	glm::vec3 U3 = mat4vec3mult(faceRB->model, face.mesh->points[face.i3]) - P1;
-
-	retNorm = faceRB->normalModel * face.norm;
-
-	// set P1 as origin (zero vector)
-	P1[0] = 0.0f; P1[1] = 0.0f; P1[2] = 0.0f;
-
-	// place holders
-	float c1, c2, c3;
-
-
-	/*
-		itterate trough each bounding region of the face
-		check intersections
-	*/
-	glm::vec3 sideOrigins[3] = {
-		U1,
-		U1,
-		U2
-	};
-	glm::vec3 sides[3] = {
-		U2 - U1,
-		U3 - U1,
-		U3 - U2
-	};
-	for (unsigned int i = 0; i < 3; i++) {
-		// get intersections of this plane
-		float t = 0.0f;
-		LinePlaneIntCase currentCase = linePlaneIntersection(P1, thisNorm, sideOrigins[i], sides[i], t);
-		
-		switch (currentCase)
-		{
-		case LinePlaneIntCase::CASE0:
-			// determine intersection with the lines of this face
-
-			for (int j = 0; j < 3; j++) {
-				glm::mat3 m(lines[j], -1.0f * sides[i], sideOrigins[i]);
-
-				rref(m);
-
-				if (m[2][2] != 0.0f) {
-					// no intersection
-					continue;
-				}
-
-				c1 = m[2][0];
-				c2 = m[2][1];
-
-				if (0.0f <= c1 && c1 <= 1.0f &&
-					0.0f <= c2 && c2 <= 1.0f) {
-					return true;
-				}
-			}
-
-			return false;
-		case LinePlaneIntCase::CASE1:
-			// no intersection => no collision
-			continue;
-		case LinePlaneIntCase::CASE2:
-			// intersection in the plane, in range
-			// determine if inside this triangle (bounded by P1, P2 and P3)
-
-			// get point of intersection
-			glm::vec3 intersection = sideOrigins[i] + t * sides[i];
+// locks guarding the world space meshes of instances
+static std::mutex worldMeshLocks[WORLD_MESH_LOCKS];
 
-			// represent the intersection point as a linear combination
+bool Face::collidesWithFace(WorldMesh& thisMesh, Face& face, WorldMesh& faceMesh, glm::vec3& retNorm) {
+	retNorm = faceMesh.norms[&face - &face.mesh->faces[0]];
 
-			if (faceContainsPoint(P2, P3, thisNorm, intersection)) {
-				return true;
-			}
-
-			continue;
-		case LinePlaneIntCase::CASE3:
-			// intersection in plane, out of range
-			// => no collision
-			continue;
-		};
-	}
-	return false;
-}
-
-bool Face::collidesWithSphere(RigidBody* thisRB, BoundingRegion& br, glm::vec3& retNorm)
-{
-	if (br.type != BoundTypes::SPHERE) {
-		return false;
-	}
-
-	// apply model transformations
-	glm::vec3 P1 = mat4vec3mult(thisRB->model, this->mesh->points[i1]);
-	glm::vec3 P2 = mat4vec3mult(thisRB->model, this->mesh->points[i2]);
-	glm::vec3 P3 = mat4vec3mult(thisRB->model, this->mesh->points[i3]);
-
-	glm::vec3 norm = thisRB->normalModel * this->norm;
-	glm::vec3 unitN = norm / glm::length(norm);
-
-	glm::vec3 distanceVec = br.center - P1;
-	float distance = glm::dot(distanceVec, unitN);
-
-	if (abs(distance) < br.radius) {
-		glm::vec3 circCenter = br.center + distance * unitN;
-
-		retNorm = unitN;
-
-		return faceContainsPointRange(P2 - P1, P3 - P1, norm, circCenter - P1, br.radius);
-	}
-	return false;
+	// closed form test (edges of either face crossing the other, or touching in the same plane)
+	return triangleTriangleIntersection(
+		thisMesh.points[this->i1], thisMesh.points[this->i2], thisMesh.points[this->i3],
+		faceMesh.points[face.i1], faceMesh.points[face.i2], faceMesh.points[face.i3]
+	);
 }
 
 CollisionMesh::CollisionMesh(unsigned int noPoints, float* coordinates,
@@ -190,4 +81,94 @@ CollisionMesh::CollisionMesh(unsigned int noPoints, float* coordinates,
 			N			// normal placeholder
 		};
 	}
+
+	// check if all points are on one side of every face
+	convex = noFaces > 0;
+	float tolerance = CONVEX_MESH_TOLERANCE * br.radius;
+	for (unsigned int i = 0; convex && i < noFaces; i++) {
+		float len = glm::length(faces[i].norm);
+		if (len == 0.0f) {
+			// degenerate face
+			continue;
+		}
+		glm::vec3 N = faces[i].norm / len;
+		glm::vec3 P1 = points[faces[i].i1];
+
+		bool above = false, below = false;
+		for (unsigned int j = 0; j < noPoints; j++) {
+			float distance = glm::dot(points[j] - P1, N);
+			above |= distance > tolerance;
+			below |= distance < -tolerance;
+			if (above && below) {
+				convex = false;
+				break;
+			}
+		}
+	}
+
+	// build tree over faces
+	bvh.build(points, faces);
+}
+
+// call for each face that can be in the world space box when the mesh is transformed by instance
+void CollisionMesh::queryBox(RigidBody* instance, glm::vec3 min, glm::vec3 max, MeshBVH::FaceCallback callback)
+{
+	// box in local space
+	glm::mat4 toLocal = glm::inverse(instance->getModel());
+	MeshBVH::transformBox(toLocal, min, max);
+
+	bvh.queryBox(min, max, callback);
+}
+
+// call for each run of faces (positions in WorldMesh::faces) that can be in the world space box when the mesh is transformed by instance
+void CollisionMesh::queryBoxRanges(RigidBody* instance, glm::vec3 min, glm::vec3 max, MeshBVH::RangeCallback callback)
+{
+	// box in local space
+	glm::mat4 toLocal = glm::inverse(instance->getModel());
+	MeshBVH::transformBox(toLocal, min, max);
+
+	bvh.queryBoxRanges(min, max, callback);
+}
+
+// get mesh transformed by instance, only recomputed after the instance moved (can be called from the workers)
+WorldMesh& CollisionMesh::getWorldMesh(RigidBody* instance)
+{
+	std::lock_guard<std::mutex> lock(worldMeshLocks[instance->bodyId % WORLD_MESH_LOCKS]);
+
+	// find mesh in list of instance
+	WorldMesh* ret = nullptr;
+	for (WorldMesh& worldMesh : instance->worldMeshes) {
+		if (worldMesh.mesh == this) {
+			if (worldMesh.version == instance->getTransformVersion()) {
+				// still up to date
+				return worldMesh;
+			}
+			ret = &worldMesh;
+			break;
+		}
+	}
+
+	if (!ret) {
+		// first use with this instance
+		instance->worldMeshes.push_back({ this, 0, std::vector<glm::vec3>(points.size()), std::vector<glm::vec3>(faces.size()), TriangleArrays() });
+		ret = &instance->worldMeshes.back();
+		ret->faces.resize((unsigned int)faces.size());
+	}
+
+	// transform points and normals
+	glm::mat4 model = instance->getModel();
+	const glm::mat3& normalModel = instance->getNormalModel();
+	for (unsigned int i = 0, noPoints = (unsigned int)points.size(); i < noPoints; i++) {
+		ret->points[i] = mat4vec3mult(model, points[i]);
+	}
+	for (unsigned int i = 0, noFaces = (unsigned int)faces.size(); i < noFaces; i++) {
+		ret->norms[i] = normalModel * faces[i].norm;
+
+		// faces in the order of the tree
+		Face& face = faces[bvh.faceIndices[i]];
+		ret->faces.set(i, ret->points[face.i1], ret->points[face.i2], ret->points[face.i3]);
+	}
+	ret->version = instance->getTransformVersion();
+
+	return *ret;
 }
@@ -6,11 +6,18 @@
 #include <vector>
 
 #include "../algorithms/bounds.h"
+#include "../algorithms/meshbvh.h"
+
+#include "rigidbody.h"
+
+// number of locks guarding the world space meshes of instances (instances share locks by id)
+#define WORLD_MESH_LOCKS 64
+// distance points can be off the faces of a convex mesh (fraction of the mesh radius)
+#define CONVEX_MESH_TOLERANCE 1e-3f
 
 // Forward decleration
 class CollisionModel;
 class CollisionMesh;
-class RigidBody;
 
 typedef struct Face {
 	CollisionMesh* mesh;
@@ -19,8 +26,8 @@ typedef struct Face {
 	glm::vec3 baseNormal;
 	glm::vec3 norm;
 
-	bool collidesWithFace(RigidBody* thisRB, struct Face& face, RigidBody* faceRB, glm::vec3& retNorm);
-	bool collidesWithSphere(RigidBody* thisRB, BoundingRegion& br, glm::vec3& retNorm);
+	// tests use the points of the meshes in world space (see CollisionMesh::getWorldMesh)
+	bool collidesWithFace(WorldMesh& thisMesh, struct Face& face, WorldMesh& faceMesh, glm::vec3& retNorm);
 } Face;
 
 class CollisionMesh {
@@ -32,7 +39,22 @@ public:
 	std::vector<glm::vec3> points;
 	std::vector<Face> faces;
 
+	// tree over the faces in local space (built with the mesh)
+	MeshBVH bvh;
+
+	// if all points are on one side of every face (convex meshes are tested as hulls instead of by faces)
+	bool convex;
+
 	CollisionMesh(unsigned int noPoints, float* coordinates, unsigned int noFaces, unsigned int* indices);
+
+	// call for each face that can be in the world space box when the mesh is transformed by instance
+	void queryBox(RigidBody* instance, glm::vec3 min, glm::vec3 max, MeshBVH::FaceCallback callback);
+
+	// call for each run of faces (positions in WorldMesh::faces) that can be in the world space box when the mesh is transformed by instance
+	void queryBoxRanges(RigidBody* instance, glm::vec3 min, glm::vec3 max, MeshBVH::RangeCallback callback);
+
+	// get mesh transformed by instance, only recomputed after the instance moved (can be called from the workers)
+	WorldMesh& getWorldMesh(RigidBody* instance);
 };
 
 #endif // !COLLISIONMESH_H
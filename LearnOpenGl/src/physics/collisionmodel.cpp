@@ -1,6 +1,6 @@
 #include "collisionmodel.h"
 
-#include "../graphics/objects/model.h"
+#include "physicsmodel.h"
 
-CollisionModel::CollisionModel(Model* model)
+CollisionModel::CollisionModel(PhysicsModel* model)
 	: model(model) {}
\ No newline at end of file
@@ -6,15 +6,15 @@
 #include <vector>
 
 // forward decleration
-class Model;
+class PhysicsModel;
 
 class CollisionModel {
 public:
-	Model* model;
+	PhysicsModel* model;
 
 	std::vector<CollisionMesh> meshes;
 
-	CollisionModel(Model* model);
+	CollisionModel(PhysicsModel* model);
 };
 
 #endif // !COLLISIONMODEL_H
@@ -0,0 +1,171 @@
+#include "contactcache.h"
+
+#include "../algorithms/states.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// max difference of a relative transform element to count as unchanged
+#define TRANSFORM_EPSILON 1e-5f
+
+/*
+	functionality
+*/
+
+// get cached contact if pair is touching and has not moved relative to itself (read only)
+bool ContactCache::getCached(BoundingRegion& br, BoundingRegion& obj, Contact& contact) {
+	auto it = pairs.find(pairKey(br.instance, obj.instance));
+	if (it == pairs.end()) {
+		return false;
+	}
+
+	ContactPair& pair = it->second;
+	if (!pair.touching || pair.lastFrame == frame || pair.manifold.size() == 0) {
+		// not touching or already tested this frame
+		return false;
+	}
+
+	glm::mat4 rel = relativeTransform(pair.a, pair.b);
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			if (std::abs(rel[i][j] - pair.relTransform[i][j]) > TRANSFORM_EPSILON) {
+				return false;
+			}
+		}
+	}
+
+	// prefer the contact with the same responder
+	contact = pair.manifold[0];
+	for (Contact& c : pair.manifold) {
+		if (c.instance == obj.instance) {
+			contact = c;
+			break;
+		}
+	}
+
+	return true;
+}
+
+// add contact found this frame
+void ContactCache::add(Contact& contact) {
+	unsigned long long key = pairKey(contact.instance, contact.other);
+	auto it = pairs.find(key);
+
+	if (it == pairs.end()) {
+		// new pair
+		ContactPair pair;
+		if (contact.instance->bodyId < contact.other->bodyId) {
+			pair.a = contact.instance;
+			pair.b = contact.other;
+		}
+		else {
+			pair.a = contact.other;
+			pair.b = contact.instance;
+		}
+		pair.relTransform = glm::mat4(1.0f);
+		pair.lastFrame = 0;
+		pair.lastResponse = 0.0f;
+		pair.touching = false;
+
+		it = pairs.emplace(key, pair).first;
+	}
+
+	ContactPair& pair = it->second;
+	if (pair.lastFrame != frame) {
+		// first contact this frame, replace manifold
+		pair.manifold.clear();
+		pair.relTransform = relativeTransform(pair.a, pair.b);
+		pair.lastFrame = frame;
+		frameOrder.push_back(key);
+	}
+
+	// skip duplicates (same responder and normal)
+	for (Contact& c : pair.manifold) {
+		if (c.instance == contact.instance && glm::all(glm::lessThan(glm::abs(c.norm - contact.norm), glm::vec3(TRANSFORM_EPSILON)))) {
+			return;
+		}
+	}
+
+	if (pair.manifold.size() < MAX_MANIFOLD_CONTACTS) {
+		pair.manifold.push_back(contact);
+	}
+}
+
+// emit events and apply collision responses (called once per frame after the broad phase)
+void ContactCache::endFrame(float time) {
+	// pairs found this frame, in order
+	for (unsigned long long key : frameOrder) {
+		ContactPair& pair = pairs[key];
+		bool begin = !pair.touching;
+
+		if (callback) {
+			callback(begin ? ContactEvent::BEGIN : ContactEvent::STAY, pair);
+		}
+
+		if (begin || time - pair.lastResponse >= COLLISION_THRESHOLD) {
+			// respond once for each body of the pair
+			RigidBody* responded = nullptr;
+			for (Contact& contact : pair.manifold) {
+				if (contact.instance != responded) {
+					NarrowPhase::respond(contact);
+					if (responded) {
+						break;
+					}
+					responded = contact.instance;
+				}
+			}
+			pair.lastResponse = time;
+		}
+
+		pair.touching = true;
+	}
+	frameOrder.clear();
+
+	// pairs not found this frame
+	for (auto it = pairs.begin(); it != pairs.end();) {
+		ContactPair& pair = it->second;
+		bool dead = States::isActive(&pair.a->state, INSTANCE_DEAD) || States::isActive(&pair.b->state, INSTANCE_DEAD);
+
+		if (!dead && pair.lastFrame == frame) {
+			it++;
+		}
+		else if (!dead &&
+			!States::isActive(&pair.a->state, INSTANCE_MOVED) &&
+			!States::isActive(&pair.b->state, INSTANCE_MOVED)) {
+			// neither body moved so they were not tested, still touching
+			if (callback) {
+				callback(ContactEvent::STAY, pair);
+			}
+			it++;
+		}
+		else {
+			if (callback) {
+				callback(ContactEvent::END, pair);
+			}
+			it = pairs.erase(it);
+		}
+	}
+
+	frame++;
+}
+
+// remove all pairs
+void ContactCache::clear() {
+	pairs.clear();
+	frameOrder.clear();
+}
+
+// get key of pair
+unsigned long long ContactCache::pairKey(RigidBody* rb1, RigidBody* rb2) {
+	unsigned int id1 = rb1->bodyId;
+	unsigned int id2 = rb2->bodyId;
+	if (id1 > id2) {
+		std::swap(id1, id2);
+	}
+	return ((unsigned long long)id1 << 32) | id2;
+}
+
+// get transform of second body in the first body's frame
+glm::mat4 ContactCache::relativeTransform(RigidBody* a, RigidBody* b) {
+	return glm::inverse(a->getModel()) * b->getModel();
+}
@@ -0,0 +1,91 @@
+#ifndef CONTACTCACHE_H
+#define CONTACTCACHE_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <unordered_map>
+
+#include "narrowphase.h"
+#include "rigidbody.h"
+
+// maximum number of contacts stored for a pair
+#define MAX_MANIFOLD_CONTACTS 4
+
+/*
+	enum for contact events
+*/
+
+enum class ContactEvent : unsigned char {
+	BEGIN = 0x00,	// pair started touching this frame
+	STAY = 0x01,	// pair was already touching
+	END = 0x02		// pair stopped touching
+};
+
+/*
+	structure representing two touching bodies across frames
+*/
+
+typedef struct ContactPair {
+	// bodies of the pair (a has the lower body id)
+	RigidBody* a;
+	RigidBody* b;
+
+	// contacts found in the last frame the pair was tested (manifold)
+	std::vector<Contact> manifold;
+
+	// transform of b in a's frame when the contacts were found
+	glm::mat4 relTransform;
+
+	// frame the contacts were found in
+	unsigned int lastFrame;
+	// time of last collision response
+	float lastResponse;
+	// if pair was touching at the end of the previous frame
+	bool touching;
+} ContactPair;
+
+/*
+	class to keep contacts between frames
+	- contacts of a frame are merged by body pair, responses are applied once per frame
+	- touching pairs whose relative transform is unchanged reuse their contacts instead of running the narrow phase
+*/
+
+class ContactCache {
+public:
+	// pairs touching (keyed by both body ids)
+	std::unordered_map<unsigned long long, ContactPair> pairs;
+
+	// pairs in the order they were first found this frame
+	std::vector<unsigned long long> frameOrder;
+
+	// current frame
+	unsigned int frame = 1;
+
+	// function called for each event (nullptr = no events)
+	void(*callback)(ContactEvent event, ContactPair& pair) = nullptr;
+
+	/*
+		functionality
+	*/
+
+	// get cached contact if pair is touching and has not moved relative to itself (read only)
+	bool getCached(BoundingRegion& br, BoundingRegion& obj, Contact& contact);
+
+	// add contact found this frame
+	void add(Contact& contact);
+
+	// emit events and apply collision responses (called once per frame after the broad phase)
+	void endFrame(float time);
+
+	// remove all pairs
+	void clear();
+
+	// get key of pair
+	static unsigned long long pairKey(RigidBody* rb1, RigidBody* rb2);
+
+	// get transform of second body in the first body's frame
+	static glm::mat4 relativeTransform(RigidBody* a, RigidBody* b);
+};
+
+#endif // !CONTACTCACHE_H
@@ -0,0 +1,697 @@
+#include "gjk.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "collisionmesh.h"
+
+// maximum number of points and faces of the polytope of the penetration solver
+#define EPA_MAX_POINTS (4 + EPA_MAX_ITERATIONS)
+#define EPA_MAX_FACES (2 * EPA_MAX_POINTS)
+
+/*
+	structures used by the queries
+*/
+
+// point of the difference of the shapes with the points on both shapes it came from
+typedef struct SupportPoint {
+	glm::vec3 w;
+	glm::vec3 a;
+	glm::vec3 b;
+} SupportPoint;
+
+// up to 4 support points with the weights of the point closest to the origin
+typedef struct Simplex {
+	SupportPoint p[4];
+	float bary[4];
+	int n;
+} Simplex;
+
+// face of the polytope (outward normal, distance from the origin)
+typedef struct PolytopeFace {
+	int v[3];
+	glm::vec3 norm;
+	float distance;
+} PolytopeFace;
+
+/*
+	support functions
+*/
+
+// furthest point of the core of shape in direction dir
+static glm::vec3 coreSupport(ConvexShape& shape, glm::vec3 dir) {
+	switch (shape.type) {
+	case ConvexTypes::CAPSULE:
+		return glm::dot(shape.end - shape.center, dir) > 0.0f ? shape.end : shape.center;
+	case ConvexTypes::BOX: {
+		glm::vec3 ret = shape.center;
+		for (int i = 0; i < 3; i++) {
+			ret += shape.axes[i] * (glm::dot(shape.axes[i], dir) >= 0.0f ? shape.halfSize[i] : -shape.halfSize[i]);
+		}
+		return ret;
+	}
+	case ConvexTypes::HULL: {
+		// furthest point in local space (direction goes through the transpose)
+		glm::vec3 localDir = glm::transpose(glm::mat3(shape.transform)) * dir;
+		glm::vec3 best = (*shape.points)[0];
+		float bestDot = glm::dot(best, localDir);
+		for (glm::vec3& p : *shape.points) {
+			float d = glm::dot(p, localDir);
+			if (d > bestDot) {
+				bestDot = d;
+				best = p;
+			}
+		}
+		return glm::vec3(shape.transform * glm::vec4(best, 1.0f));
+	}
+	default:
+		return shape.center;
+	}
+}
+
+// point of the difference a - b furthest in direction dir (of the cores or the full shapes)
+static SupportPoint difference(ConvexShape& a, ConvexShape& b, glm::vec3 dir, bool full) {
+	SupportPoint ret;
+	if (full) {
+		ret.a = GJK::support(a, dir);
+		ret.b = GJK::support(b, -dir);
+	}
+	else {
+		ret.a = coreSupport(a, dir);
+		ret.b = coreSupport(b, -dir);
+	}
+	ret.w = ret.a - ret.b;
+	return ret;
+}
+
+/*
+	closest point of a simplex to the origin
+	- the simplex is reduced to the smallest part containing the closest point
+*/
+
+static glm::vec3 closestOnSegment(Simplex& s) {
+	glm::vec3 a = s.p[0].w;
+	glm::vec3 ab = s.p[1].w - a;
+
+	float denom = glm::dot(ab, ab);
+	float t = denom > 0.0f ? -glm::dot(a, ab) / denom : 0.0f;
+	if (t <= 0.0f) {
+		s.n = 1;
+		s.bary[0] = 1.0f;
+		return a;
+	}
+	if (t >= 1.0f) {
+		s.p[0] = s.p[1];
+		s.n = 1;
+		s.bary[0] = 1.0f;
+		return s.p[0].w;
+	}
+
+	s.bary[0] = 1.0f - t;
+	s.bary[1] = t;
+	return a + t * ab;
+}
+
+static glm::vec3 closestOnTriangle(Simplex& s) {
+	SupportPoint A = s.p[0], B = s.p[1], C = s.p[2];
+	glm::vec3 a = A.w, b = B.w, c = C.w;
+	glm::vec3 ab = b - a;
+	glm::vec3 ac = c - a;
+
+	// vertex regions and edge regions (Ericson, closest point on triangle)
+	float d1 = -glm::dot(ab, a);
+	float d2 = -glm::dot(ac, a);
+	if (d1 <= 0.0f && d2 <= 0.0f) {
+		s.n = 1;
+		s.bary[0] = 1.0f;
+		return a;
+	}
+
+	float d3 = -glm::dot(ab, b);
+	float d4 = -glm::dot(ac, b);
+	if (d3 >= 0.0f && d4 <= d3) {
+		s.p[0] = B;
+		s.n = 1;
+		s.bary[0] = 1.0f;
+		return b;
+	}
+
+	float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+		float v = d1 / (d1 - d3);
+		s.n = 2;
+		s.bary[0] = 1.0f - v;
+		s.bary[1] = v;
+		return a + v * ab;
+	}
+
+	float d5 = -glm::dot(ab, c);
+	float d6 = -glm::dot(ac, c);
+	if (d6 >= 0.0f && d5 <= d6) {
+		s.p[0] = C;
+		s.n = 1;
+		s.bary[0] = 1.0f;
+		return c;
+	}
+
+	float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+		float w = d2 / (d2 - d6);
+		s.p[1] = C;
+		s.n = 2;
+		s.bary[0] = 1.0f - w;
+		s.bary[1] = w;
+		return a + w * ac;
+	}
+
+	float va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+		float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		s.p[0] = B;
+		s.p[1] = C;
+		s.n = 2;
+		s.bary[0] = 1.0f - w;
+		s.bary[1] = w;
+		return b + w * (c - b);
+	}
+
+	float sum = va + vb + vc;
+	if (sum <= 0.0f) {
+		// degenerate triangle, closest of its edges
+		Simplex edges[3] = { s, s, s };
+		edges[1].p[1] = C;
+		edges[2].p[0] = B;
+		edges[2].p[1] = C;
+
+		float best = std::numeric_limits<float>::max();
+		glm::vec3 ret(0.0f);
+		for (Simplex& e : edges) {
+			e.n = 2;
+			glm::vec3 p = closestOnSegment(e);
+			if (glm::dot(p, p) < best) {
+				best = glm::dot(p, p);
+				ret = p;
+				s = e;
+			}
+		}
+		return ret;
+	}
+
+	// inside face
+	float v = vb / sum;
+	float w = vc / sum;
+	s.bary[0] = 1.0f - v - w;
+	s.bary[1] = v;
+	s.bary[2] = w;
+	return a + v * ab + w * ac;
+}
+
+static glm::vec3 closestOnTetrahedron(Simplex& s) {
+	// faces with the point opposite to them
+	static const int faces[4][4] = {
+		{ 0, 1, 2, 3 },
+		{ 0, 3, 1, 2 },
+		{ 0, 2, 3, 1 },
+		{ 1, 3, 2, 0 }
+	};
+
+	// nearly flat tetrahedra cannot tell the sides of their faces apart, so the closest face is taken
+	glm::vec3 ab = s.p[1].w - s.p[0].w, ac = s.p[2].w - s.p[0].w, ad = s.p[3].w - s.p[0].w;
+	float volume = glm::dot(ab, glm::cross(ac, ad));
+	bool flat = std::abs(volume) <= GJK_TOLERANCE * glm::length(ab) * glm::length(ac) * glm::length(ad);
+
+	bool inside = !flat;
+	float best = std::numeric_limits<float>::max();
+	glm::vec3 ret(0.0f);
+	Simplex closest = s;
+
+	for (int i = 0; i < 4; i++) {
+		glm::vec3 a = s.p[faces[i][0]].w;
+		glm::vec3 n = glm::cross(s.p[faces[i][1]].w - a, s.p[faces[i][2]].w - a);
+		float signOrigin = -glm::dot(a, n);
+		float signOpposite = glm::dot(s.p[faces[i][3]].w - a, n);
+
+		if (flat || signOrigin * signOpposite < 0.0f) {
+			// origin is outside of face (or the tetrahedron is flat)
+			inside = false;
+
+			Simplex face;
+			face.p[0] = s.p[faces[i][0]];
+			face.p[1] = s.p[faces[i][1]];
+			face.p[2] = s.p[faces[i][2]];
+			face.n = 3;
+			glm::vec3 p = closestOnTriangle(face);
+			if (glm::dot(p, p) < best) {
+				best = glm::dot(p, p);
+				ret = p;
+				closest = face;
+			}
+		}
+	}
+
+	if (inside) {
+		// weights from the volumes opposite to each point
+		glm::vec3 a = s.p[0].w, b = s.p[1].w, c = s.p[2].w, d = s.p[3].w;
+		s.bary[0] = glm::dot(b, glm::cross(c, d)) / volume;
+		s.bary[1] = -glm::dot(a, glm::cross(c, d)) / volume;
+		s.bary[2] = glm::dot(a, glm::cross(b, d)) / volume;
+		s.bary[3] = 1.0f - s.bary[0] - s.bary[1] - s.bary[2];
+		return glm::vec3(0.0f);
+	}
+
+	s = closest;
+	return ret;
+}
+
+static glm::vec3 closestOnSimplex(Simplex& s) {
+	switch (s.n) {
+	case 2:
+		return closestOnSegment(s);
+	case 3:
+		return closestOnTriangle(s);
+	case 4:
+		return closestOnTetrahedron(s);
+	default:
+		s.bary[0] = 1.0f;
+		return s.p[0].w;
+	}
+}
+
+// points on both shapes making up the closest point of the simplex
+static void witnessPoints(Simplex& s, glm::vec3& pointA, glm::vec3& pointB) {
+	pointA = glm::vec3(0.0f);
+	pointB = glm::vec3(0.0f);
+	for (int i = 0; i < s.n; i++) {
+		pointA += s.bary[i] * s.p[i].a;
+		pointB += s.bary[i] * s.p[i].b;
+	}
+}
+
+/*
+	distance query (GJK)
+*/
+
+// closest point v of the difference of the cores to the origin, returns if the cores overlap
+// stops early once the cores are known to be further apart than margin (negative = never)
+static bool closestCores(ConvexShape& a, ConvexShape& b, Simplex& s, glm::vec3& v, float margin) {
+	glm::vec3 dir = a.center - b.center;
+	if (glm::dot(dir, dir) == 0.0f) {
+		dir = glm::vec3(1.0f, 0.0f, 0.0f);
+	}
+
+	s.p[0] = difference(a, b, dir, false);
+	s.bary[0] = 1.0f;
+	s.n = 1;
+	v = s.p[0].w;
+
+	for (int i = 0; i < GJK_MAX_ITERATIONS; i++) {
+		float vv = glm::dot(v, v);
+		float maxW = 0.0f;
+		for (int j = 0; j < s.n; j++) {
+			maxW = std::max(maxW, glm::dot(s.p[j].w, s.p[j].w));
+		}
+		if (vv <= GJK_TOLERANCE * GJK_TOLERANCE * maxW) {
+			// origin on the simplex
+			return true;
+		}
+
+		SupportPoint w = difference(a, b, -v, false);
+		float vw = glm::dot(v, w.w);
+		if (margin >= 0.0f && vw > 0.0f && vw * vw > vv * margin * margin) {
+			// separating plane further than margin
+			return false;
+		}
+		if (vv - vw <= GJK_TOLERANCE * vv) {
+			// no more progress
+			return false;
+		}
+		for (int j = 0; j < s.n; j++) {
+			if (s.p[j].w == w.w) {
+				// point already in simplex
+				return false;
+			}
+		}
+
+		Simplex prev = s;
+		s.p[s.n++] = w;
+		glm::vec3 next = closestOnSimplex(s);
+		if (s.n == 4) {
+			// origin inside tetrahedron
+			v = next;
+			return true;
+		}
+		if (glm::dot(next, next) >= vv) {
+			// rounding, keep last simplex
+			s = prev;
+			return false;
+		}
+		v = next;
+	}
+
+	return false;
+}
+
+/*
+	penetration solver (EPA)
+*/
+
+// set face ijk of the polytope
+static void setFace(SupportPoint* points, int i, int j, int k, PolytopeFace& face) {
+	face.v[0] = i;
+	face.v[1] = j;
+	face.v[2] = k;
+
+	glm::vec3 n = glm::cross(points[j].w - points[i].w, points[k].w - points[i].w);
+	float len = glm::length(n);
+	if (len > 0.0f) {
+		face.norm = n / len;
+		face.distance = glm::dot(face.norm, points[i].w);
+	}
+	else {
+		// degenerate face, never the closest
+		face.norm = glm::vec3(0.0f);
+		face.distance = std::numeric_limits<float>::max();
+	}
+}
+
+// grow simplex containing the origin to a tetrahedron, returns false if the shapes are flat
+static bool growToTetrahedron(ConvexShape& a, ConvexShape& b, SupportPoint* points, int& noPoints) {
+	static const glm::vec3 axes[6] = {
+		glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+		glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+		glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)
+	};
+
+	if (noPoints == 1) {
+		// second point away from the first
+		for (const glm::vec3& dir : axes) {
+			SupportPoint w = difference(a, b, dir, true);
+			glm::vec3 d = w.w - points[0].w;
+			if (glm::dot(d, d) > EPA_TOLERANCE * EPA_TOLERANCE) {
+				points[noPoints++] = w;
+				break;
+			}
+		}
+	}
+
+	if (noPoints == 2) {
+		// third point off the line, searched around it
+		glm::vec3 d = points[1].w - points[0].w;
+		glm::vec3 ad = glm::abs(d);
+		glm::vec3 axis = ad.x <= ad.y && ad.x <= ad.z ? axes[0] : (ad.y <= ad.z ? axes[2] : axes[4]);
+		glm::vec3 e1 = glm::cross(d, axis);
+		glm::vec3 e2 = glm::cross(d, e1);
+		glm::vec3 dirs[4] = { e1, e2, -e1, -e2 };
+
+		for (glm::vec3& dir : dirs) {
+			SupportPoint w = difference(a, b, dir, true);
+			glm::vec3 off = glm::cross(w.w - points[0].w, d);
+			if (glm::dot(off, off) > EPA_TOLERANCE * EPA_TOLERANCE * glm::dot(d, d)) {
+				points[noPoints++] = w;
+				break;
+			}
+		}
+	}
+
+	if (noPoints == 3) {
+		// fourth point off the plane, on either side
+		glm::vec3 n = glm::cross(points[1].w - points[0].w, points[2].w - points[0].w);
+		float tolerance = EPA_TOLERANCE * glm::length(n);
+
+		SupportPoint w = difference(a, b, n, true);
+		if (std::abs(glm::dot(w.w - points[0].w, n)) <= tolerance) {
+			w = difference(a, b, -n, true);
+		}
+		if (std::abs(glm::dot(w.w - points[0].w, n)) > tolerance) {
+			points[noPoints++] = w;
+		}
+	}
+
+	return noPoints == 4;
+}
+
+// deepest penetration of shapes whose cores overlap, starting from the simplex of the distance query
+static bool penetration(ConvexShape& a, ConvexShape& b, Simplex& s, ConvexContact& contact) {
+	SupportPoint points[EPA_MAX_POINTS];
+	int noPoints = s.n;
+	for (int i = 0; i < s.n; i++) {
+		points[i] = s.p[i];
+	}
+
+	if (!growToTetrahedron(a, b, points, noPoints)) {
+		return false;
+	}
+
+	// faces of the tetrahedron point away from the opposite point
+	if (glm::dot(glm::cross(points[1].w - points[0].w, points[2].w - points[0].w), points[3].w - points[0].w) > 0.0f) {
+		std::swap(points[1], points[2]);
+	}
+
+	PolytopeFace faces[EPA_MAX_FACES];
+	int noFaces = 4;
+	setFace(points, 0, 1, 2, faces[0]);
+	setFace(points, 0, 3, 1, faces[1]);
+	setFace(points, 0, 2, 3, faces[2]);
+	setFace(points, 1, 3, 2, faces[3]);
+
+	// edges on the border of the faces removed in an iteration
+	int edges[3 * EPA_MAX_FACES][2];
+
+	int closest = 0;
+	for (int i = 0; i < EPA_MAX_ITERATIONS; i++) {
+		// face closest to origin
+		closest = 0;
+		for (int j = 1; j < noFaces; j++) {
+			if (faces[j].distance < faces[closest].distance) {
+				closest = j;
+			}
+		}
+
+		PolytopeFace& face = faces[closest];
+		SupportPoint w = difference(a, b, face.norm, true);
+		if (glm::dot(w.w, face.norm) - face.distance < EPA_TOLERANCE || noPoints == EPA_MAX_POINTS) {
+			// face is on the surface of the difference
+			break;
+		}
+
+		// remove faces seen from the new point (or with it on their plane), keep the edges around them
+		int noEdges = 0;
+		for (int j = 0; j < noFaces;) {
+			if (glm::dot(faces[j].norm, w.w - points[faces[j].v[0]].w) <= -EPA_TOLERANCE) {
+				j++;
+				continue;
+			}
+
+			for (int k = 0; k < 3; k++) {
+				int e0 = faces[j].v[k];
+				int e1 = faces[j].v[(k + 1) % 3];
+
+				// edge shared with another removed face is inside
+				bool shared = false;
+				for (int l = 0; l < noEdges; l++) {
+					if (edges[l][0] == e1 && edges[l][1] == e0) {
+						edges[l][0] = edges[noEdges - 1][0];
+						edges[l][1] = edges[noEdges - 1][1];
+						noEdges--;
+						shared = true;
+						break;
+					}
+				}
+				if (!shared) {
+					edges[noEdges][0] = e0;
+					edges[noEdges][1] = e1;
+					noEdges++;
+				}
+			}
+			faces[j] = faces[--noFaces];
+		}
+
+		if (noEdges == 0 || noFaces + noEdges > EPA_MAX_FACES) {
+			// rounding, polytope cannot grow
+			closest = -1;
+			break;
+		}
+
+		// connect edges to the new point
+		points[noPoints] = w;
+		for (int j = 0; j < noEdges; j++) {
+			setFace(points, edges[j][0], edges[j][1], noPoints, faces[noFaces++]);
+		}
+		noPoints++;
+	}
+
+	if (closest < 0) {
+		// use the closest face left
+		closest = 0;
+		for (int j = 1; j < noFaces; j++) {
+			if (faces[j].distance < faces[closest].distance) {
+				closest = j;
+			}
+		}
+	}
+	PolytopeFace& face = faces[closest];
+	if (noFaces == 0 || face.distance == std::numeric_limits<float>::max()) {
+		return false;
+	}
+
+	// weights of the point of the face closest to the origin
+	SupportPoint& A = points[face.v[0]];
+	SupportPoint& B = points[face.v[1]];
+	SupportPoint& C = points[face.v[2]];
+	glm::vec3 v0 = B.w - A.w;
+	glm::vec3 v1 = C.w - A.w;
+	glm::vec3 v2 = face.distance * face.norm - A.w;
+	float d00 = glm::dot(v0, v0);
+	float d01 = glm::dot(v0, v1);
+	float d11 = glm::dot(v1, v1);
+	float d20 = glm::dot(v2, v0);
+	float d21 = glm::dot(v2, v1);
+	float denom = d00 * d11 - d01 * d01;
+	float v = denom != 0.0f ? (d11 * d20 - d01 * d21) / denom : 0.0f;
+	float w = denom != 0.0f ? (d00 * d21 - d01 * d20) / denom : 0.0f;
+	float u = 1.0f - v - w;
+
+	// moving a back along the face normal separates the shapes
+	contact.norm = -face.norm;
+	contact.depth = face.distance;
+	contact.pointA = u * A.a + v * B.a + w * C.a;
+	contact.pointB = u * A.b + v * B.b + w * C.b;
+	return true;
+}
+
+/*
+	shapes
+*/
+
+// sphere
+ConvexShape GJK::sphere(glm::vec3 center, float radius) {
+	ConvexShape ret = {};
+	ret.type = ConvexTypes::SPHERE;
+	ret.center = center;
+	ret.radius = radius;
+	return ret;
+}
+
+// axis aligned box
+ConvexShape GJK::box(glm::vec3 min, glm::vec3 max) {
+	ConvexShape ret = {};
+	ret.type = ConvexTypes::BOX;
+	ret.center = 0.5f * (min + max);
+	ret.axes = glm::mat3(1.0f);
+	ret.halfSize = 0.5f * (max - min);
+	return ret;
+}
+
+// box with its own axes
+ConvexShape GJK::box(glm::vec3 center, glm::mat3 axes, glm::vec3 halfSize) {
+	ConvexShape ret = {};
+	ret.type = ConvexTypes::BOX;
+	ret.center = center;
+	ret.axes = axes;
+	ret.halfSize = halfSize;
+	return ret;
+}
+
+// convex hull of the points of mesh transformed by instance
+ConvexShape GJK::hull(CollisionMesh* mesh, RigidBody* instance) {
+	ConvexShape ret = {};
+	ret.type = ConvexTypes::HULL;
+	ret.center = instance->getPos();
+	ret.points = &mesh->points;
+	ret.transform = instance->getModel();
+	return ret;
+}
+
+// capsule around segment ab
+ConvexShape GJK::capsule(glm::vec3 a, glm::vec3 b, float radius) {
+	ConvexShape ret = {};
+	ret.type = ConvexTypes::CAPSULE;
+	ret.center = a;
+	ret.end = b;
+	ret.radius = radius;
+	return ret;
+}
+
+// shape of region (hull of its collision mesh if it is convex)
+ConvexShape GJK::region(BoundingRegion& br) {
+	if (br.collisionMesh && br.collisionMesh->convex && br.instance) {
+		return hull(br.collisionMesh, br.instance);
+	}
+	if (br.type == BoundTypes::SPHERE) {
+		return sphere(br.center, br.radius);
+	}
+	if (br.type == BoundTypes::OBB) {
+		return box(br.center, br.axes, br.halfSize);
+	}
+	return box(br.min, br.max);
+}
+
+// furthest point of shape in direction dir
+glm::vec3 GJK::support(ConvexShape& shape, glm::vec3 dir) {
+	glm::vec3 ret = coreSupport(shape, dir);
+	float len = glm::length(dir);
+	if (shape.radius > 0.0f && len > 0.0f) {
+		ret += (shape.radius / len) * dir;
+	}
+	return ret;
+}
+
+/*
+	queries
+*/
+
+// distance between two shapes with the closest points (0 if they overlap)
+float GJK::distance(ConvexShape& a, ConvexShape& b, glm::vec3& pointA, glm::vec3& pointB) {
+	Simplex s;
+	glm::vec3 v;
+	bool overlap = closestCores(a, b, s, v, -1.0f);
+	witnessPoints(s, pointA, pointB);
+	if (overlap) {
+		return 0.0f;
+	}
+
+	// move closest points of the cores out to the surfaces
+	float dist = glm::length(v);
+	float margin = a.radius + b.radius;
+	if (dist > 0.0f) {
+		glm::vec3 n = v / dist;
+		pointA -= a.radius * n;
+		pointB += b.radius * n;
+	}
+
+	return std::max(dist - margin, 0.0f);
+}
+
+// if shapes touch, fill contact with the normal, depth and witness points
+bool GJK::collide(ConvexShape& a, ConvexShape& b, ConvexContact& contact) {
+	Simplex s;
+	glm::vec3 v;
+	float margin = a.radius + b.radius;
+
+	if (!closestCores(a, b, s, v, margin)) {
+		float dist = glm::length(v);
+		if (dist > margin) {
+			return false;
+		}
+
+		if (dist > GJK_TOLERANCE * margin) {
+			// cores apart, shapes only overlap by their radii
+			witnessPoints(s, contact.pointA, contact.pointB);
+			contact.norm = v / dist;
+			contact.depth = margin - dist;
+			contact.pointA -= a.radius * contact.norm;
+			contact.pointB += b.radius * contact.norm;
+			return true;
+		}
+	}
+
+	if (!penetration(a, b, s, contact)) {
+		// flat difference, touching without depth
+		glm::vec3 d = a.center - b.center;
+		contact.norm = glm::dot(d, d) > 0.0f ? glm::normalize(d) : glm::vec3(0.0f, 1.0f, 0.0f);
+		contact.depth = 0.0f;
+		witnessPoints(s, contact.pointA, contact.pointB);
+	}
+	return true;
+}
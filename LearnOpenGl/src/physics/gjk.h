@@ -0,0 +1,116 @@
+#ifndef GJK_H
+#define GJK_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "../algorithms/bounds.h"
+
+#include "rigidbody.h"
+
+// maximum iterations of the distance query
+#define GJK_MAX_ITERATIONS 32
+// relative tolerance the distance query converges at
+#define GJK_TOLERANCE 1e-6f
+// maximum iterations of the penetration solver
+#define EPA_MAX_ITERATIONS 64
+// distance the penetration solver converges at
+#define EPA_TOLERANCE 1e-4f
+
+// forward declaration
+class CollisionMesh;
+
+/*
+	enum for the shapes the convex tests support
+*/
+
+enum class ConvexTypes : unsigned char {
+	SPHERE = 0x00,	// point with a radius
+	BOX = 0x01,		// box with its own axes
+	HULL = 0x02,	// convex hull of the points of a collision mesh
+	CAPSULE = 0x03	// segment with a radius
+};
+
+/*
+	structure representing a convex shape in world space
+	- every shape is a core (point, segment, box or hull) grown by radius, the distance query runs on the cores
+*/
+
+typedef struct ConvexShape {
+	ConvexTypes type;
+
+	// center (sphere, box) or first end of the segment (capsule)
+	glm::vec3 center;
+	// second end of the segment (capsule)
+	glm::vec3 end;
+	// radius around the core (sphere, capsule)
+	float radius;
+
+	// axes and half of the size along them (box)
+	glm::mat3 axes;
+	glm::vec3 halfSize;
+
+	// points in local space and transform to world space (hull)
+	std::vector<glm::vec3>* points;
+	glm::mat4 transform;
+} ConvexShape;
+
+/*
+	structure representing the closest points or the deepest penetration of two shapes
+*/
+
+typedef struct ConvexContact {
+	// normal pointing from the second shape towards the first
+	glm::vec3 norm;
+	// penetration depth along the normal (negative = distance between the shapes)
+	float depth;
+
+	// witness points on the surface of each shape
+	glm::vec3 pointA;
+	glm::vec3 pointB;
+} ConvexContact;
+
+/*
+	namespace to tie together the convex tests
+	- distance query (GJK) on the cores of the shapes, penetration solver (EPA) once the cores overlap
+*/
+
+namespace GJK {
+	/*
+		shapes
+	*/
+
+	// sphere
+	ConvexShape sphere(glm::vec3 center, float radius);
+
+	// axis aligned box
+	ConvexShape box(glm::vec3 min, glm::vec3 max);
+
+	// box with its own axes
+	ConvexShape box(glm::vec3 center, glm::mat3 axes, glm::vec3 halfSize);
+
+	// convex hull of the points of mesh transformed by instance
+	ConvexShape hull(CollisionMesh* mesh, RigidBody* instance);
+
+	// capsule around segment ab
+	ConvexShape capsule(glm::vec3 a, glm::vec3 b, float radius);
+
+	// shape of region (hull of its collision mesh if it is convex)
+	ConvexShape region(BoundingRegion& br);
+
+	// furthest point of shape in direction dir
+	glm::vec3 support(ConvexShape& shape, glm::vec3 dir);
+
+	/*
+		queries
+	*/
+
+	// distance between two shapes with the closest points (0 if they overlap)
+	float distance(ConvexShape& a, ConvexShape& b, glm::vec3& pointA, glm::vec3& pointB);
+
+	// if shapes touch, fill contact with the normal, depth and witness points
+	bool collide(ConvexShape& a, ConvexShape& b, ConvexContact& contact);
+}
+
+#endif // !GJK_H
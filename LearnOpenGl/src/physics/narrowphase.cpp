@@ -0,0 +1,293 @@
+#include "narrowphase.h"
+#include "collisionlog.h"
+#include "collisionmesh.h"
+#include "contactcache.h"
+#include "gjk.h"
+
+#include "../algorithms/collisionstats.h"
+
+#include <cmath>
+
+// cache contacts are added to (nullptr = respond immediately)
+ContactCache* NarrowPhase::cache = nullptr;
+// log responded contacts are recorded in (nullptr = not recorded)
+CollisionLog* NarrowPhase::events = nullptr;
+
+// test two convex regions (shapes, or hulls of convex collision meshes), type is the test case
+static bool testConvex(BoundingRegion& br, BoundingRegion& obj, unsigned char type, Contact& contact) {
+	ConvexShape brShape = GJK::region(br);
+	ConvexShape objShape = GJK::region(obj);
+	ConvexContact c;
+
+	if (type == 4 && !(br.type != BoundTypes::SPHERE && obj.type == BoundTypes::SPHERE)) {
+		// br responds (the sphere responds to a box)
+		if (!GJK::collide(brShape, objShape, c)) {
+			return false;
+		}
+		contact = { type, br.instance, obj.instance, c.norm, 0.5f * (c.pointA + c.pointB), c.depth };
+	}
+	else {
+		// obj responds (same as the face tests and sphere against box)
+		if (!GJK::collide(objShape, brShape, c)) {
+			return false;
+		}
+		contact = { type, obj.instance, br.instance, c.norm, 0.5f * (c.pointA + c.pointB), c.depth };
+	}
+	return true;
+}
+
+// test sphere against the faces of the collision mesh of region near it, fill the deepest contact (normal points towards the sphere)
+static bool testMeshSphere(BoundingRegion& br, BoundingRegion& sphere, glm::vec3& norm, glm::vec3& point, float& depth, unsigned int& noFaceTests) {
+	WorldMesh& worldMesh = br.collisionMesh->getWorldMesh(br.instance);
+	bool hit = false;
+	unsigned int index = 0;
+	float distance = sphere.radius;
+
+	// deepest face of each run of leaves near the sphere
+	br.collisionMesh->queryBoxRanges(br.instance, sphere.center - sphere.radius, sphere.center + sphere.radius, [&](unsigned int first, unsigned int count) -> bool {
+		noFaceTests += count;
+		unsigned int i;
+		float d;
+		if (worldMesh.faces.collidesWithSphere(first, count, sphere.center, sphere.radius, i, d) && (!hit || d < distance)) {
+			hit = true;
+			index = i;
+			distance = d;
+		}
+		return false;
+	});
+	if (!hit) {
+		return false;
+	}
+
+	point = worldMesh.faces.closestPoint(index, sphere.center);
+	if (distance > 0.0f) {
+		norm = (sphere.center - point) / distance;
+	}
+	else {
+		// center on the face
+		norm = glm::vec3(worldMesh.faces.nx[index], worldMesh.faces.ny[index], worldMesh.faces.nz[index]);
+	}
+	depth = sphere.radius - distance;
+	return true;
+}
+
+// separating axis test of a face (corners in world space) against a box, fill the axis of least overlap (normal points towards the box)
+// axes are the 3 box axes, the normal of the face and the cross products of the box axes with the 3 edges
+static bool testFaceBox(glm::vec3* corners, glm::vec3 center, glm::mat3& axes, glm::vec3 halfSize, glm::vec3& norm, glm::vec3& point, float& depth) {
+	// corners and edges in the frame of the box
+	glm::vec3 v[3];
+	for (int i = 0; i < 3; i++) {
+		glm::vec3 d = corners[i] - center;
+		v[i] = glm::vec3(glm::dot(d, axes[0]), glm::dot(d, axes[1]), glm::dot(d, axes[2]));
+	}
+	glm::vec3 e[3] = { v[1] - v[0], v[2] - v[1], v[0] - v[2] };
+
+	glm::vec3 candidates[13];
+	for (int i = 0; i < 3; i++) {
+		candidates[i] = glm::vec3(0.0f);
+		candidates[i][i] = 1.0f;
+	}
+	candidates[3] = glm::cross(e[0], e[1]);
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			candidates[4 + 3 * i + j] = glm::cross(candidates[i], e[j]);
+		}
+	}
+
+	int best = -1;
+	glm::vec3 bestAxis;
+	depth = 0.0f;
+	for (int i = 0; i < 13; i++) {
+		glm::vec3 L = candidates[i];
+		float length = glm::length(L);
+		if (length < 1e-6f) {
+			// edge parallel to a box axis, covered by the other axes
+			continue;
+		}
+
+		// intervals of the face and the box along the axis
+		float p0 = glm::dot(v[0], L), p1 = glm::dot(v[1], L), p2 = glm::dot(v[2], L);
+		float tmin = std::fminf(p0, std::fminf(p1, p2));
+		float tmax = std::fmaxf(p0, std::fmaxf(p1, p2));
+		float r = glm::dot(halfSize, glm::abs(L));
+		if (tmin > r || tmax < -r) {
+			return false;
+		}
+
+		// box pushed out above the face (along L) or below it
+		float above = (tmax + r) / length;
+		float below = (r - tmin) / length;
+		float overlap = std::fminf(above, below);
+		if (best == -1 || overlap < depth) {
+			best = i;
+			depth = overlap;
+			bestAxis = (above <= below ? L : -L) / length;
+		}
+	}
+
+	// approximate point between the deepest features
+	glm::vec3 local;
+	if (best < 3) {
+		// corner of the face in a side of the box
+		int deepest = 0;
+		for (int i = 1; i < 3; i++) {
+			if (glm::dot(v[i], bestAxis) > glm::dot(v[deepest], bestAxis)) {
+				deepest = i;
+			}
+		}
+		local = v[deepest] - 0.5f * depth * bestAxis;
+	}
+	else {
+		// corner of the box through the face or an edge
+		glm::vec3 corner = glm::vec3(
+			bestAxis.x > 0.0f ? -halfSize.x : halfSize.x,
+			bestAxis.y > 0.0f ? -halfSize.y : halfSize.y,
+			bestAxis.z > 0.0f ? -halfSize.z : halfSize.z
+		);
+		local = corner + 0.5f * depth * bestAxis;
+	}
+
+	norm = axes * bestAxis;
+	point = center + axes * local;
+	return true;
+}
+
+// test box (AABB or OBB) against the faces of the collision mesh of region near it with the separating axis test, fill the deepest contact (normal points towards the box)
+static bool testMeshBox(BoundingRegion& br, BoundingRegion& box, glm::vec3& norm, glm::vec3& point, float& depth, unsigned int& noFaceTests) {
+	WorldMesh& worldMesh = br.collisionMesh->getWorldMesh(br.instance);
+	ConvexShape boxShape = GJK::region(box);
+	glm::vec3 extents = glm::abs(boxShape.axes[0]) * boxShape.halfSize.x
+		+ glm::abs(boxShape.axes[1]) * boxShape.halfSize.y
+		+ glm::abs(boxShape.axes[2]) * boxShape.halfSize.z;
+
+	bool hit = false;
+	depth = 0.0f;
+
+	// deepest face of the runs of leaves near the box
+	br.collisionMesh->queryBoxRanges(br.instance, boxShape.center - extents, boxShape.center + extents, [&](unsigned int first, unsigned int count) -> bool {
+		noFaceTests += count;
+		TriangleArrays& faces = worldMesh.faces;
+		for (unsigned int i = first; i < first + count; i++) {
+			if (faces.nx[i] == 0.0f && faces.ny[i] == 0.0f && faces.nz[i] == 0.0f) {
+				// degenerate
+				continue;
+			}
+
+			glm::vec3 corners[3];
+			corners[0] = glm::vec3(faces.px[i], faces.py[i], faces.pz[i]);
+			corners[1] = corners[0] + glm::vec3(faces.ax[i], faces.ay[i], faces.az[i]);
+			corners[2] = corners[0] + glm::vec3(faces.bx[i], faces.by[i], faces.bz[i]);
+
+			glm::vec3 n, p;
+			float d;
+			if (testFaceBox(corners, boxShape.center, boxShape.axes, boxShape.halfSize, n, p, d) && (!hit || d > depth)) {
+				hit = true;
+				norm = n;
+				point = p;
+				depth = d;
+			}
+		}
+		return false;
+	});
+
+	return hit;
+}
+
+// test region (sphere or box) against the faces of the collision mesh of br near it, fill the deepest contact (normal points towards the region)
+static bool testMeshRegion(BoundingRegion& br, BoundingRegion& obj, glm::vec3& norm, glm::vec3& point, float& depth, unsigned int& noFaceTests) {
+	return obj.type == BoundTypes::SPHERE
+		? testMeshSphere(br, obj, norm, point, depth, noFaceTests)
+		: testMeshBox(br, obj, norm, point, depth, noFaceTests);
+}
+
+// test two regions that passed the coarse check, fill contact if they collide
+bool NarrowPhase::test(BoundingRegion& br, BoundingRegion& obj, Contact& contact) {
+	Stats::add(Stats::PAIR_TESTS);
+
+	if (cache && cache->getCached(br, obj, contact)) {
+		// pair still touching the same way
+		return true;
+	}
+
+	unsigned int noFacesBr = br.collisionMesh ? (unsigned int)br.collisionMesh->faces.size() : 0;
+	unsigned int noFacesObj = obj.collisionMesh ? (unsigned int)obj.collisionMesh->faces.size() : 0;
+
+	if ((!noFacesBr || br.collisionMesh->convex) && (!noFacesObj || obj.collisionMesh->convex)) {
+		// both convex (spheres, boxes or convex meshes), no face tests needed
+		unsigned char type = noFacesBr ? (noFacesObj ? 1 : 2) : (noFacesObj ? 3 : 4);
+		return testConvex(br, obj, type, contact);
+	}
+
+	glm::vec3 norm;
+	// face tests done, added to the counter once the test ends
+	unsigned int noFaceTests = 0;
+
+	if (noFacesBr && noFacesObj) {
+		// both have collision mesh, at least one is not convex
+		// check faces in br againts faces in obj where the trees of both meshes overlap (in local space of br)
+		WorldMesh& brMesh = br.collisionMesh->getWorldMesh(br.instance);
+		WorldMesh& objMesh = obj.collisionMesh->getWorldMesh(obj.instance);
+		glm::mat4 objToBr = glm::inverse(br.instance->getModel()) * obj.instance->getModel();
+		bool hit = false;
+		br.collisionMesh->bvh.queryTree(obj.collisionMesh->bvh, objToBr, [&](unsigned int i, unsigned int j) -> bool {
+			noFaceTests++;
+			hit = br.collisionMesh->faces[i].collidesWithFace(
+				brMesh,
+				obj.collisionMesh->faces[j],
+				objMesh,
+				norm
+			);
+			return hit;
+		});
+		if (hit) {
+			contact = { 1, obj.instance, br.instance, norm, 0.5f * (br.instance->getPos() + obj.instance->getPos()), 0.0f };
+			Stats::add(Stats::FACE_TESTS, noFaceTests);
+			return true;
+		}
+	}
+	else if (noFacesBr) {
+		// br has a collision mesh that is not convex, obj does not
+		// check faces of br near obj's sphere or box
+		glm::vec3 point;
+		float depth;
+		if (testMeshRegion(br, obj, norm, point, depth, noFaceTests)) {
+			contact = { 2, obj.instance, br.instance, norm, point, depth };
+			Stats::add(Stats::FACE_TESTS, noFaceTests);
+			return true;
+		}
+	}
+	else {
+		// obj has a collision mesh that is not convex, br does not
+		// check faces of obj near br's sphere or box
+		glm::vec3 point;
+		float depth;
+		if (testMeshRegion(obj, br, norm, point, depth, noFaceTests)) {
+			// the sphere or box responds (same as against convex regions)
+			contact = { 3, br.instance, obj.instance, norm, point, depth };
+			Stats::add(Stats::FACE_TESTS, noFaceTests);
+			return true;
+		}
+	}
+
+	Stats::add(Stats::FACE_TESTS, noFaceTests);
+	return false;
+}
+
+// add contact to cache, or respond immediately if there is none
+void NarrowPhase::resolve(Contact& contact) {
+	if (cache) {
+		cache->add(contact);
+	}
+	else {
+		respond(contact);
+	}
+}
+
+// apply the collision response of a contact
+void NarrowPhase::respond(Contact& contact) {
+	if (events) {
+		events->addContact(contact);
+	}
+
+	contact.instance->handleCollision(contact.other, contact.norm, contact.depth);
+}
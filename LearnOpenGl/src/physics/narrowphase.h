@@ -0,0 +1,56 @@
+#ifndef NARROWPHASE_H
+#define NARROWPHASE_H
+
+#include <glm/glm.hpp>
+
+#include "../algorithms/bounds.h"
+
+#include "rigidbody.h"
+
+// forward declaration
+class CollisionLog;
+class ContactCache;
+
+/*
+	structure representing a detected collision
+*/
+
+typedef struct Contact {
+	// test case that found the collision (1-4, 5 = swept sphere)
+	// the convex tests (1-4 without face tests) give normals pointing towards instance
+	unsigned char type;
+
+	// instance responding to the collision
+	RigidBody* instance;
+	// instance it collided with
+	RigidBody* other;
+
+	// collision normal
+	glm::vec3 norm;
+	// approximate contact point (closest point for sphere tests)
+	glm::vec3 point;
+	// penetration depth along the normal (0 if the test does not find it, the normal then has no direction)
+	float depth;
+} Contact;
+
+/*
+	namespace to tie together the fine grain collision tests
+*/
+
+namespace NarrowPhase {
+	// cache contacts are added to (nullptr = respond immediately)
+	extern ContactCache* cache;
+	// log responded contacts are recorded in (nullptr = not recorded)
+	extern CollisionLog* events;
+
+	// test two regions that passed the coarse check, fill contact if they collide
+	bool test(BoundingRegion& br, BoundingRegion& obj, Contact& contact);
+
+	// add contact to cache, or respond immediately if there is none
+	void resolve(Contact& contact);
+
+	// apply the collision response of a contact
+	void respond(Contact& contact);
+}
+
+#endif // !NARROWPHASE_H
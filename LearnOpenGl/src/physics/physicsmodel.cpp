@@ -0,0 +1,105 @@
+#include "physicsmodel.h"
+
+#include "ccd.h"
+
+#include "../algorithms/states.hpp"
+
+/*
+	constructor
+*/
+
+// initialize with parameters
+PhysicsModel::PhysicsModel(std::string id, unsigned int maxNoInstances, unsigned int flags)
+	: id(id), collision(nullptr),
+	instances(maxNoInstances), bodies(maxNoInstances),
+	maxNoInstances(maxNoInstances), currentNoInstances(0), switches(flags)
+{}
+
+/*
+	process functions
+*/
+
+// enable a collision model
+void PhysicsModel::enableCollisionModel()
+{
+	if (!this->collision) {
+		this->collision = new CollisionModel(this);
+	}
+}
+
+/*
+	instance methods
+*/
+
+// generate instance with parameters
+RigidBody* PhysicsModel::generateInstances(glm::vec3 size, float mass, glm::vec3 pos, glm::vec3 rot)
+{
+	if (currentNoInstances >= maxNoInstances) {
+		return nullptr; // all slots full
+	}
+
+	// instantiate new instance
+	unsigned int idx = bodies.add(size, mass, pos, rot);
+	instances[currentNoInstances] = new RigidBody(&bodies, idx, id);
+	return instances[currentNoInstances++];
+}
+
+// update instances together and mark them as moved
+// fast instances are moved back to their first contact if a broad phase is given (continuous collision detection)
+void PhysicsModel::updateInstances(float dt, BroadPhase* broadPhase)
+{
+	// positions before the step
+	std::vector<glm::vec3> starts;
+	if (broadPhase) {
+		starts.resize(currentNoInstances);
+		for (unsigned int i = 0; i < currentNoInstances; i++) {
+			starts[i] = instances[i]->getPos();
+		}
+	}
+
+	// update rigidbodies
+	bodies.update(dt);
+
+	for (unsigned int i = 0; i < currentNoInstances; i++) {
+		if (broadPhase) {
+			CCD::sweepInstance(broadPhase, this, instances[i], starts[i]);
+		}
+		// activate moved switch
+		States::activate(&instances[i]->state, INSTANCE_MOVED);
+	}
+}
+
+// remove instance at idx
+void PhysicsModel::removeInstance(unsigned int idx)
+{
+	if (idx < currentNoInstances) {
+		// shift down (with the bodies in the store)
+		bodies.remove(idx);
+		for (unsigned int i = idx + 1; i < currentNoInstances; i++) {
+			instances[i - 1] = instances[i];
+			instances[i - 1]->idx = i - 1;
+		}
+		currentNoInstances--;
+	}
+}
+
+// remove instance with id
+void PhysicsModel::removeInstance(std::string instanceId)
+{
+	int idx = getIdx(instanceId);
+	if (idx != -1) {
+		removeInstance(idx);
+	}
+}
+
+// get index of instance with id
+unsigned int PhysicsModel::getIdx(std::string id)
+{
+	// test each instance
+	for (unsigned int i = 0; i < currentNoInstances; i++) {
+		if (instances[i]->instanceId == id) {
+			return i;
+		}
+	}
+	return -1;
+}
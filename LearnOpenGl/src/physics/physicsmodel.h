@@ -0,0 +1,87 @@
+#ifndef PHYSICSMODEL_H
+#define PHYSICSMODEL_H
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+#include "rigidbody.h"
+#include "bodystore.h"
+#include "collisionmodel.h"
+
+#include "../algorithms/bounds.h"
+
+// forward declaration
+class BroadPhase;
+
+// model switches
+#define DYNAMIC					(unsigned int)1 // 0b00000001
+#define CONST_INSTANCES			(unsigned int)2 // 0b00000010
+#define NO_TEX					(unsigned int)4	// 0b00000100
+
+/*
+	class to represent the physical part of a model
+	- holds the instances, bounding regions and collision model used by the collision code
+	- does not depend on the rendering code, so the physics can run without a window (see Model for rendering)
+*/
+
+class PhysicsModel {
+public:
+	// id of model in scene
+	std::string id;
+
+	// pointer to the collision model
+	CollisionModel* collision;
+	// list of bounding regions (1 for each mesh)
+	std::vector<BoundingRegion> boundingRegions;
+
+	// list of instances (instance i is body i of the store)
+	std::vector<RigidBody*> instances;
+	// physical state of the instances
+	BodyStore bodies;
+
+	// maximum number of instances
+	unsigned int maxNoInstances;
+	// current number of instances
+	unsigned int currentNoInstances;
+
+	// combination of switches above
+	unsigned int switches;
+
+	/*
+		constructor
+	*/
+
+	// initialize with parameters
+	PhysicsModel(std::string id, unsigned int maxNoInstances, unsigned int flags = 0);
+
+	/*
+		process functions
+	*/
+
+	// enable collision model
+	void enableCollisionModel();
+
+	/*
+		instance methods
+	*/
+
+	// generate instance with parameters
+	RigidBody* generateInstances(glm::vec3 size, float mass, glm::vec3 pos, glm::vec3 rot);
+
+	// update instances together and mark them as moved
+	// fast instances are moved back to their first contact if a broad phase is given (continuous collision detection)
+	void updateInstances(float dt, BroadPhase* broadPhase = nullptr);
+
+	// remove instance at idx
+	void removeInstance(unsigned int idx);
+
+	// remove instance with id
+	void removeInstance(std::string instanceId);
+
+	// get index of instance with id
+	unsigned int getIdx(std::string id);
+};
+
+#endif // !PHYSICSMODEL_H
@@ -1,9 +1,5 @@
 #include "rigidbody.h"
 
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/quaternion.hpp>
-#include <glm/gtx/quaternion.hpp>
-
 #include <iostream>
 
 // test for equivalence of two rigid bodies
@@ -22,46 +18,131 @@ bool RigidBody::operator==(std::string id)
 	constructor
 */
 
-// construct with parameters and default
-RigidBody::RigidBody(std::string modelId, glm::vec3 size, float mass, glm::vec3 pos, glm::vec3 rot)
-	: modelId(modelId), size(size), mass(mass), pos(pos), velocity(0.0f), acceleration(0.0f), state(0), rot(rot),
-	lastCollision(COLLISION_THRESHOLD), lastCollisionID("") {
-	update(0.0f);
-}
+// construct handle to body at idx in store
+RigidBody::RigidBody(BodyStore* store, unsigned int idx, std::string modelId)
+	: state(0), store(store), idx(idx), modelId(modelId), bodyId(0) {}
 
 /*
-	transformation functions
+	physical state (read from and written to the store)
 */
 
-// update position with velocity and acceleration
-void RigidBody::update(float dt, bool gun)
+// position in m
+glm::vec3 RigidBody::getPos()
 {
-	if (velocity != glm::vec3(0.0f) && acceleration != glm::vec3(0.0f)) {
-		pos += velocity * dt + 0.5f * acceleration * (dt * dt);
-	}
+	return glm::vec3(store->px[idx], store->py[idx], store->pz[idx]);
+}
+
+// position in m
+void RigidBody::setPos(glm::vec3 pos)
+{
+	store->px[idx] = pos.x;
+	store->py[idx] = pos.y;
+	store->pz[idx] = pos.z;
+}
+
+// velocity in m/s
+glm::vec3 RigidBody::getVelocity()
+{
+	return glm::vec3(store->vx[idx], store->vy[idx], store->vz[idx]);
+}
+
+// velocity in m/s
+void RigidBody::setVelocity(glm::vec3 velocity)
+{
+	store->vx[idx] = velocity.x;
+	store->vy[idx] = velocity.y;
+	store->vz[idx] = velocity.z;
+}
 
+// acceleration in m/s^2
+glm::vec3 RigidBody::getAcceleration()
+{
+	return glm::vec3(store->ax[idx], store->ay[idx], store->az[idx]);
+}
 
-	velocity += acceleration * dt;
+// acceleration in m/s^2
+void RigidBody::setAcceleration(glm::vec3 acceleration)
+{
+	store->ax[idx] = acceleration.x;
+	store->ay[idx] = acceleration.y;
+	store->az[idx] = acceleration.z;
+}
 
-	// rotation
-	if (!gun) {
-		rotationMatrix = glm::toMat4(glm::quat(rot));
+// dimensions of object
+glm::vec3 RigidBody::getSize()
+{
+	return glm::vec3(store->sx[idx], store->sy[idx], store->sz[idx]);
+}
+
+// mass in kg
+float RigidBody::getMass()
+{
+	return store->mass[idx];
+}
+
+// rotation in euler angles
+glm::vec3 RigidBody::getRot()
+{
+	return store->rot[idx];
+}
+
+// rotation in euler angles
+void RigidBody::setRot(glm::vec3 rot)
+{
+	store->setRot(idx, rot);
+}
+
+// rotation matrix (set directly for bodies not rotated by euler angles)
+glm::mat3 RigidBody::getRotationMatrix()
+{
+	glm::mat3 ret;
+	for (unsigned int c = 0; c < 3; c++) {
+		for (unsigned int r = 0; r < 3; r++) {
+			ret[c][r] = store->rotation[3 * c + r][idx];
+		}
 	}
+	return ret;
+}
 
-	// model = translation * rotation * scale
-	model = glm::translate(glm::mat4(1.0f), pos);
-	model = model * rotationMatrix;
-	model = glm::scale(model, size);
+// rotation matrix (set directly for bodies not rotated by euler angles)
+void RigidBody::setRotationMatrix(glm::mat3 rotation)
+{
+	store->setRotationMatrix(idx, rotation);
+}
 
-	normalModel = glm::transpose(glm::inverse(glm::mat3(model)));
+// model matrix
+const glm::mat4& RigidBody::getModel()
+{
+	return store->models[idx];
+}
 
-	lastCollision += dt;
+// model matrix
+const glm::mat3& RigidBody::getNormalModel()
+{
+	return store->normalModels[idx];
+}
+
+// incremented each time the model matrix changes
+unsigned int RigidBody::getTransformVersion()
+{
+	return store->transformVersions[idx];
+}
+
+/*
+	transformation functions
+*/
+
+// update position with velocity and acceleration (bodies of a model are updated together with BodyStore::update)
+void RigidBody::update(float dt)
+{
+	store->integrate(idx, 1, dt);
+	store->updateMatrices(idx, 1);
 }
 
 // apply a force
 void RigidBody::applyForce(glm::vec3 force)
 {
-	acceleration += force / mass;
+	setAcceleration(getAcceleration() + force / getMass());
 }
 
 // apply a force
@@ -73,7 +154,7 @@ void RigidBody::applyForce(glm::vec3 direction, float magnitude)
 // apply an acceleration (remove redundancy of dividing by mass)
 void RigidBody::applyAcceleration(glm::vec3 a)
 {
-	acceleration += a;
+	setAcceleration(getAcceleration() + a);
 }
 
 // apply an acceleration (remove redundancy of dividing by mass)
@@ -85,7 +166,7 @@ void RigidBody::applyAcceleration(glm::vec3 direction, float magnitude)
 // apply force over time
 void RigidBody::applyImpulse(glm::vec3 force, float dt)
 {
-	velocity += force / mass * dt;
+	setVelocity(getVelocity() + force / getMass() * dt);
 }
 
 // apply force over time
@@ -103,70 +184,72 @@ void RigidBody::transferEnergy(float joules, glm::vec3 direction)
 
 	// comes from formula: KE = 1 / 2 * m * v^2
 
-	glm::vec3 deltaV = sqrt(2 * abs(joules) / mass) * direction;
+	glm::vec3 deltaV = (float)sqrt(2 * abs(joules) / getMass()) * direction;
 
-	velocity += joules > 0 ? deltaV : -deltaV;
+	setVelocity(getVelocity() + (joules > 0 ? deltaV : -deltaV));
 }
 
 /*
 	collisions
 */
-void RigidBody::handleCollision(RigidBody* inst, glm::vec3 norm)
+void RigidBody::handleCollision(RigidBody* inst, glm::vec3 norm, float depth)
 {
-	if (lastCollision >= COLLISION_THRESHOLD || lastCollisionID != inst->instanceId) {
-		if (this->modelId == "sphere") {
-			if (glm::any(glm::isnan(this->velocity)) && glm::length(inst->velocity) > 0.1f) {
-				// Get the mass and velocity of the moving sphere
-				float movingMass = inst->mass;
-				glm::vec3 movingVelocity = inst->velocity;
+	// repeated hits are filtered by the contact cache
+	if (this->modelId == "sphere") {
+		if (depth > 0.0f) {
+			// move out of the other body (normal points towards this body when the depth is known)
+			setPos(getPos() + depth * glm::normalize(norm));
+		}
 
-				// Get the mass of the stationary sphere
-				float stationaryMass = this->mass;
+		if (glm::any(glm::isnan(getVelocity())) && glm::length(inst->getVelocity()) > 0.1f) {
+			// Get the mass and velocity of the moving sphere
+			float movingMass = inst->getMass();
+			glm::vec3 movingVelocity = inst->getVelocity();
 
-				// Calculate the resulting velocity of the stationary sphere using conservation of momentum
-				glm::vec3 resultingVelocity = (2.0f * movingMass * movingVelocity) / (movingMass + stationaryMass);
+			// Get the mass of the stationary sphere
+			float stationaryMass = getMass();
 
-				// Apply the resulting velocity to the stationary sphere
-				this->velocity = resultingVelocity;
+			// Calculate the resulting velocity of the stationary sphere using conservation of momentum
+			glm::vec3 resultingVelocity = (2.0f * movingMass * movingVelocity) / (movingMass + stationaryMass);
 
-				applyAcceleration(Environment::gravitationalAcceleration);
-			}
-			else {
-				// Reflect the velocity using the collision normal
-				this->velocity = glm::reflect(this->velocity, glm::normalize(norm));
+			// Apply the resulting velocity to the stationary sphere
+			setVelocity(resultingVelocity);
 
-				// Apply friction to the velocity
-				float frictionCoefficient = 0.2f; // Adjust this value to control friction
-				glm::vec3 frictionForce = -frictionCoefficient * glm::length(this->velocity) * glm::normalize(this->velocity);
-				this->velocity += frictionForce;
+			applyAcceleration(Environment::gravitationalAcceleration);
+		}
+		else {
+			// Reflect the velocity using the collision normal
+			glm::vec3 velocity = glm::reflect(getVelocity(), glm::normalize(norm));
 
-				// Reset counter
-				lastCollision = 0.0f;
+			// Apply friction to the velocity
+			float frictionCoefficient = 0.2f; // Adjust this value to control friction
+			glm::vec3 frictionForce = -frictionCoefficient * glm::length(velocity) * glm::normalize(velocity);
+			velocity += frictionForce;
+			setVelocity(velocity);
 
-				// Check if the hit surface is perpendicular to gravity (assuming -y is the gravity direction)
-				float gravityDotProduct = glm::dot(glm::vec3(0.0f, -1.0f, 0.0f), glm::normalize(norm));
-				if (std::abs(gravityDotProduct) > 0.9f) { // Adjust the threshold as needed
+			// Check if the hit surface is perpendicular to gravity (assuming -y is the gravity direction)
+			float gravityDotProduct = glm::dot(glm::vec3(0.0f, -1.0f, 0.0f), glm::normalize(norm));
+			if (std::abs(gravityDotProduct) > 0.9f) { // Adjust the threshold as needed
 
 
-					// Check if the velocity magnitude is below a threshold
-					float velocityThreshold = 0.5f; // Adjust this value to control when the object stops
-					if (glm::length(velocity) < velocityThreshold) {
-						// Set the vertical velocity to zero to prevent the object from sinking into the ground
-						acceleration.y += 9.81f;
+				// Check if the velocity magnitude is below a threshold
+				float velocityThreshold = 0.5f; // Adjust this value to control when the object stops
+				if (glm::length(velocity) < velocityThreshold) {
+					// Set the vertical velocity to zero to prevent the object from sinking into the ground
+					setAcceleration(getAcceleration() + glm::vec3(0.0f, 9.81f, 0.0f));
 
-						// Set the velocity to zero to make the object stay still
-						velocity = glm::vec3(0.0f);
-					}
+					// Set the velocity to zero to make the object stay still
+					setVelocity(glm::vec3(0.0f));
 				}
 			}
-			
 		}
+		
 	}
-	lastCollisionID = inst->instanceId;
 }
 
 void RigidBody::apllyAirFriction(float dt)
 {
+	glm::vec3 velocity = getVelocity();
 	applyImpulse(glm::vec3(-velocity.x, 0, -velocity.z), 0.5, dt);
 	
 }
@@ -3,18 +3,47 @@
 
 #include <glm/glm.hpp>
 
+#include <deque>
 #include <string>
+#include <vector>
 #include "../physics/environment.h"
+#include "../physics/bodystore.h"
+#include "../algorithms/trianglearrays.h"
+
+// forward declaration
+class CollisionMesh;
 
 // switches for instance states
 #define INSTANCE_DEAD		(unsigned char)0b00000001
 #define INSTANCE_MOVED      (unsigned char)0b00000010
 
+// minimum time between collision responses of a touching pair
 #define COLLISION_THRESHOLD 0.05f
 
+/*
+	collision mesh of an instance in world space
+	- points and face normals transformed by the model matrix of the instance
+	- filled by CollisionMesh::getWorldMesh the first time it is used after the instance moved
+*/
+
+typedef struct WorldMesh {
+	// mesh the points belong to
+	CollisionMesh* mesh;
+	// transform version of the instance the points were computed for
+	unsigned int version;
+
+	// transformed points (same order as in the mesh)
+	std::vector<glm::vec3> points;
+	// transformed face normals (same order as the faces, not normalized)
+	std::vector<glm::vec3> norms;
+	// transformed faces as arrays (same order as the face list of the tree of the mesh, so its leaves are runs)
+	TriangleArrays faces;
+} WorldMesh;
+
 /*
 	Rigid Body class
-	- represents physical body and holds all parameters
+	- handle to a body in the store of its model (physical state is kept there, see BodyStore)
+	- holds the ids, state switches and collision data of the body
 */
 
 class RigidBody {
@@ -22,34 +51,20 @@ public:
 	// combination of switches above
 	unsigned char state;
 
-	// mass in kg
-	float mass;
-
-	// position in m
-	glm::vec3 pos;
-	// velocity in m/s
-	glm::vec3 velocity;
-	// acceleration in m/s^2
-	glm::vec3 acceleration;
-
-	// dimensions of object
-	glm::vec3 size;
+	// store holding the physical state of the body
+	BodyStore* store;
+	// index of the body in the store (changes when bodies before it are removed)
+	unsigned int idx;
 
-	// rotation in euler angles
-	glm::vec3 rot;
-	glm::mat4 rotationMatrix;
-
-	// model matrix
-	glm::mat4 model;
-	glm::mat3 normalModel;
+	// collision meshes in world space (deque so references stay valid when one is added)
+	std::deque<WorldMesh> worldMeshes;
 
 	// ids for quick access to instance/model
 	std::string modelId;
 	std::string instanceId;
 
-	// data of previous collision
-	float lastCollision;
-	std::string lastCollisionID;
+	// integer id for quick comparisons (contact pair keys)
+	unsigned int bodyId;
 
 	// test for equivalence of two rigid bodies
 	bool operator==(RigidBody rb);
@@ -59,15 +74,52 @@ public:
 		constructor
 	*/
 
-	// construct with parameters and default
-	RigidBody(std::string modelId = "", glm::vec3 size = glm::vec3(1.0f), float mass = 1.0f, glm::vec3 pos = glm::vec3(0.0f), glm::vec3 rot = glm::vec3(0.0f));
+	// construct handle to body at idx in store
+	RigidBody(BodyStore* store, unsigned int idx, std::string modelId = "");
+
+	/*
+		physical state (read from and written to the store)
+	*/
+
+	// position in m
+	glm::vec3 getPos();
+	void setPos(glm::vec3 pos);
+
+	// velocity in m/s
+	glm::vec3 getVelocity();
+	void setVelocity(glm::vec3 velocity);
+
+	// acceleration in m/s^2
+	glm::vec3 getAcceleration();
+	void setAcceleration(glm::vec3 acceleration);
+
+	// dimensions of object
+	glm::vec3 getSize();
+
+	// mass in kg
+	float getMass();
+
+	// rotation in euler angles
+	glm::vec3 getRot();
+	void setRot(glm::vec3 rot);
+
+	// rotation matrix (set directly for bodies not rotated by euler angles)
+	glm::mat3 getRotationMatrix();
+	void setRotationMatrix(glm::mat3 rotation);
+
+	// model matrix
+	const glm::mat4& getModel();
+	const glm::mat3& getNormalModel();
+
+	// incremented each time the model matrix changes
+	unsigned int getTransformVersion();
 
 	/*
 		transformation functions
 	*/
 
-	// update position with velocity and acceleration
-	void update(float dt, bool gun = false);
+	// update position with velocity and acceleration (bodies of a model are updated together with BodyStore::update)
+	void update(float dt);
 
 	// apply a force
 	void applyForce(glm::vec3 force);
@@ -87,7 +139,8 @@ public:
 	/*
 		collisions
 	*/
-	void handleCollision(RigidBody* inst, glm::vec3 norm);
+	// respond to a collision with inst, depth > 0 pushes the body out along norm
+	void handleCollision(RigidBody* inst, glm::vec3 norm, float depth = 0.0f);
 
 	/*
 		enviroment forces
@@ -25,7 +25,7 @@ void Scene::framebufferSizeCallback(GLFWwindow* window, int width, int height)
 
 // default
 Scene::Scene()
-	:currentId("aaaaaaaa"), lightUBO(0) {}
+	:currentId("aaaaaaaa"), currentBodyId(0), lightUBO(0) {}
 
 // set with values
 Scene::Scene(int glfwVersionMajor, int glfwVersionMinor,
@@ -34,7 +34,7 @@ Scene::Scene(int glfwVersionMajor, int glfwVersionMinor,
 	title(title), // window title
 	// default indices/vals
 	activeCamera(-1), activePointLigths(0), activeSpotLights(0),
-	currentId("aaaaaaaa"),
+	currentId("aaaaaaaa"), currentBodyId(0),
 	lightUBO(0)
 {
 	// window dimesions
@@ -126,9 +126,32 @@ bool Scene::init()
 
 
 	/*
-		init octree
+		init broad phase
 	*/
-	octree = new Octree::node(BoundingRegion(glm::vec3(-36.0f), glm::vec3(36.0f)));
+	Octree::node* octree = nullptr;
+	broadPhase = BroadPhase::create(broadPhaseType, &octree);
+
+	if (octree) {
+		// static geometry is loaded from the cache file instead of built when unchanged
+		octree->staticCache = new OctreeCache(OCTREE_CACHE_PATH);
+	}
+
+	/*
+		init worker threads
+	*/
+	workers = new ThreadPool();
+
+	/*
+		init contact cache
+	*/
+	contactCache = new ContactCache();
+	NarrowPhase::cache = contactCache;
+
+	/*
+		init collision log
+	*/
+	collisionLog = new CollisionLog();
+	NarrowPhase::events = collisionLog;
 
 	/*
 		initalize freetype library
@@ -147,6 +170,12 @@ bool Scene::init()
 	variableLog["dispOutlines"] = false;
 	variableLog["skipNormalMap"] = false;
 
+	// collision detection values
+	variableLog["parallelCollisions"] = false;
+	variableLog["collisionVerbosity"] = (int)CollisionVerbosity::SILENT;
+	variableLog["recordStats"] = false;
+	variableLog["continuousCollisions"] = true;
+
 	return true;
 }
 
@@ -167,7 +196,7 @@ void Scene::prepare(Box& box, std::vector<Shader> shaders)
 	// close FT library
 	FT_Done_FreeType(ft);
 	// process current instances
-	octree->update(box);
+	broadPhase->update(box);
 
 
 	// setup lighting UBO
@@ -354,6 +383,32 @@ void Scene::keyChanged(GLFWwindow* window, int key, int scancode, int action, in
 		variableLog["skipNormalMap"] = !variableLog["skipNormalMap"].val<bool>();
 	}
 
+	// update parallel collision detection
+	if (Keyboard::keyWentDown(GLFW_KEY_C)) {
+		variableLog["parallelCollisions"] = !variableLog["parallelCollisions"].val<bool>();
+	}
+
+	// cycle collision log verbosity (silent, summary, events)
+	if (Keyboard::keyWentDown(GLFW_KEY_V)) {
+		variableLog["collisionVerbosity"] = (variableLog["collisionVerbosity"].val<int>() + 1) % 3;
+	}
+
+	// toggle continuous collision detection of fast instances
+	if (Keyboard::keyWentDown(GLFW_KEY_X)) {
+		variableLog["continuousCollisions"] = !variableLog["continuousCollisions"].val<bool>();
+	}
+
+	// toggle recording of collision statistics (summary of recorded frames is written when stopped)
+	if (Keyboard::keyWentDown(GLFW_KEY_K)) {
+		variableLog["recordStats"] = !variableLog["recordStats"].val<bool>();
+		if (variableLog["recordStats"].val<bool>()) {
+			collisionStats.clearSummary();
+		}
+		else {
+			collisionStats.writeJSON(COLLISION_STATS_PATH ".json");
+		}
+	}
+
 	// update outline parameter if neceassry
 	if (Keyboard::keyWentDown(GLFW_KEY_O)) {
 		variableLog["dispOutlines"] = !variableLog["dispOutlines"].val<bool>();
@@ -413,9 +468,33 @@ void Scene::newFrame(Box& box)
 	box.positions.clear();
 	box.sizes.clear();
 
+	// set collision detection mode
+	broadPhase->workers = variableLog["parallelCollisions"].val<bool>() ? workers : nullptr;
+
 	// process pending
-	octree->processPending();
-	octree->update(box);
+	double time = glfwGetTime();
+	broadPhase->processPending();
+	double pendingEnd = glfwGetTime();
+	broadPhase->update(box);
+	double updateEnd = glfwGetTime();
+
+	// contact events and responses
+	contactCache->endFrame((float)updateEnd);
+
+	// statistics of frame
+	collisionStats.pendingTime = (pendingEnd - time) * 1000.0;
+	collisionStats.updateTime = (updateEnd - pendingEnd) * 1000.0;
+	collisionStats.responseTime = (glfwGetTime() - updateEnd) * 1000.0;
+	collisionStats.takeCounters();
+	if (variableLog["recordStats"].val<bool>()) {
+		getCollisionStats().record();
+		collisionStats.appendCSV(COLLISION_STATS_PATH ".csv");
+	}
+	collisionStats.frame++;
+
+	// print collision records of frame
+	collisionLog->verbosity = (CollisionVerbosity)variableLog["collisionVerbosity"].val<int>();
+	collisionLog->drain();
 
 	// send new frame to window
 	glfwSwapBuffers(window);
@@ -572,7 +651,17 @@ void Scene::cleanup()
 	// cleanyp fonts trie
 	avl_free(fonts);
 
-	octree->destroy();
+	broadPhase->destroy();
+	delete broadPhase;
+
+	workers->cleanup();
+	delete workers;
+
+	NarrowPhase::cache = nullptr;
+	delete contactCache;
+
+	NarrowPhase::events = nullptr;
+	delete collisionLog;
 
 	lightUBO.cleanup();
 
@@ -651,10 +740,11 @@ RigidBody* Scene::generateInstance(std::string modelId, glm::vec3 size, float ma
 			// successfully generated, set new and unique id for instance
 			std::string id = generateId();
 			rb->instanceId = id;
+			rb->bodyId = currentBodyId++;
 			// insert into trie
 			instances.insert(rb->instanceId, rb);
 			// insert into pending queue
-			octree->addToPending(rb, model);
+			broadPhase->addToPending(rb, model);
 			return rb;
 		}
 	}
@@ -698,7 +788,7 @@ void Scene::removeInstance(std::string instanceId)
 	// remove from tree
 	instances[instanceId] = NULL;
 	instances.erase(instanceId);
-	free(instance);
+	delete instance;
 }
 
 // mark instance for deletion
@@ -710,6 +800,8 @@ void Scene::markForDeletion(std::string instanceId)
 	States::activate(&instance->state, INSTANCE_DEAD);
 	// activate kill switch
 	instancesToDelete.push_back(instance);
+	// let structures that do not scan for dead instances know
+	broadPhase->markDead(instance);
 }
 
 // clear all instances marked for deletion
@@ -721,6 +813,34 @@ void Scene::clearDeadInstances()
 	instancesToDelete.clear();
 }
 
+// gather shape of broad phase into collision statistics (counters and timings are of the last frame)
+CollisionStats& Scene::getCollisionStats()
+{
+	collisionStats.clearShape();
+	broadPhase->gatherStats(collisionStats);
+	return collisionStats;
+}
+
+// find closest hit of each ray (tested in packets, for batched picking/line of sight)
+void Scene::castRays(std::vector<Ray>& rays, std::vector<BoundingRegion*>& hits, std::vector<float>& t)
+{
+	hits.resize(rays.size());
+	t.resize(rays.size());
+
+	RayPacket packet;
+	for (unsigned int start = 0, noRays = (unsigned int)rays.size(); start < noRays; start += RAY_PACKET_MAX) {
+		packet.clear();
+		for (unsigned int i = start; i < noRays && packet.add(rays[i]); i++);
+
+		broadPhase->checkCollisionsPacket(packet);
+
+		for (unsigned int i = 0; i < packet.count; i++) {
+			hits[start + i] = packet.hits[i];
+			t[start + i] = packet.t[i];
+		}
+	}
+}
+
 // generate next instance id
 std::string Scene::generateId() {
 	for (int i = (int)currentId.length() - 1; i >= 0; i--) {
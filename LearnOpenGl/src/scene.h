@@ -24,15 +24,30 @@
 #include "graphics/objects/model.h"
 #include "graphics/models/box.hpp"
 
+#include "physics/collisionlog.h"
+#include "physics/contactcache.h"
+
 #include "io/camera.h"
 #include "io/keyboard.h"
 #include "io/mouse.h"
 
 #include "algorithms/states.hpp"
 #include "algorithms/avl.h"
+#include "algorithms/aabbtree.h"
+#include "algorithms/broadphase.h"
+#include "algorithms/collisionstats.h"
 #include "algorithms/octree.h"
+#include "algorithms/splitoctree.h"
+#include "algorithms/sweepandprune.h"
+#include "algorithms/uniformgrid.h"
+#include "algorithms/threadpool.h"
 #include "algorithms/trie.hpp"
 
+// file the static part of the octree is cached in
+#define OCTREE_CACHE_PATH "assets/static.octree"
+// path of recorded collision statistics (without extension, .csv per frame and .json summary)
+#define COLLISION_STATS_PATH "collision_stats"
+
 // forward declarations
 namespace Octree {
 	class node;
@@ -55,8 +70,22 @@ public:
 	// list of instances that should be deleted
 	std::vector<RigidBody*> instancesToDelete;
 
-	// pointer to root node in octree
-	Octree::node* octree;
+	// structure used for broad phase collision detection (chosen before init)
+	BroadPhaseType broadPhaseType = BroadPhaseType::SPLIT_OCTREE;
+	// pointer to broad phase (root node if octree)
+	BroadPhase* broadPhase;
+
+	// worker threads for parallel collision detection
+	ThreadPool* workers;
+
+	// contacts kept between frames
+	ContactCache* contactCache;
+
+	// contact and ray hit records printed once per frame
+	CollisionLog* collisionLog;
+
+	// statistics of the collision system for the last frame
+	CollisionStats collisionStats;
 
 	// map for logged variables
 	jsoncpp::json variableLog;
@@ -194,8 +223,16 @@ public:
 	// clear all instances marked for deletion
 	void clearDeadInstances();
 
+	// gather shape of broad phase into collision statistics (counters and timings are of the last frame)
+	CollisionStats& getCollisionStats();
+
+	// find closest hit of each ray (tested in packets, for batched picking/line of sight)
+	void castRays(std::vector<Ray>& rays, std::vector<BoundingRegion*>& hits, std::vector<float>& t);
+
 	// current instance id
 	std::string currentId;
+	// next integer body id
+	unsigned int currentBodyId;
 
 	// generate next instance id
 	std::string generateId();
@@ -0,0 +1,461 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iterator>
+
+#include "algorithms/states.hpp"
+#include "physics/collisionimport.h"
+#include "physics/environment.h"
+#include "physics/narrowphase.h"
+
+// scale of street instances (same as main.cpp)
+#define STREET_SCALE 0.08f
+// scale and mass of spheres (same as launchItem() in main.cpp)
+#define SPHERE_SCALE 0.3f
+#define SPHERE_MASS 1.0f
+// energy given to launched spheres
+#define LAUNCH_ENERGY 100.0f
+// corners of the road (spheres crossing its bottom inside its footprint went through the street)
+#define ROAD_MIN (glm::vec3(-110.937218f, -5.913838f, -65.131943f) * STREET_SCALE)
+#define ROAD_MAX (glm::vec3(269.668243f, -1.972113f, 197.865646f) * STREET_SCALE)
+
+// cells of the speed bump mesh along the road (half as many across), height and spacing of the bumps
+#define BUMP_CELLS 64
+#define BUMP_HEIGHT 0.3f
+#define BUMP_SPACING 4.0f
+
+typedef std::chrono::high_resolution_clock Clock;
+
+// if position is over or under the road
+static bool onRoad(glm::vec3 pos) {
+	return pos.x >= ROAD_MIN.x && pos.x <= ROAD_MAX.x &&
+		pos.z >= ROAD_MIN.z && pos.z <= ROAD_MAX.z;
+}
+
+// render mesh of speed bumps across the road where the spheres are dropped (n by n / 2 cells, flat between the bumps)
+static void speedBumps(unsigned int n, std::vector<glm::vec3>& points, std::vector<unsigned int>& indices) {
+	glm::vec3 min(-8.0f, ROAD_MAX.y, 0.5f), max(20.0f, ROAD_MAX.y, 11.0f);
+	unsigned int nx = n, nz = n / 2;
+
+	for (unsigned int i = 0; i <= nx; i++) {
+		for (unsigned int j = 0; j <= nz; j++) {
+			float x = min.x + (max.x - min.x) * (float)i / (float)nx;
+			float z = min.z + (max.z - min.z) * (float)j / (float)nz;
+			float y = min.y + BUMP_HEIGHT * std::fmaxf(0.0f, std::sin(x * 6.2831853f / BUMP_SPACING));
+			points.push_back(glm::vec3(x, y, z));
+		}
+	}
+
+	// two faces for each cell, facing up
+	for (unsigned int i = 0; i < nx; i++) {
+		for (unsigned int j = 0; j < nz; j++) {
+			unsigned int a = i * (nz + 1) + j;
+			unsigned int b = a + nz + 1;
+			unsigned int cell[6] = { a, a + 1, b, b, a + 1, b + 1 };
+			indices.insert(indices.end(), cell, cell + 6);
+		}
+	}
+}
+
+// get milliseconds between two time points
+static double elapsed(Clock::time_point start, Clock::time_point end) {
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/*
+	process functions
+*/
+
+// create models, broad phase and initial instances
+void Benchmark::init()
+{
+	pairTests = 0;
+	faceTests = 0;
+	integrateTime = 0.0;
+	pendingTime = 0.0;
+	updateTime = 0.0;
+	responseTime = 0.0;
+	totalTime = 0.0;
+	framePairTests.clear();
+	positions.clear();
+	noPairMismatches = 0;
+	noMissedPairs = 0;
+	noExtraPairs = 0;
+	tunneled.clear();
+
+	frame = 0;
+	currentBodyId = 0;
+	random.seed(seed);
+
+	/*
+		init collision structures
+	*/
+	broadPhase = BroadPhase::create(broadPhaseType);
+
+	workers = new ThreadPool();
+	broadPhase->workers = parallel ? workers : nullptr;
+
+	contactCache = new ContactCache();
+	NarrowPhase::cache = contactCache;
+
+	/*
+		street (bounding regions from main.cpp)
+	*/
+	PhysicsModel* ev = new PhysicsModel("ev", 1, CONST_INSTANCES);
+	ev->boundingRegions.push_back(BoundingRegion(glm::vec3(-104.856216, -1.868685, -21.621166), glm::vec3(136.939651, 89.524246, 2.686391)));
+	ev->boundingRegions.push_back(BoundingRegion(glm::vec3(-104.856216, 1.826021, 140.782227), glm::vec3(136.939651, 89.524246, 165.089783)));
+	ev->boundingRegions.push_back(BoundingRegion(glm::vec3(271.685028, -3.641843, -26.273689), glm::vec3(295.992584, 89.524246, 215.522171)));
+
+	PhysicsModel* yol = new PhysicsModel("yol", 1, CONST_INSTANCES);
+	yol->boundingRegions.push_back(BoundingRegion(glm::vec3(-110.937218, -5.913838, -65.131943), glm::vec3(269.668243, -1.972113, 197.865646)));
+
+	PhysicsModel* kaldirim = new PhysicsModel("kaldirim", 1, CONST_INSTANCES);
+	kaldirim->boundingRegions.push_back(BoundingRegion(glm::vec3(-103.743050, -2.401778, -65.131943), glm::vec3(155.178009, -0.377109, 22.295204)));
+	kaldirim->boundingRegions.push_back(BoundingRegion(glm::vec3(-103.743050, -2.401778, 121.954636), glm::vec3(155.178009, -0.377109, 209.381775)));
+
+	/*
+		speed bumps (procedural mesh simplified like the meshes of the street models in main.cpp, the cache file is not written)
+	*/
+	std::vector<glm::vec3> bumpPoints;
+	std::vector<unsigned int> bumpIndices;
+	speedBumps(BUMP_CELLS, bumpPoints, bumpIndices);
+
+	CollisionImport import("bumps", COLLISION_IMPORT_FACES);
+	import.build(0, bumpPoints, bumpIndices);
+	bumpsMesh = new CollisionMesh(import.records[0].noPoints, import.points[0].data(), import.records[0].noFaces, import.indices[0].data());
+
+	PhysicsModel* bumps = new PhysicsModel("bumps", 1, CONST_INSTANCES);
+	BoundingRegion bumpsRegion(glm::vec3(-8.0f, ROAD_MAX.y, 0.5f), glm::vec3(20.0f, ROAD_MAX.y + BUMP_HEIGHT, 11.0f));
+	bumpsRegion.collisionMesh = bumpsMesh;
+	bumps->boundingRegions.push_back(bumpsRegion);
+
+	sphere = new PhysicsModel("sphere", noBodies, DYNAMIC);
+	sphere->boundingRegions.push_back(BoundingRegion(glm::vec3(0.0f), 1.0f));
+
+	models = { ev, yol, kaldirim, bumps, sphere };
+
+	for (PhysicsModel* model : { ev, yol, kaldirim }) {
+		generateInstance(model, glm::vec3(STREET_SCALE), 1.0f, glm::vec3(0.0f));
+	}
+	generateInstance(bumps, glm::vec3(1.0f), 1.0f, glm::vec3(0.0f));
+
+	// dropped spheres are in the tree when it is built
+	if (scenario == Scenario::DROP) {
+		spawn();
+	}
+
+	// build (same as Scene::prepare)
+	broadPhase->update(boxes);
+	boxes.positions.clear();
+	boxes.sizes.clear();
+
+	// ignore tests done while building
+	stats.takeCounters();
+}
+
+// step one frame
+void Benchmark::step()
+{
+	if (scenario == Scenario::BARRAGE) {
+		spawn();
+	}
+
+	// positions before the step (to find spheres going through the road)
+	std::vector<glm::vec3> starts(sphere->currentNoInstances);
+	for (unsigned int i = 0; i < sphere->currentNoInstances; i++) {
+		starts[i] = sphere->instances[i]->getPos();
+	}
+
+	// same order as the main loop (instances move while rendering, collisions are checked in Scene::newFrame)
+	Clock::time_point start = Clock::now();
+	sphere->updateInstances(dt, continuous ? broadPhase : nullptr);
+
+	Clock::time_point integrateEnd = Clock::now();
+	// found before the broad phase resolves its contacts and moves the spheres (not timed)
+	std::vector<unsigned long long> expected;
+	if (checkPairs) {
+		expected = allPairs();
+	}
+
+	Clock::time_point pendingStart = Clock::now();
+	broadPhase->processPending();
+
+	Clock::time_point pendingEnd = Clock::now();
+	broadPhase->update(boxes);
+
+	Clock::time_point updateEnd = Clock::now();
+	if (checkPairs) {
+		comparePairs(expected);
+	}
+
+	Clock::time_point responseStart = Clock::now();
+	contactCache->endFrame((float)frame * dt);
+
+	Clock::time_point end = Clock::now();
+
+	boxes.positions.clear();
+	boxes.sizes.clear();
+
+	// spheres that went from above the bottom of the road to under it inside its footprint
+	// (spheres rolling off its ends and drifting under it are not counted)
+	tunneled.resize(sphere->currentNoInstances, false);
+	for (unsigned int i = 0; i < sphere->currentNoInstances; i++) {
+		glm::vec3 pos = sphere->instances[i]->getPos();
+		if (onRoad(starts[i]) && onRoad(pos) && starts[i].y >= ROAD_MIN.y && pos.y < ROAD_MIN.y) {
+			tunneled[i] = true;
+		}
+	}
+
+	// statistics of frame
+	stats.frame = frame;
+	stats.pendingTime = elapsed(pendingStart, pendingEnd);
+	stats.updateTime = elapsed(pendingEnd, updateEnd);
+	stats.responseTime = elapsed(responseStart, end);
+	stats.takeCounters();
+
+	integrateTime += elapsed(start, integrateEnd);
+	pendingTime += stats.pendingTime;
+	updateTime += stats.updateTime;
+	responseTime += stats.responseTime;
+	totalTime += elapsed(start, integrateEnd) + elapsed(pendingStart, updateEnd) + stats.responseTime;
+	pairTests += stats.pairTests;
+	faceTests += stats.faceTests;
+	framePairTests.push_back(stats.pairTests);
+
+	if (!statsPath.empty()) {
+		stats.clearShape();
+		broadPhase->gatherStats(stats);
+		stats.appendCSV(statsPath);
+	}
+
+	frame++;
+}
+
+// step all frames
+void Benchmark::run()
+{
+	for (unsigned int i = 0; i < noFrames; i++) {
+		step();
+	}
+
+	for (unsigned int i = 0; i < sphere->currentNoInstances; i++) {
+		positions.push_back(sphere->instances[i]->getPos());
+	}
+}
+
+// print results
+void Benchmark::report(std::ostream& out)
+{
+	double seconds = totalTime / 1000.0;
+	double perFrame = noFrames ? 1.0 / (double)noFrames : 0.0;
+
+	out << std::fixed << std::setprecision(3);
+	out << "scenario " << scenarioName(scenario)
+		<< ", broad phase " << broadPhaseName(broadPhaseType)
+		<< ", " << sphere->currentNoInstances << " spheres"
+		<< ", " << noFrames << " frames"
+		<< ", dt " << dt
+		<< ", " << (parallel ? "parallel" : "serial")
+		<< (continuous ? ", continuous" : "") << std::endl;
+	out << "  steps/sec         " << (seconds > 0.0 ? noFrames / seconds : 0.0) << std::endl;
+	out << "  pair tests/sec    " << (seconds > 0.0 ? pairTests / seconds : 0.0) << " (" << pairTests << " total)" << std::endl;
+	out << "  face tests/sec    " << (seconds > 0.0 ? faceTests / seconds : 0.0) << " (" << faceTests << " total)" << std::endl;
+	out << "  ms/frame          integrate " << integrateTime * perFrame
+		<< ", pending " << pendingTime * perFrame
+		<< ", update " << updateTime * perFrame
+		<< ", response " << responseTime * perFrame
+		<< ", total " << totalTime * perFrame << std::endl;
+	out << "  tunneled          " << noTunneled() << std::endl;
+	if (checkPairs) {
+		out << "  pair check        ";
+		if (noPairMismatches) {
+			out << "FAILED, " << noPairMismatches << " of " << noFrames << " frames differ from brute force ("
+				<< noMissedPairs << " pairs missed, " << noExtraPairs << " extra)" << std::endl;
+		}
+		else {
+			out << "passed (" << noFrames << " frames)" << std::endl;
+		}
+	}
+}
+
+// get number of spheres that went through the street
+unsigned int Benchmark::noTunneled()
+{
+	unsigned int ret = 0;
+	for (bool t : tunneled) {
+		if (t) {
+			ret++;
+		}
+	}
+	return ret;
+}
+
+// free memory
+void Benchmark::cleanup()
+{
+	broadPhase->destroy();
+	delete broadPhase;
+
+	workers->cleanup();
+	delete workers;
+
+	NarrowPhase::cache = nullptr;
+	delete contactCache;
+
+	for (PhysicsModel* model : models) {
+		for (unsigned int i = 0; i < model->currentNoInstances; i++) {
+			delete model->instances[i];
+		}
+		delete model;
+	}
+	models.clear();
+
+	delete bumpsMesh;
+	bumpsMesh = nullptr;
+}
+
+/*
+	names
+*/
+
+// get name of scenario
+std::string Benchmark::scenarioName(Scenario scenario)
+{
+	return scenario == Scenario::BARRAGE ? "barrage" : "drop";
+}
+
+// get name of broad phase type
+std::string Benchmark::broadPhaseName(BroadPhaseType type)
+{
+	switch (type) {
+	case BroadPhaseType::SWEEP_AND_PRUNE:
+		return "sap";
+	case BroadPhaseType::AABB_TREE:
+		return "aabbtree";
+	case BroadPhaseType::LOOSE_OCTREE:
+		return "loose";
+	case BroadPhaseType::GRID_OCTREE:
+		return "grid";
+	case BroadPhaseType::SPLIT_OCTREE:
+		return "split";
+	case BroadPhaseType::OCTREE:
+	default:
+		return "octree";
+	}
+}
+
+/*
+	instance methods
+*/
+
+// generate instance of model and add it to the broad phase
+RigidBody* Benchmark::generateInstance(PhysicsModel* model, glm::vec3 size, float mass, glm::vec3 pos)
+{
+	RigidBody* rb = model->generateInstances(size, mass, pos, glm::vec3(0.0f));
+	if (rb) {
+		rb->bodyId = currentBodyId++;
+		rb->instanceId = std::to_string(rb->bodyId);
+		broadPhase->addToPending(rb, model);
+	}
+	return rb;
+}
+
+// spawn spheres of scenario for current frame
+void Benchmark::spawn()
+{
+	if (scenario == Scenario::DROP) {
+		// above the street between the buildings
+		std::uniform_real_distribution<float> x(-8.0f, 20.0f), y(1.0f, 8.0f), z(0.5f, 11.0f);
+
+		for (unsigned int i = 0; i < noBodies; i++) {
+			RigidBody* rb = generateInstance(sphere, glm::vec3(SPHERE_SCALE), SPHERE_MASS, glm::vec3(x(random), y(random), z(random)));
+			if (rb) {
+				rb->applyAcceleration(Environment::gravitationalAcceleration);
+			}
+		}
+	}
+	else {
+		// from across the start of the street towards the end building (launch points are spread so spheres do not spawn inside each other)
+		std::uniform_real_distribution<float> y(0.5f, 3.0f), z(1.0f, 10.5f), yaw(-0.5f, 0.5f), pitch(0.0f, 0.25f);
+
+		for (unsigned int i = 0; i < spawnRate; i++) {
+			glm::vec3 origin(-8.0f, y(random), z(random));
+			float a = yaw(random), b = pitch(random);
+			glm::vec3 dir(glm::cos(a) * glm::cos(b), glm::sin(b), glm::sin(a) * glm::cos(b));
+
+			RigidBody* rb = generateInstance(sphere, glm::vec3(SPHERE_SCALE), SPHERE_MASS, origin);
+			if (!rb) {
+				// all spheres launched
+				break;
+			}
+
+			rb->transferEnergy(LAUNCH_ENERGY, dir);
+			rb->applyAcceleration(Environment::gravitationalAcceleration);
+		}
+	}
+}
+
+// get pairs of regions in contact by testing all pairs with a moved instance, and the pairs swept this frame
+std::vector<unsigned long long> Benchmark::allPairs()
+{
+	// regions of all instances in world space
+	std::vector<BoundingRegion> regions;
+	for (PhysicsModel* model : models) {
+		for (unsigned int i = 0; i < model->currentNoInstances; i++) {
+			for (BoundingRegion br : model->boundingRegions) {
+				br.instance = model->instances[i];
+				br.transform();
+				regions.push_back(br);
+			}
+		}
+	}
+
+	// cached contacts are reused like in the broad phases (reading the cache does not change it), counters are restored afterwards
+	unsigned int noPairTests = Stats::counters[Stats::PAIR_TESTS].load();
+	unsigned int noFaceTests = Stats::counters[Stats::FACE_TESTS].load();
+
+	// every pair with a moved instance (the broad phases only test moved instances)
+	std::vector<unsigned long long> expected = contactCache->frameOrder;
+	for (unsigned int i = 0; i < regions.size(); i++) {
+		for (unsigned int j = i + 1; j < regions.size(); j++) {
+			RigidBody* a = regions[i].instance;
+			RigidBody* b = regions[j].instance;
+			if (a == b || (!States::isActive(&a->state, INSTANCE_MOVED) && !States::isActive(&b->state, INSTANCE_MOVED))) {
+				continue;
+			}
+
+			Contact contact;
+			if (regions[i].intersectsWith(regions[j]) && NarrowPhase::test(regions[i], regions[j], contact)) {
+				expected.push_back(ContactCache::pairKey(a, b));
+			}
+		}
+	}
+
+	Stats::counters[Stats::PAIR_TESTS].store(noPairTests);
+	Stats::counters[Stats::FACE_TESTS].store(noFaceTests);
+
+	return expected;
+}
+
+// compare the contact pairs of the frame with the pairs found by brute force
+void Benchmark::comparePairs(std::vector<unsigned long long>& expected)
+{
+	// sorted sets of pairs
+	std::vector<unsigned long long> found = contactCache->frameOrder;
+	for (std::vector<unsigned long long>* pairs : { &expected, &found }) {
+		std::sort(pairs->begin(), pairs->end());
+		pairs->erase(std::unique(pairs->begin(), pairs->end()), pairs->end());
+	}
+
+	std::vector<unsigned long long> missed, extra;
+	std::set_difference(expected.begin(), expected.end(), found.begin(), found.end(), std::back_inserter(missed));
+	std::set_difference(found.begin(), found.end(), expected.begin(), expected.end(), std::back_inserter(extra));
+	if (!missed.empty() || !extra.empty()) {
+		noPairMismatches++;
+		noMissedPairs += missed.size();
+		noExtraPairs += extra.size();
+	}
+}
@@ -0,0 +1,166 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <glm/glm.hpp>
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "algorithms/boxlist.h"
+#include "algorithms/broadphase.h"
+#include "algorithms/collisionstats.h"
+#include "algorithms/threadpool.h"
+
+#include "physics/collisionmesh.h"
+#include "physics/contactcache.h"
+#include "physics/physicsmodel.h"
+
+/*
+	enum for benchmark scenarios
+*/
+
+enum class Scenario : unsigned char {
+	DROP = 0x00,	// all spheres dropped into the street at once
+	BARRAGE = 0x01	// spheres launched from a fixed point every frame (like launchItem() in the game)
+};
+
+/*
+	class to run the physics and collision code of the game without a window
+	- the street is built from the same bounding regions as in main.cpp
+	- speed bumps on the road collide with a procedural mesh simplified through CollisionImport (the import path of the street models in main.cpp)
+	- the main loop of the game is followed each frame (integrate, pending, broad/narrow phase, responses)
+*/
+
+class Benchmark {
+public:
+	/*
+		settings
+	*/
+
+	// scenario to run
+	Scenario scenario = Scenario::DROP;
+	// broad phase structure
+	BroadPhaseType broadPhaseType = BroadPhaseType::SPLIT_OCTREE;
+	// number of spheres (spawned at once, or in total for a barrage)
+	unsigned int noBodies = 1000;
+	// number of frames to step
+	unsigned int noFrames = 600;
+	// spheres launched each frame in a barrage
+	unsigned int spawnRate = 4;
+	// fixed time step
+	float dt = 1.0f / 60.0f;
+	// if collisions are checked on the worker threads
+	bool parallel = false;
+	// if fast spheres are swept to their first contact (continuous collision detection)
+	bool continuous = false;
+	// seed of spawn positions and directions
+	unsigned int seed = 1;
+	// CSV file statistics of each frame are appended to (empty = not recorded)
+	std::string statsPath;
+	// if the contact pairs of each frame are compared with all pairs of regions tested by brute force (not timed)
+	bool checkPairs = false;
+
+	/*
+		results
+	*/
+
+	// statistics of last frame
+	CollisionStats stats;
+
+	// accumulated counters
+	unsigned long long pairTests;
+	unsigned long long faceTests;
+
+	// accumulated timings of phases (milliseconds)
+	double integrateTime;
+	double pendingTime;
+	double updateTime;
+	double responseTime;
+	// time of all steps (milliseconds)
+	double totalTime;
+
+	// pair tests of each frame
+	std::vector<unsigned int> framePairTests;
+	// positions of the spheres after the last step
+	std::vector<glm::vec3> positions;
+
+	// frames whose contact pairs differ from brute force (with checkPairs)
+	unsigned int noPairMismatches;
+	// pairs brute force found that the broad phase missed, and pairs only the broad phase found
+	unsigned long long noMissedPairs;
+	unsigned long long noExtraPairs;
+
+	// get number of spheres that went through the street
+	unsigned int noTunneled();
+
+	/*
+		process functions
+	*/
+
+	// create models, broad phase and initial instances
+	void init();
+
+	// step one frame
+	void step();
+
+	// step all frames
+	void run();
+
+	// print results
+	void report(std::ostream& out);
+
+	// free memory
+	void cleanup();
+
+	/*
+		names
+	*/
+
+	// get name of scenario
+	static std::string scenarioName(Scenario scenario);
+
+	// get name of broad phase type
+	static std::string broadPhaseName(BroadPhaseType type);
+
+private:
+	// models of street (static) and projectiles (dynamic)
+	std::vector<PhysicsModel*> models;
+	PhysicsModel* sphere;
+	// collision mesh of the speed bumps
+	CollisionMesh* bumpsMesh;
+
+	// collision structures
+	BroadPhase* broadPhase;
+	ThreadPool* workers;
+	ContactCache* contactCache;
+
+	// outlines written by the broad phase (discarded)
+	BoxList boxes;
+
+	// random values of spawned spheres
+	std::mt19937 random;
+
+	// if each sphere went through the road (same order as the instances)
+	std::vector<bool> tunneled;
+
+	// current frame
+	unsigned int frame;
+	// next integer body id
+	unsigned int currentBodyId;
+
+	// generate instance of model and add it to the broad phase
+	RigidBody* generateInstance(PhysicsModel* model, glm::vec3 size, float mass, glm::vec3 pos);
+
+	// spawn spheres of scenario for current frame
+	void spawn();
+
+	// get pairs of regions in contact by testing all pairs with a moved instance, and the pairs swept this frame
+	std::vector<unsigned long long> allPairs();
+
+	// compare the contact pairs of the frame with the pairs found by brute force
+	void comparePairs(std::vector<unsigned long long>& expected);
+};
+
+#endif // !BENCHMARK_H
@@ -0,0 +1,188 @@
+/*
+    headless physics/collision benchmark
+    - runs the physics, algorithms and bounds code of the game without a window or GL context
+    - usage: PhysicsBench [drop|barrage|verify] [--broadphase octree|sap|aabbtree|loose|grid|split|all]
+        [--bodies N] [--frames N] [--rate N] [--dt seconds] [--seed N] [--parallel] [--ccd] [--stats file.csv] [--check]
+    - --check runs each broad phase serially and on the workers and fails if they test different pairs or end in different positions,
+        or if the serial run finds different contact pairs than testing all pairs of regions by brute force
+    - verify checks the collision tests against reference versions on random inputs from the seed (see verify.h)
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "verify.h"
+
+// all broad phase types (for --broadphase all)
+const BroadPhaseType broadPhaseTypes[] = {
+    BroadPhaseType::OCTREE,
+    BroadPhaseType::SWEEP_AND_PRUNE,
+    BroadPhaseType::AABB_TREE,
+    BroadPhaseType::LOOSE_OCTREE,
+    BroadPhaseType::GRID_OCTREE,
+    BroadPhaseType::SPLIT_OCTREE
+};
+
+void printUsage();
+bool checkParallel(Benchmark& bench);
+
+int main(int argc, char** argv) {
+    Benchmark bench;
+    std::vector<BroadPhaseType> types = { bench.broadPhaseType };
+    // if serial and parallel runs are compared
+    bool check = false;
+    // if collision tests are verified instead of running a scenario
+    bool verify = false;
+
+    // parse arguments
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        // value of option
+        std::string val = i + 1 < argc ? argv[i + 1] : "";
+
+        if (arg == "drop") {
+            bench.scenario = Scenario::DROP;
+        }
+        else if (arg == "barrage") {
+            bench.scenario = Scenario::BARRAGE;
+        }
+        else if (arg == "verify") {
+            verify = true;
+        }
+        else if (arg == "--parallel") {
+            bench.parallel = true;
+        }
+        else if (arg == "--ccd") {
+            bench.continuous = true;
+        }
+        else if (arg == "--check") {
+            check = true;
+        }
+        else if (arg == "--broadphase" && !val.empty()) {
+            types.clear();
+            for (BroadPhaseType type : broadPhaseTypes) {
+                if (val == "all" || val == Benchmark::broadPhaseName(type)) {
+                    types.push_back(type);
+                }
+            }
+            if (types.empty()) {
+                std::cout << "Unknown broad phase " << val << std::endl;
+                printUsage();
+                return -1;
+            }
+            i++;
+        }
+        else if (arg == "--bodies" && !val.empty()) {
+            bench.noBodies = std::stoi(val);
+            i++;
+        }
+        else if (arg == "--frames" && !val.empty()) {
+            bench.noFrames = std::stoi(val);
+            i++;
+        }
+        else if (arg == "--rate" && !val.empty()) {
+            bench.spawnRate = std::stoi(val);
+            i++;
+        }
+        else if (arg == "--dt" && !val.empty()) {
+            bench.dt = std::stof(val);
+            i++;
+        }
+        else if (arg == "--seed" && !val.empty()) {
+            bench.seed = std::stoi(val);
+            i++;
+        }
+        else if (arg == "--stats" && !val.empty()) {
+            bench.statsPath = val;
+            i++;
+        }
+        else {
+            printUsage();
+            return -1;
+        }
+    }
+
+    if (verify) {
+        return Verify::run(bench.seed, std::cout) ? 0 : 1;
+    }
+
+    // run scenario with each broad phase
+    bool passed = true;
+    for (BroadPhaseType type : types) {
+        bench.broadPhaseType = type;
+
+        if (check) {
+            passed = checkParallel(bench) && passed;
+            continue;
+        }
+
+        bench.init();
+        bench.run();
+        bench.report(std::cout);
+        bench.cleanup();
+    }
+
+    return passed ? 0 : 1;
+}
+
+// run scenario serially (contact pairs compared with brute force) and on the workers,
+// returns if the pairs matched brute force, the same pairs were tested and the spheres ended in the same positions
+bool checkParallel(Benchmark& bench) {
+    // serial run
+    bench.parallel = false;
+    bench.checkPairs = true;
+    bench.init();
+    bench.run();
+    bench.report(std::cout);
+    bench.cleanup();
+
+    bool pairsPassed = bench.noPairMismatches == 0;
+    std::vector<unsigned int> framePairTests = bench.framePairTests;
+    std::vector<glm::vec3> positions = bench.positions;
+
+    // parallel run
+    bench.parallel = true;
+    bench.checkPairs = false;
+    bench.init();
+    bench.run();
+    bench.report(std::cout);
+    bench.cleanup();
+
+    // first frame with different pair tests
+    unsigned int frame = 0;
+    while (frame < framePairTests.size() && framePairTests[frame] == bench.framePairTests[frame]) {
+        frame++;
+    }
+
+    // spheres in different positions
+    unsigned int moved = 0;
+    for (unsigned int i = 0; i < positions.size() && i < bench.positions.size(); i++) {
+        if (positions[i] != bench.positions[i]) {
+            moved++;
+        }
+    }
+
+    std::cout << "  parallel check    ";
+    if (frame < framePairTests.size() || positions.size() != bench.positions.size() || moved) {
+        std::cout << "FAILED";
+        if (frame < framePairTests.size()) {
+            std::cout << ", pair tests differ from frame " << frame
+                << " (" << framePairTests[frame] << " serial, " << bench.framePairTests[frame] << " parallel)";
+        }
+        if (positions.size() != bench.positions.size() || moved) {
+            std::cout << ", " << moved << " spheres in different positions";
+        }
+        std::cout << std::endl;
+        return false;
+    }
+
+    std::cout << "passed" << std::endl;
+    return pairsPassed;
+}
+
+void printUsage() {
+    std::cout << "usage: PhysicsBench [drop|barrage|verify] [--broadphase octree|sap|aabbtree|loose|grid|split|all]" << std::endl
+        << "    [--bodies N] [--frames N] [--rate N] [--dt seconds] [--seed N] [--parallel] [--ccd] [--stats file.csv] [--check]" << std::endl;
+}
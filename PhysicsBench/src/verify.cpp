@@ -0,0 +1,1383 @@
+#include "verify.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <limits>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/gtc/quaternion.hpp>
+
+#include "algorithms/boxlist.h"
+#include "algorithms/math/linalg.h"
+#include "algorithms/meshsimplifier.h"
+#include "algorithms/octree.h"
+#include "algorithms/octreecache.h"
+#include "algorithms/ray.h"
+#include "algorithms/raypacket.h"
+#include "algorithms/ringbuffer.hpp"
+#include "algorithms/splitoctree.h"
+#include "algorithms/states.hpp"
+#include "algorithms/trianglebatch.h"
+#include "physics/bodystore.h"
+#include "physics/collisionmesh.h"
+#include "physics/gjk.h"
+#include "physics/narrowphase.h"
+#include "physics/physicsmodel.h"
+
+// number of random cases of each check
+unsigned int Verify::noCases = 100000;
+
+// random point in box [-size, size]^3
+static glm::vec3 randomPoint(std::mt19937& random, float size) {
+	std::uniform_real_distribution<float> u(-size, size);
+	float x = u(random), y = u(random), z = u(random);
+	return glm::vec3(x, y, z);
+}
+
+// random value in [min, max]
+static float randomValue(std::mt19937& random, float min, float max) {
+	return std::uniform_real_distribution<float>(min, max)(random);
+}
+
+// random vector with each component in [min, max]
+static glm::vec3 randomVector(std::mt19937& random, float min, float max) {
+	std::uniform_real_distribution<float> u(min, max);
+	float x = u(random), y = u(random), z = u(random);
+	return glm::vec3(x, y, z);
+}
+
+// terrain of n x n quads over [-10, 10]^2 (quads have their own corners if split, like UV seams everywhere)
+static void terrain(unsigned int n, bool split, std::vector<glm::vec3>& points, std::vector<unsigned int>& indices) {
+	auto height = [](float x, float z) -> float {
+		return 0.5f * std::sin(x) * std::cos(z);
+	};
+	auto corner = [&height, n](unsigned int i, unsigned int j) -> glm::vec3 {
+		float x = -10.0f + 20.0f * i / n;
+		float z = -10.0f + 20.0f * j / n;
+		return glm::vec3(x, height(x, z), z);
+	};
+
+	if (!split) {
+		for (unsigned int i = 0; i <= n; i++) {
+			for (unsigned int j = 0; j <= n; j++) {
+				points.push_back(corner(i, j));
+			}
+		}
+	}
+
+	for (unsigned int i = 0; i < n; i++) {
+		for (unsigned int j = 0; j < n; j++) {
+			unsigned int a, b, c, d;
+			if (split) {
+				a = (unsigned int)points.size();
+				b = a + 1;
+				c = a + 2;
+				d = a + 3;
+				points.push_back(corner(i, j));
+				points.push_back(corner(i, j + 1));
+				points.push_back(corner(i + 1, j));
+				points.push_back(corner(i + 1, j + 1));
+			}
+			else {
+				a = i * (n + 1) + j;
+				b = a + 1;
+				c = a + n + 1;
+				d = c + 1;
+			}
+			indices.insert(indices.end(), { a, c, b, b, c, d });
+		}
+	}
+}
+
+// box of six sides over [-1, 1]^3, each split into n x n quads with their own points
+static void griddedBox(unsigned int n, std::vector<glm::vec3>& points, std::vector<unsigned int>& indices) {
+	for (unsigned int side = 0; side < 6; side++) {
+		int axis = side / 2;
+		float sign = side % 2 ? 1.0f : -1.0f;
+		unsigned int base = (unsigned int)points.size();
+		for (unsigned int i = 0; i <= n; i++) {
+			for (unsigned int j = 0; j <= n; j++) {
+				glm::vec3 p;
+				p[axis] = sign;
+				p[(axis + 1) % 3] = -1.0f + 2.0f * i / n;
+				p[(axis + 2) % 3] = -1.0f + 2.0f * j / n;
+				points.push_back(p);
+			}
+		}
+		for (unsigned int i = 0; i < n; i++) {
+			for (unsigned int j = 0; j < n; j++) {
+				unsigned int a = base + i * (n + 1) + j, c = a + n + 1;
+				if (sign > 0.0f) {
+					indices.insert(indices.end(), { a, c, a + 1, a + 1, c, c + 1 });
+				}
+				else {
+					indices.insert(indices.end(), { a, a + 1, c, a + 1, c + 1, c });
+				}
+			}
+		}
+	}
+}
+
+// largest distance from noSamples random source points to the closest face of the simplified mesh
+static float maxError(std::mt19937& random, unsigned int noSamples, std::vector<glm::vec3>& source, std::vector<glm::vec3>& points, std::vector<unsigned int>& indices) {
+	std::uniform_int_distribution<size_t> sample(0, source.size() - 1);
+	float ret = 0.0f;
+	for (unsigned int i = 0; i < noSamples; i++) {
+		glm::vec3 p = source[sample(random)];
+		float closest = std::numeric_limits<float>::max();
+		for (size_t f = 0; f < indices.size(); f += 3) {
+			glm::vec3 q = closestPointOnTriangle(p, points[indices[f]], points[indices[f + 1]], points[indices[f + 2]]);
+			closest = std::min(closest, glm::length(q - p));
+		}
+		ret = std::max(ret, closest);
+	}
+	return ret;
+}
+
+// random oriented box region around point in [-size, size]^3 with half sizes in [min, max]
+static BoundingRegion randomOrientedBox(std::mt19937& random, float size, float min, float max) {
+	BoundingRegion ret(BoundTypes::OBB);
+	ret.center = randomPoint(random, size);
+	ret.axes = glm::mat3_cast(glm::quat(randomVector(random, 0.0f, 6.28f)));
+	ret.halfSize = randomVector(random, min, max);
+	return ret;
+}
+
+// random position in [-size, size]^3 whose sphere of radius is apart from the spheres (xyz = center, w = radius), its sphere is added
+static glm::vec3 freePosition(std::mt19937& random, float size, float radius, std::vector<glm::vec4>& spheres) {
+	while (true) {
+		glm::vec3 pos = randomPoint(random, size);
+		bool apart = true;
+		for (glm::vec4& sphere : spheres) {
+			if (glm::length(pos - glm::vec3(sphere)) <= radius + sphere.w) {
+				apart = false;
+				break;
+			}
+		}
+
+		if (apart) {
+			spheres.push_back(glm::vec4(pos, radius));
+			return pos;
+		}
+	}
+}
+
+// active octants of each node of the subtree in preorder, and the regions in the node (instance and center, sorted)
+static void treeObjects(Octree::node* current, std::vector<unsigned char>& octants, std::vector<std::vector<std::tuple<RigidBody*, float, float, float>>>& objects) {
+	octants.push_back(current->activeOctants);
+
+	std::vector<std::tuple<RigidBody*, float, float, float>> regions;
+	for (unsigned int obj : current->objects) {
+		BoundingRegion& br = (*current->pool)[obj];
+		glm::vec3 center = br.calculateCenter();
+		regions.push_back(std::make_tuple(br.instance, center.x, center.y, center.z));
+	}
+	std::sort(regions.begin(), regions.end());
+	objects.push_back(regions);
+
+	for (int i = 0; i < NO_CHILDREN; i++) {
+		if (States::isIndexActive(&current->activeOctants, i)) {
+			treeObjects(current->children[i], octants, objects);
+		}
+	}
+}
+
+// if values are the same up to a relative error
+static bool closeTo(float a, float b, float tolerance) {
+	return std::abs(a - b) <= tolerance * std::fmaxf(1.0f, std::abs(b));
+}
+
+// smallest component of vector
+static float minComponent(glm::vec3 v) {
+	return std::min(v.x, std::min(v.y, v.z));
+}
+
+// depth of sphere in box [-half, half] (negative = distance between them)
+static float sphereBoxDepth(glm::vec3 center, float radius, glm::vec3 half) {
+	glm::vec3 closest = glm::clamp(center, -half, half);
+	float dist = glm::length(center - closest);
+	if (dist > 0.0f) {
+		return radius - dist;
+	}
+
+	// center inside, push out through the closest face
+	return radius + minComponent(half - glm::abs(center));
+}
+
+/*
+	reference versions (the tests before they were replaced by closed forms)
+*/
+
+// represent point as linear combination of A, B and C by row reducing [A B C | point]
+static glm::vec3 rrefLinComb(glm::vec3 A, glm::vec3 B, glm::vec3 C, glm::vec3 point) {
+	glm::mat4x3 m(A, B, C, point);
+	rref<4, 3>(m);
+	return m[3];
+}
+
+// point in face spanned by A and B (row reduced)
+static bool rrefContains(glm::vec3 A, glm::vec3 B, glm::vec3 N, glm::vec3 point, float radius) {
+	glm::vec3 c = rrefLinComb(A, B, N, point);
+	return c[0] >= -radius && c[1] >= -radius && c[0] + c[1] <= 1.0f + radius;
+}
+
+// ray against triangle with the plane intersection and the row reduced containment test
+static bool rrefRayTriangle(glm::vec3 origin, glm::vec3 dir, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3, float& t) {
+	glm::vec3 A = P2 - P1;
+	glm::vec3 B = P3 - P1;
+	glm::vec3 N = glm::cross(A, B);
+	glm::vec3 U1 = origin - P1;
+
+	float tPlane;
+	LinePlaneIntCase intCase = linePlaneIntersection(glm::vec3(0.0f), N, U1, dir, tPlane);
+	if ((char)intCase > 1 && tPlane >= 0.0f && rrefContains(A, B, N, U1 + tPlane * dir, 0.0f)) {
+		t = tPlane;
+		return true;
+	}
+	return false;
+}
+
+// if an edge of triangle U crosses triangle P (the face-face test before Guigue-Devillers)
+static bool edgesCrossFace(glm::vec3 P1, glm::vec3 P2, glm::vec3 P3, glm::vec3 U1, glm::vec3 U2, glm::vec3 U3) {
+	// P1 is the origin
+	P2 -= P1;
+	P3 -= P1;
+	U1 -= P1;
+	U2 -= P1;
+	U3 -= P1;
+	glm::vec3 norm = glm::cross(P2, P3);
+
+	glm::vec3 sideOrigins[3] = { U1, U1, U2 };
+	glm::vec3 sides[3] = { U2 - U1, U3 - U1, U3 - U2 };
+	for (unsigned int i = 0; i < 3; i++) {
+		float t = 0.0f;
+		LinePlaneIntCase intCase = linePlaneIntersection(glm::vec3(0.0f), norm, sideOrigins[i], sides[i], t);
+		if (intCase == LinePlaneIntCase::CASE2 && rrefContains(P2, P3, norm, sideOrigins[i] + t * sides[i], 0.0f)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// if coplanar triangles in the xy plane intersect (edges cross or one holds a corner of the other)
+static bool coplanarIntersect(glm::vec2* P, glm::vec2* U) {
+	auto cross = [](glm::vec2 a, glm::vec2 b) -> float {
+		return a.x * b.y - a.y * b.x;
+	};
+
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			glm::vec2 a = P[i], b = P[(i + 1) % 3], c = U[j], d = U[(j + 1) % 3];
+			float den = cross(b - a, d - c);
+			if (den != 0.0f) {
+				float s = cross(c - a, d - c) / den;
+				float t = cross(c - a, b - a) / den;
+				if (s >= 0.0f && s <= 1.0f && t >= 0.0f && t <= 1.0f) {
+					return true;
+				}
+			}
+		}
+	}
+
+	auto contains = [&cross](glm::vec2* T, glm::vec2 p) -> bool {
+		float a = cross(T[1] - T[0], p - T[0]);
+		float b = cross(T[2] - T[1], p - T[1]);
+		float c = cross(T[0] - T[2], p - T[2]);
+		return (a >= 0.0f && b >= 0.0f && c >= 0.0f) || (a <= 0.0f && b <= 0.0f && c <= 0.0f);
+	};
+	return contains(P, U[0]) || contains(U, P[0]);
+}
+
+/*
+	checks
+*/
+
+// closed-form point in face test against the row reduced linear combination
+bool Verify::pointInFace(std::mt19937& random, std::ostream& out) {
+	unsigned int noMismatches = 0;
+	for (unsigned int i = 0; i < noCases; i++) {
+		glm::vec3 A = randomPoint(random, 1.0f);
+		glm::vec3 B = randomPoint(random, 1.0f);
+		glm::vec3 N = glm::cross(A, B);
+		glm::vec3 p = randomPoint(random, 1.0f);
+		float radius = i % 2 ? 0.0f : 0.1f;
+
+		if (faceContainsPointRange(A, B, N, p, radius) != rrefContains(A, B, N, p, radius)) {
+			noMismatches++;
+		}
+	}
+
+	return report(out, "point in face", noMismatches, noCases);
+}
+
+// closed-form ray-triangle test against the plane intersection and row reduced containment test
+bool Verify::rayTriangle(std::mt19937& random, std::ostream& out) {
+	unsigned int noMismatches = 0;
+	for (unsigned int i = 0; i < noCases; i++) {
+		glm::vec3 origin = randomPoint(random, 2.0f);
+		glm::vec3 dir = randomPoint(random, 1.0f);
+		glm::vec3 P1 = randomPoint(random, 1.0f);
+		glm::vec3 P2 = randomPoint(random, 1.0f);
+		glm::vec3 P3 = randomPoint(random, 1.0f);
+
+		float t = -1.0f, tRef = -1.0f;
+		bool hit = rayTriangleIntersection(origin, dir, P1, P2, P3, t);
+		bool hitRef = rrefRayTriangle(origin, dir, P1, P2, P3, tRef);
+		if (hit != hitRef || (hit && std::abs(t - tRef) > 1e-4f)) {
+			noMismatches++;
+		}
+	}
+
+	return report(out, "ray-triangle", noMismatches, noCases);
+}
+
+// Guigue-Devillers triangle-triangle test against the old edge test run in both directions (2D edge test for coplanar faces)
+bool Verify::triangleTriangle(std::mt19937& random, std::ostream& out) {
+	unsigned int noMismatches = 0;
+	for (unsigned int i = 0; i < noCases; i++) {
+		glm::vec3 P[3], U[3];
+		for (int j = 0; j < 3; j++) {
+			P[j] = randomPoint(random, 1.0f);
+			U[j] = randomPoint(random, 1.0f);
+		}
+
+		bool hit = triangleTriangleIntersection(P[0], P[1], P[2], U[0], U[1], U[2]);
+		bool hitRef = edgesCrossFace(P[0], P[1], P[2], U[0], U[1], U[2]) || edgesCrossFace(U[0], U[1], U[2], P[0], P[1], P[2]);
+		if (hit != hitRef) {
+			noMismatches++;
+		}
+	}
+
+	// coplanar faces (in the xy plane)
+	std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+	for (unsigned int i = 0; i < noCases; i++) {
+		glm::vec2 P2[3], U2[3];
+		glm::vec3 P[3], U[3];
+		for (int j = 0; j < 3; j++) {
+			P2[j] = glm::vec2(u(random), u(random));
+			U2[j] = glm::vec2(u(random), u(random)) + 0.8f;
+			P[j] = glm::vec3(P2[j], 0.0f);
+			U[j] = glm::vec3(U2[j], 0.0f);
+		}
+
+		if (triangleTriangleIntersection(P[0], P[1], P[2], U[0], U[1], U[2]) != coplanarIntersect(P2, U2)) {
+			noMismatches++;
+		}
+	}
+
+	return report(out, "triangle-triangle", noMismatches, 2 * noCases);
+}
+
+// SIMD ray test of triangle batches against scalar Moller-Trumbore of each face
+bool Verify::triangleBatch(std::mt19937& random, std::ostream& out) {
+	unsigned int noMismatches = 0;
+	unsigned int noBatches = noCases / TRIANGLE_BATCH_SIZE;
+	std::uniform_int_distribution<unsigned int> noFaces(1, TRIANGLE_BATCH_SIZE);
+
+	TriangleBatch batch;
+	for (unsigned int i = 0; i < noBatches; i++) {
+		glm::vec3 origin = randomPoint(random, 2.0f);
+		glm::vec3 dir = randomPoint(random, 1.0f);
+
+		// closest hit of the faces one by one
+		batch.clear();
+		bool hitRef = false;
+		float tRef = 0.0f;
+		for (unsigned int j = 0, n = noFaces(random); j < n; j++) {
+			glm::vec3 P1 = randomPoint(random, 1.0f);
+			glm::vec3 P2 = randomPoint(random, 1.0f);
+			glm::vec3 P3 = randomPoint(random, 1.0f);
+			batch.add(P1, P2, P3);
+
+			float t;
+			if (rayTriangleIntersection(origin, dir, P1, P2, P3, t) && (!hitRef || t < tRef)) {
+				tRef = t;
+				hitRef = true;
+			}
+		}
+
+		float t = 0.0f;
+		bool hit = batch.intersectsRay(origin, dir, t);
+		if (hit != hitRef || (hit && std::abs(t - tRef) > 1e-4f)) {
+			noMismatches++;
+		}
+	}
+
+	return report(out, "triangle batch", noMismatches, noBatches);
+}
+
+// GJK/EPA of sphere, box, hull and capsule pairs against closed-form distances and depths (a tenth of the cases for each pair)
+bool Verify::convexShapes(std::mt19937& random, std::ostream& out) {
+	unsigned int noPairs = noCases / 10;
+	bool passed = true;
+
+	// sphere-sphere (hit, depth, normal and distance)
+	unsigned int noMismatches = 0;
+	for (unsigned int i = 0; i < noPairs; i++) {
+		glm::vec3 a = randomPoint(random, 2.0f);
+		glm::vec3 b = randomPoint(random, 2.0f);
+		float ra = randomValue(random, 0.1f, 1.5f);
+		float rb = randomValue(random, 0.1f, 1.5f);
+		float dist = glm::length(a - b);
+
+		ConvexShape A = GJK::sphere(a, ra), B = GJK::sphere(b, rb);
+		ConvexContact contact;
+		bool hit = GJK::collide(A, B, contact);
+		glm::vec3 pointA, pointB;
+		float gap = GJK::distance(A, B, pointA, pointB);
+
+		bool ok = hit == (dist <= ra + rb) && std::abs(gap - std::max(0.0f, dist - ra - rb)) < 1e-4f;
+		if (ok && hit && dist > 1e-3f) {
+			ok = std::abs(contact.depth - (ra + rb - dist)) < 1e-4f
+				&& glm::dot(contact.norm, glm::normalize(a - b)) > 0.9999f;
+		}
+		if (!ok) {
+			noMismatches++;
+		}
+	}
+	passed = report(out, "sphere-sphere", noMismatches, noPairs) && passed;
+
+	// box-box (hit, depth and axis of the normal, distance when apart)
+	noMismatches = 0;
+	for (unsigned int i = 0; i < noPairs; i++) {
+		glm::vec3 ca = randomPoint(random, 2.0f), ha = randomVector(random, 0.1f, 1.5f);
+		glm::vec3 cb = randomPoint(random, 2.0f), hb = randomVector(random, 0.1f, 1.5f);
+		glm::vec3 overlap = ha + hb - glm::abs(ca - cb);
+		float depth = minComponent(overlap);
+
+		ConvexShape A = GJK::box(ca - ha, ca + ha), B = GJK::box(cb - hb, cb + hb);
+		ConvexContact contact;
+		bool hit = GJK::collide(A, B, contact);
+
+		bool ok = hit == (depth >= 0.0f);
+		if (ok && hit) {
+			int axis = overlap.x == depth ? 0 : (overlap.y == depth ? 1 : 2);
+			ok = std::abs(contact.depth - depth) < 2e-3f
+				&& std::abs(contact.norm[axis]) > 0.999f
+				&& contact.norm[axis] * (ca[axis] - cb[axis]) >= 0.0f;
+		}
+		else if (ok) {
+			glm::vec3 pointA, pointB;
+			float gap = GJK::distance(A, B, pointA, pointB);
+			ok = std::abs(gap - glm::length(glm::max(-overlap, glm::vec3(0.0f)))) < 1e-3f;
+		}
+		if (!ok) {
+			noMismatches++;
+		}
+	}
+	passed = report(out, "box-box", noMismatches, noPairs) && passed;
+
+	// sphere-box (hit and depth)
+	noMismatches = 0;
+	for (unsigned int i = 0; i < noPairs; i++) {
+		glm::vec3 cb = randomPoint(random, 1.0f), hb = randomVector(random, 0.2f, 1.5f);
+		glm::vec3 s = randomPoint(random, 3.0f);
+		float r = randomValue(random, 0.1f, 1.0f);
+		float depth = sphereBoxDepth(s - cb, r, hb);
+
+		ConvexShape A = GJK::sphere(s, r), B = GJK::box(cb - hb, cb + hb);
+		ConvexContact contact;
+		bool hit = GJK::collide(A, B, contact);
+
+		if (hit != (depth >= 0.0f) || (hit && std::abs(contact.depth - depth) >= 2e-3f)) {
+			noMismatches++;
+		}
+	}
+	passed = report(out, "sphere-box", noMismatches, noPairs) && passed;
+
+	// unit cube as a collision mesh
+	float cubePoints[] = {
+		-1.0f, -1.0f, -1.0f,	1.0f, -1.0f, -1.0f,	1.0f, 1.0f, -1.0f,	-1.0f, 1.0f, -1.0f,
+		-1.0f, -1.0f, 1.0f,		1.0f, -1.0f, 1.0f,	1.0f, 1.0f, 1.0f,	-1.0f, 1.0f, 1.0f
+	};
+	unsigned int cubeFaces[] = {
+		0, 2, 1,	0, 3, 2,	4, 5, 6,	4, 6, 7,
+		0, 1, 5,	0, 5, 4,	2, 3, 7,	2, 7, 6,
+		1, 2, 6,	1, 6, 5,	0, 4, 7,	0, 7, 3
+	};
+	CollisionMesh cube(8, cubePoints, 12, cubeFaces);
+
+	// rotated hull-sphere (hit and depth in the frame of the hull)
+	noMismatches = cube.convex ? 0 : 1;
+	for (unsigned int i = 0; i < noPairs / 2; i++) {
+		BodyStore store(1);
+		RigidBody body(&store, store.add(glm::vec3(1.0f), 1.0f, randomPoint(random, 1.0f), randomVector(random, 0.0f, 6.28f)));
+		glm::vec3 s = randomPoint(random, 3.0f);
+		float r = randomValue(random, 0.1f, 1.0f);
+		glm::vec3 local = glm::vec3(glm::inverse(body.getModel()) * glm::vec4(s, 1.0f));
+		float depth = sphereBoxDepth(local, r, glm::vec3(1.0f));
+
+		ConvexShape A = GJK::sphere(s, r), B = GJK::hull(&cube, &body);
+		ConvexContact contact;
+		bool hit = GJK::collide(A, B, contact);
+
+		if (hit != (depth >= 0.0f) || (hit && std::abs(contact.depth - depth) >= 2e-3f)) {
+			noMismatches++;
+		}
+	}
+	passed = report(out, "hull-sphere", noMismatches, noPairs / 2) && passed;
+
+	// hull-hull against the hull-box test with the same cubes
+	noMismatches = 0;
+	for (unsigned int i = 0; i < noPairs / 2; i++) {
+		BodyStore store(2);
+		RigidBody b1(&store, store.add(glm::vec3(1.0f), 1.0f, randomPoint(random, 2.0f), glm::vec3(0.0f)));
+		RigidBody b2(&store, store.add(glm::vec3(1.0f), 1.0f, randomPoint(random, 2.0f), glm::vec3(0.0f)));
+
+		ConvexShape A = GJK::hull(&cube, &b1), B = GJK::hull(&cube, &b2);
+		ConvexShape C = GJK::box(b2.getPos() - 1.0f, b2.getPos() + 1.0f);
+		ConvexContact c1, c2;
+		bool h1 = GJK::collide(A, B, c1);
+		bool h2 = GJK::collide(A, C, c2);
+
+		if (h1 != h2 || (h1 && std::abs(c1.depth - c2.depth) >= 2e-3f)) {
+			noMismatches++;
+		}
+	}
+	passed = report(out, "hull-hull", noMismatches, noPairs / 2) && passed;
+
+	// capsule-sphere (hit and depth)
+	noMismatches = 0;
+	for (unsigned int i = 0; i < noPairs; i++) {
+		glm::vec3 a = randomPoint(random, 2.0f), b = randomPoint(random, 2.0f);
+		glm::vec3 s = randomPoint(random, 3.0f);
+		float r1 = randomValue(random, 0.1f, 1.0f);
+		float r2 = randomValue(random, 0.1f, 1.0f);
+		glm::vec3 ab = b - a;
+		float t = glm::clamp(glm::dot(s - a, ab) / glm::dot(ab, ab), 0.0f, 1.0f);
+		float dist = glm::length(s - (a + t * ab));
+
+		ConvexShape A = GJK::capsule(a, b, r1), B = GJK::sphere(s, r2);
+		ConvexContact contact;
+		bool hit = GJK::collide(A, B, contact);
+
+		if (hit != (dist <= r1 + r2) || (hit && dist > 1e-3f && std::abs(contact.depth - (r1 + r2 - dist)) >= 1e-3f)) {
+			noMismatches++;
+		}
+	}
+	passed = report(out, "capsule-sphere", noMismatches, noPairs) && passed;
+
+	return passed;
+}
+
+// separating axis, sphere and ray slab tests of oriented boxes against GJK, closest points and rays in the frame of the box (a tenth of the cases each)
+bool Verify::orientedBoxes(std::mt19937& random, std::ostream& out) {
+	unsigned int noPairs = noCases / 10;
+	// cases closer than this to touching can go either way
+	float margin = 1e-3f;
+	unsigned int noChecked;
+	bool passed = true;
+
+	// separating axis test against GJK (distance when apart, depth when overlapping)
+	unsigned int noMismatches = 0;
+	noChecked = 0;
+	for (unsigned int i = 0; i < noPairs; i++) {
+		BoundingRegion a = randomOrientedBox(random, 2.0f, 0.1f, 1.0f);
+		BoundingRegion b = randomOrientedBox(random, 2.0f, 0.1f, 1.0f);
+		if (i % 4 == 0) {
+			// axis aligned against oriented
+			glm::vec3 half = randomVector(random, 0.1f, 1.0f);
+			a = BoundingRegion(a.center - half, a.center + half);
+		}
+
+		ConvexShape A = GJK::region(a), B = GJK::region(b);
+		ConvexContact contact;
+		glm::vec3 pointA, pointB;
+		bool hitRef = GJK::collide(A, B, contact);
+		if ((hitRef && contact.depth < margin) || (!hitRef && GJK::distance(A, B, pointA, pointB) < margin)) {
+			continue;
+		}
+
+		noChecked++;
+		if (a.intersectsWith(b) != hitRef || b.intersectsWith(a) != hitRef) {
+			noMismatches++;
+		}
+	}
+	passed = report(out, "box-box SAT", noMismatches, noChecked) && passed;
+
+	// sphere against the closest point of the box (found with the inverse of its axes)
+	noMismatches = 0;
+	noChecked = 0;
+	for (unsigned int i = 0; i < noPairs; i++) {
+		BoundingRegion box = randomOrientedBox(random, 1.0f, 0.1f, 1.0f);
+		BoundingRegion sphere(randomPoint(random, 2.5f), randomValue(random, 0.1f, 1.0f));
+
+		glm::vec3 local = glm::inverse(box.axes) * (sphere.center - box.center);
+		glm::vec3 closest = box.center + box.axes * glm::clamp(local, -box.halfSize, box.halfSize);
+		float dist = glm::length(sphere.center - closest);
+		if (std::abs(dist - sphere.radius) < margin) {
+			continue;
+		}
+
+		noChecked++;
+		bool hitRef = dist <= sphere.radius;
+		if (sphere.intersectsWith(box) != hitRef || box.intersectsWith(sphere) != hitRef) {
+			noMismatches++;
+		}
+	}
+	passed = report(out, "sphere-box", noMismatches, noChecked) && passed;
+
+	// ray slab test against the slab test of the ray moved into the frame of the box
+	noMismatches = 0;
+	noChecked = 0;
+	for (unsigned int i = 0; i < noPairs; i++) {
+		BoundingRegion box = randomOrientedBox(random, 1.0f, 0.1f, 1.0f);
+		Ray r(randomPoint(random, 3.0f), randomPoint(random, 1.0f));
+
+		glm::mat3 toLocal = glm::inverse(box.axes);
+		Ray local(toLocal * (r.origin - box.center), toLocal * r.dir);
+		BoundingRegion localBox(-box.halfSize, box.halfSize);
+
+		float tmin, tmax, tminRef, tmaxRef;
+		bool hit = r.intersectsBoundingRegion(box, tmin, tmax);
+		bool hitRef = local.intersectsBoundingRegion(localBox, tminRef, tmaxRef);
+		if (hitRef && tmaxRef - tminRef < margin) {
+			// grazes an edge or a corner
+			continue;
+		}
+
+		noChecked++;
+		if (hit != hitRef || (hit && (std::abs(tmin - tminRef) > margin || std::abs(tmax - tmaxRef) > margin))) {
+			noMismatches++;
+		}
+	}
+	passed = report(out, "box ray slab", noMismatches, noChecked) && passed;
+
+	return passed;
+}
+
+// SIMD packet tests of boxes, oriented boxes and spheres against the closest hit of each ray with the scalar test (a third of the cases each)
+bool Verify::rayPackets(std::mt19937& random, std::ostream& out) {
+	const char* names[] = { "ray packet box", "ray packet OBB", "ray packet sphere" };
+	// regions each packet is tested against
+	const unsigned int noRegions = 4;
+	// closer hits than this (or shorter spans through a region) can go either way
+	float margin = 1e-3f;
+	bool passed = true;
+
+	for (int type = 0; type < 3; type++) {
+		unsigned int noMismatches = 0;
+		unsigned int noChecked = 0;
+		for (unsigned int i = 0; i < noCases / 3; i += RAY_PACKET_MAX) {
+			std::vector<BoundingRegion> regions;
+			for (unsigned int j = 0; j < noRegions; j++) {
+				if (type == 0) {
+					glm::vec3 center = randomPoint(random, 1.5f);
+					glm::vec3 half = randomVector(random, 0.1f, 1.0f);
+					regions.push_back(BoundingRegion(center - half, center + half));
+				}
+				else if (type == 1) {
+					regions.push_back(randomOrientedBox(random, 1.5f, 0.1f, 1.0f));
+				}
+				else {
+					regions.push_back(BoundingRegion(randomPoint(random, 1.5f), randomValue(random, 0.1f, 1.0f)));
+				}
+			}
+
+			// partly filled packets leave lanes of the last SIMD block unused
+			RayPacket packet;
+			unsigned int count = 1 + random() % RAY_PACKET_MAX;
+			for (unsigned int j = 0; j < count; j++) {
+				Ray r(randomPoint(random, 3.0f), randomPoint(random, 1.0f));
+				packet.add(r);
+			}
+			for (BoundingRegion& br : regions) {
+				packet.testRegion(br, packet.activeMask());
+			}
+
+			for (unsigned int j = 0; j < count; j++) {
+				Ray r = packet.getRay(j);
+
+				// closest hit of the scalar test, skips rays grazing a region or with two hits close together
+				float tRef = std::numeric_limits<float>::max();
+				BoundingRegion* hitRef = nullptr;
+				std::vector<float> entries;
+				bool ambiguous = false;
+				for (BoundingRegion& br : regions) {
+					float tmin, tmax;
+					if (r.intersectsBoundingRegion(br, tmin, tmax)) {
+						ambiguous = ambiguous || tmax - tmin < margin || std::abs(tmax) < margin;
+						entries.push_back(tmin);
+					}
+					if (r.intersectsRegion(br, tRef)) {
+						hitRef = &br;
+					}
+				}
+				std::sort(entries.begin(), entries.end());
+				for (unsigned int k = 1; k < entries.size(); k++) {
+					ambiguous = ambiguous || entries[k] - entries[k - 1] < margin;
+				}
+				if (ambiguous) {
+					continue;
+				}
+
+				noChecked++;
+				if (packet.hits[j] != hitRef || (hitRef && std::abs(packet.t[j] - tRef) > margin * std::fmaxf(1.0f, std::abs(tRef)))) {
+					noMismatches++;
+				}
+			}
+		}
+		passed = report(out, names[type], noMismatches, noChecked) && passed;
+	}
+
+	return passed;
+}
+
+// box, sphere, k-nearest and ray queries of the octree, loose octree and split octree, and box and ray queries of sweep and prune, against brute force over all regions (a hundredth of the cases for each structure)
+bool Verify::octreeQueries(std::mt19937& random, std::ostream& out) {
+	const BroadPhaseType types[] = { BroadPhaseType::OCTREE, BroadPhaseType::LOOSE_OCTREE, BroadPhaseType::SPLIT_OCTREE, BroadPhaseType::SWEEP_AND_PRUNE };
+	// instances of each model, and of boxes outside of the world bounds (kept in the root)
+	const unsigned int noInstances = 150;
+	const unsigned int noFar = 8;
+	// distances closer than this are the same
+	float margin = 1e-4f;
+	// closer ray hits than this (relative to the distance) can go either way
+	float rayMargin = 1e-3f;
+
+	unsigned int noBoxMismatches = 0, noSphereMismatches = 0, noNearestMismatches = 0, noRayMismatches = 0;
+	unsigned int noChecked = 0, noTreeChecked = 0, noRays = 0;
+	for (BroadPhaseType type : types) {
+		// boxes never move (static tree of the split octree), oriented boxes and spheres are moved after the build
+		PhysicsModel boxes("boxes", noInstances, CONST_INSTANCES);
+		boxes.boundingRegions.push_back(BoundingRegion(glm::vec3(-1.0f), glm::vec3(1.0f)));
+		PhysicsModel oriented("oriented", noInstances, DYNAMIC);
+		oriented.boundingRegions.push_back(BoundingRegion(glm::vec3(-1.0f), glm::vec3(1.0f), BoundTypes::OBB));
+		PhysicsModel balls("balls", noInstances, DYNAMIC);
+		balls.boundingRegions.push_back(BoundingRegion(glm::vec3(0.0f), 1.0f));
+		PhysicsModel far("far", noFar, CONST_INSTANCES);
+		far.boundingRegions.push_back(BoundingRegion(glm::vec3(-1.0f), glm::vec3(1.0f)));
+		PhysicsModel* models[] = { &boxes, &oriented, &balls, &far };
+
+		Octree::node* root = nullptr;
+		BroadPhase* broadPhase = BroadPhase::create(type, &root);
+		SplitOctree* split = type == BroadPhaseType::SPLIT_OCTREE ? static_cast<SplitOctree*>(broadPhase) : nullptr;
+		BoxList boxList;
+
+		// instances are apart from each other, so no contacts are resolved while building and updating
+		std::vector<glm::vec4> spheres;
+		for (PhysicsModel* model : { &boxes, &oriented, &balls }) {
+			for (unsigned int i = 0; i < noInstances; i++) {
+				glm::vec3 size = randomVector(random, 0.2f, 1.0f);
+				glm::vec3 pos = freePosition(random, 30.0f, glm::length(size), spheres);
+				RigidBody* rb = model->generateInstances(size, 1.0f, pos, randomVector(random, 0.0f, 6.28f));
+				broadPhase->addToPending(rb, model);
+			}
+		}
+		// beyond the loose region of the root on one axis
+		for (unsigned int i = 0; i < noFar; i++) {
+			glm::vec3 pos = randomPoint(random, WORLD_BOUNDS);
+			pos[i % 3] = (i & 4 ? -2.5f : 2.5f) * WORLD_BOUNDS;
+			RigidBody* rb = far.generateInstances(randomVector(random, 5.0f, 15.0f), 1.0f, pos, glm::vec3(0.0f));
+			broadPhase->addToPending(rb, &far);
+		}
+		broadPhase->update(boxList);
+
+		// move the moving instances across the tree
+		spheres.resize(noInstances);
+		for (PhysicsModel* model : { &oriented, &balls }) {
+			for (unsigned int i = 0; i < model->currentNoInstances; i++) {
+				RigidBody* rb = model->instances[i];
+				rb->setPos(freePosition(random, 30.0f, glm::length(rb->getSize()), spheres));
+				rb->setRot(randomVector(random, 0.0f, 6.28f));
+				States::activate(&rb->state, INSTANCE_MOVED);
+			}
+		}
+		broadPhase->update(boxList);
+
+		// regions of all instances in world space
+		std::vector<BoundingRegion> regions;
+		for (PhysicsModel* model : models) {
+			for (unsigned int i = 0; i < model->currentNoInstances; i++) {
+				BoundingRegion br = model->boundingRegions[0];
+				br.instance = model->instances[i];
+				br.transform();
+				regions.push_back(br);
+			}
+		}
+
+		for (unsigned int i = 0; i < noCases / 100; i++) {
+			noChecked++;
+			std::vector<RigidBody*> found, expected;
+			auto gather = [&found](BoundingRegion& br) -> void {
+				found.push_back(br.instance);
+			};
+
+			// box query
+			glm::vec3 center = randomPoint(random, 36.0f);
+			glm::vec3 half = randomVector(random, 0.5f, 16.0f);
+			BoundingRegion box(center - half, center + half);
+			broadPhase->queryBox(box.min, box.max, gather);
+			for (BoundingRegion& br : regions) {
+				if (box.intersectsWith(br)) {
+					expected.push_back(br.instance);
+				}
+			}
+			std::sort(found.begin(), found.end());
+			std::sort(expected.begin(), expected.end());
+			if (found != expected) {
+				noBoxMismatches++;
+			}
+
+			// closest hit, any hit and packet of rays from inside and outside of the world bounds
+			RayPacket packet;
+			for (unsigned int j = 0; j < RAY_PACKET_MAX; j++) {
+				Ray r(randomPoint(random, 3.0f * WORLD_BOUNDS), randomPoint(random, 1.0f));
+				packet.add(r);
+			}
+			broadPhase->checkCollisionsPacket(packet);
+			for (unsigned int j = 0; j < RAY_PACKET_MAX; j++) {
+				Ray r = packet.getRay(j);
+
+				// closest hit of all regions, skips rays with two hits close together
+				float tRef = std::numeric_limits<float>::max();
+				RigidBody* hitRef = nullptr;
+				std::vector<float> entries;
+				for (BoundingRegion& br : regions) {
+					float tmin, tmax;
+					if (r.intersectsBoundingRegion(br, tmin, tmax) && tmax >= 0.0f) {
+						entries.push_back(std::fmaxf(tmin, 0.0f));
+					}
+					if (r.intersectsRegion(br, tRef)) {
+						hitRef = br.instance;
+					}
+				}
+				std::sort(entries.begin(), entries.end());
+				bool ambiguous = false;
+				for (unsigned int k = 1; k < entries.size(); k++) {
+					ambiguous = ambiguous || entries[k] - entries[k - 1] < rayMargin * std::fmaxf(1.0f, entries[k]);
+				}
+				if (ambiguous) {
+					continue;
+				}
+
+				noRays++;
+				float t = std::numeric_limits<float>::max();
+				BoundingRegion* hit = broadPhase->checkCollisionsRay(r, t);
+				BoundingRegion* any = broadPhase->checkCollisionsRayAny(r, std::numeric_limits<float>::max());
+				float tolerance = rayMargin * std::fmaxf(1.0f, tRef);
+				if ((hit ? hit->instance : nullptr) != hitRef || (hitRef && std::abs(t - tRef) > tolerance) ||
+					(any != nullptr) != (hitRef != nullptr) ||
+					(packet.hits[j] ? packet.hits[j]->instance : nullptr) != hitRef || (hitRef && std::abs(packet.t[j] - tRef) > tolerance)) {
+					noRayMismatches++;
+				}
+			}
+
+			if (!root && !split) {
+				// sphere and nearest queries are only in the octrees
+				continue;
+			}
+			noTreeChecked++;
+
+			// sphere query
+			found.clear();
+			expected.clear();
+			BoundingRegion sphere(randomPoint(random, 36.0f), randomValue(random, 0.5f, 16.0f));
+			if (split) {
+				split->querySphere(sphere.center, sphere.radius, gather);
+			}
+			else {
+				root->querySphere(sphere.center, sphere.radius, gather);
+			}
+			for (BoundingRegion& br : regions) {
+				if (sphere.intersectsWith(br)) {
+					expected.push_back(br.instance);
+				}
+			}
+			std::sort(found.begin(), found.end());
+			std::sort(expected.begin(), expected.end());
+			if (found != expected) {
+				noSphereMismatches++;
+			}
+
+			// k nearest, distances have to match the k smallest and the distance of each region found
+			glm::vec3 point = randomPoint(random, 36.0f);
+			unsigned int k = 1 + random() % 16;
+			std::vector<std::pair<float, RigidBody*>> nearest;
+			auto gatherNearest = [&nearest](BoundingRegion& br, float dist) -> void {
+				nearest.push_back({ dist, br.instance });
+			};
+			if (split) {
+				split->queryNearest(point, k, gatherNearest);
+			}
+			else {
+				root->queryNearest(point, k, gatherNearest);
+			}
+
+			std::unordered_map<RigidBody*, float> distances;
+			std::vector<float> sorted;
+			for (BoundingRegion& br : regions) {
+				float dist = Octree::distanceToRegion(point, br);
+				distances[br.instance] = dist;
+				sorted.push_back(dist);
+			}
+			std::sort(sorted.begin(), sorted.end());
+
+			bool matches = nearest.size() == std::min((size_t)k, sorted.size());
+			for (unsigned int j = 0; matches && j < nearest.size(); j++) {
+				matches = std::abs(nearest[j].first - sorted[j]) <= margin &&
+					std::abs(nearest[j].first - distances[nearest[j].second]) <= margin;
+			}
+			if (!matches) {
+				noNearestMismatches++;
+			}
+		}
+
+		broadPhase->destroy();
+		delete broadPhase;
+		for (PhysicsModel* model : models) {
+			for (unsigned int i = 0; i < model->currentNoInstances; i++) {
+				delete model->instances[i];
+			}
+		}
+	}
+
+	bool passed = true;
+	passed = report(out, "octree box query", noBoxMismatches, noChecked) && passed;
+	passed = report(out, "octree sphere query", noSphereMismatches, noTreeChecked) && passed;
+	passed = report(out, "octree nearest", noNearestMismatches, noTreeChecked) && passed;
+	passed = report(out, "octree ray query", noRayMismatches, noRays) && passed;
+	return passed;
+}
+
+// static tree loaded from the cache file against the tree that saved it, and a moved instance making the file out of date (a ten thousandth of the cases)
+bool Verify::octreeCache(std::mt19937& random, std::ostream& out) {
+	const char* path = "verify_octree.cache";
+	const unsigned int noInstances = 300;
+	BoundingRegion bounds(glm::vec3(-WORLD_BOUNDS), glm::vec3(WORLD_BOUNDS));
+	unsigned int noMismatches = 0;
+	unsigned int noChecked = 0;
+
+	for (unsigned int i = 0; i < noCases / 10000; i++) {
+		// instances with a box and a sphere region
+		PhysicsModel model("statics", noInstances, CONST_INSTANCES);
+		model.boundingRegions.push_back(BoundingRegion(glm::vec3(-1.0f), glm::vec3(1.0f)));
+		model.boundingRegions.push_back(BoundingRegion(glm::vec3(0.0f, 1.0f, 0.0f), 0.5f));
+		for (unsigned int j = 0; j < noInstances; j++) {
+			model.generateInstances(randomVector(random, 0.2f, 1.5f), 1.0f, randomPoint(random, 30.0f), glm::vec3(0.0f));
+		}
+
+		// trees with the static instances of the model and the same cache file
+		auto createTree = [&]() -> Octree::node* {
+			Octree::node* root = new Octree::node(bounds);
+			root->staticCache = new OctreeCache(path);
+			for (unsigned int j = 0; j < noInstances; j++) {
+				root->addToPending(model.instances[j], &model);
+			}
+			return root;
+		};
+
+		// built and saved
+		std::remove(path);
+		BoxList boxList;
+		Octree::node* built = createTree();
+		built->update(boxList);
+		std::vector<unsigned char> builtOctants, loadedOctants;
+		std::vector<std::vector<std::tuple<RigidBody*, float, float, float>>> builtObjects, loadedObjects;
+		treeObjects(built, builtOctants, builtObjects);
+
+		// loaded, same nodes with the same objects
+		Octree::node* loaded = createTree();
+		bool matches = loaded->staticCache->load(loaded);
+		if (matches) {
+			treeObjects(loaded, loadedOctants, loadedObjects);
+			matches = loadedOctants == builtOctants && loadedObjects == builtObjects;
+		}
+
+		// out of date once an instance moved
+		RigidBody* moved = model.instances[random() % noInstances];
+		moved->setPos(moved->getPos() + glm::vec3(0.5f));
+		model.bodies.updateMatrices(0, model.currentNoInstances);
+		Octree::node* stale = createTree();
+		matches = matches && !stale->staticCache->load(stale);
+
+		noChecked++;
+		if (!matches) {
+			noMismatches++;
+		}
+
+		for (Octree::node* root : { built, loaded, stale }) {
+			root->destroy();
+			delete root;
+		}
+		for (unsigned int j = 0; j < model.currentNoInstances; j++) {
+			delete model.instances[j];
+		}
+	}
+	std::remove(path);
+
+	return report(out, "octree cache", noMismatches, noChecked);
+}
+
+// ring buffer filled by several producer threads, then drained while they push (a ten thousandth of the cases for each)
+bool Verify::ringBuffer(std::mt19937& random, std::ostream& out) {
+	const unsigned int noProducers = 4;
+	const unsigned int noPushes = 10000;
+	// values hold the producer in the top byte and its count of pushes below
+	const unsigned int producerShift = 24;
+	unsigned int noMismatches = 0;
+	unsigned int noChecked = 0;
+
+	for (unsigned int i = 0; i < noCases / 10000; i++) {
+		RingBuffer<unsigned int, 256> buffer;
+		std::vector<unsigned int> noPushed(noProducers, 0);
+
+		// push from every producer, counting the pushes that fit
+		auto produce = [&](unsigned int producer) -> void {
+			for (unsigned int j = 0; j < noPushes; j++) {
+				if (buffer.push((producer << producerShift) | j)) {
+					noPushed[producer]++;
+				}
+			}
+		};
+
+		// pop all values, each producer's values have to come in the order it pushed them
+		std::vector<unsigned int> noPopped(noProducers, 0);
+		std::vector<int> last(noProducers, -1);
+		bool ordered = true;
+		auto drain = [&]() -> void {
+			unsigned int value;
+			while (buffer.pop(value)) {
+				unsigned int producer = value >> producerShift;
+				int count = (int)(value & ((1u << producerShift) - 1));
+				if (producer >= noProducers || count <= last[producer]) {
+					ordered = false;
+					continue;
+				}
+				last[producer] = count;
+				noPopped[producer]++;
+			}
+		};
+
+		// full, exactly the capacity gets in and the rest is dropped
+		std::vector<std::thread> producers;
+		for (unsigned int j = 0; j < noProducers; j++) {
+			producers.push_back(std::thread(produce, j));
+		}
+		for (std::thread& producer : producers) {
+			producer.join();
+		}
+		unsigned int noFull = 0;
+		for (unsigned int j = 0; j < noProducers; j++) {
+			noFull += noPushed[j];
+		}
+		unsigned int noDropped = buffer.takeDropped();
+		drain();
+
+		noChecked++;
+		if (!ordered || noFull != 256 || noDropped != noProducers * noPushes - noFull || noPopped != noPushed) {
+			noMismatches++;
+		}
+
+		// drained while the producers push, every value that got in comes out once
+		std::fill(noPushed.begin(), noPushed.end(), 0);
+		std::fill(noPopped.begin(), noPopped.end(), 0);
+		std::fill(last.begin(), last.end(), -1);
+		producers.clear();
+		for (unsigned int j = 0; j < noProducers; j++) {
+			producers.push_back(std::thread(produce, j));
+		}
+		std::thread consumer([&]() -> void {
+			for (unsigned int j = 0; j < noPushes; j++) {
+				drain();
+			}
+		});
+		for (std::thread& producer : producers) {
+			producer.join();
+		}
+		consumer.join();
+		drain();
+
+		unsigned int noAdded = 0;
+		for (unsigned int j = 0; j < noProducers; j++) {
+			noAdded += noPushed[j];
+		}
+		noDropped = buffer.takeDropped();
+
+		noChecked++;
+		if (!ordered || noDropped != noProducers * noPushes - noAdded || noPopped != noPushed) {
+			noMismatches++;
+		}
+	}
+
+	return report(out, "ring buffer", noMismatches, noChecked);
+}
+
+// SIMD integration and matrices of a body store over a few frames against stepping each body on its own with the scalar loop (a hundredth of the cases)
+bool Verify::bodyStore(std::mt19937& random, std::ostream& out) {
+	const unsigned int noFrames = 8;
+	float tolerance = 1e-5f;
+	unsigned int noMismatches = 0;
+
+	for (unsigned int i = 0; i < noCases / 100; i++) {
+		// counts that leave a scalar rest after the SIMD blocks
+		unsigned int noBodies = 1 + random() % 37;
+		BodyStore simd(noBodies), scalar(noBodies);
+		for (unsigned int j = 0; j < noBodies; j++) {
+			glm::vec3 size = randomVector(random, 0.1f, 2.0f);
+			glm::vec3 pos = randomPoint(random, 10.0f);
+			glm::vec3 rot = randomVector(random, 0.0f, 6.28f);
+			// bodies at rest have no velocity or no acceleration
+			glm::vec3 velocity = j % 4 == 0 ? glm::vec3(0.0f) : randomPoint(random, 5.0f);
+			glm::vec3 acceleration = j % 4 == 1 ? glm::vec3(0.0f) : randomPoint(random, 10.0f);
+
+			for (BodyStore* store : { &simd, &scalar }) {
+				unsigned int idx = store->add(size, 1.0f, pos, rot);
+				store->vx[idx] = velocity.x;
+				store->vy[idx] = velocity.y;
+				store->vz[idx] = velocity.z;
+				store->ax[idx] = acceleration.x;
+				store->ay[idx] = acceleration.y;
+				store->az[idx] = acceleration.z;
+			}
+		}
+
+		bool matches = true;
+		for (unsigned int frame = 0; frame < noFrames; frame++) {
+			float dt = randomValue(random, 0.005f, 0.05f);
+			simd.update(dt);
+			for (unsigned int j = 0; j < noBodies; j++) {
+				// ranges of one body never reach the SIMD loop
+				scalar.integrate(j, 1, dt);
+				scalar.updateMatrices(j, 1);
+			}
+
+			for (unsigned int j = 0; j < noBodies; j++) {
+				matches = matches &&
+					closeTo(simd.px[j], scalar.px[j], tolerance) && closeTo(simd.py[j], scalar.py[j], tolerance) && closeTo(simd.pz[j], scalar.pz[j], tolerance) &&
+					closeTo(simd.vx[j], scalar.vx[j], tolerance) && closeTo(simd.vy[j], scalar.vy[j], tolerance) && closeTo(simd.vz[j], scalar.vz[j], tolerance) &&
+					simd.transformVersions[j] == scalar.transformVersions[j];
+				for (int c = 0; c < 4; c++) {
+					for (int r = 0; r < 4; r++) {
+						matches = matches && closeTo(simd.models[j][c][r], scalar.models[j][c][r], tolerance);
+					}
+				}
+				for (int c = 0; c < 3; c++) {
+					for (int r = 0; r < 3; r++) {
+						matches = matches && closeTo(simd.normalModels[j][c][r], scalar.normalModels[j][c][r], tolerance);
+					}
+				}
+			}
+		}
+
+		if (!matches) {
+			noMismatches++;
+		}
+	}
+
+	return report(out, "body store", noMismatches, noCases / 100);
+}
+
+// SIMD sphere test of the face ranges of a 8192-face terrain against the closest point of every face (a hundredth of the cases)
+bool Verify::terrainSpheres(std::mt19937& random, std::ostream& out) {
+	std::vector<glm::vec3> points;
+	std::vector<unsigned int> indices;
+	terrain(64, false, points, indices);
+	CollisionMesh mesh((unsigned int)points.size(), &points[0].x, (unsigned int)indices.size() / 3, &indices[0]);
+
+	BodyStore store(1);
+	RigidBody body(&store, store.add(glm::vec3(1.0f), 1.0f, glm::vec3(0.0f), glm::vec3(0.0f)));
+	body.bodyId = 1;
+	WorldMesh& worldMesh = mesh.getWorldMesh(&body);
+
+	unsigned int noSpheres = noCases / 100;
+	unsigned int noMismatches = 0;
+	float radius = 0.3f;
+	for (unsigned int i = 0; i < noSpheres; i++) {
+		// spheres just above or below the surface
+		float x = randomValue(random, -9.0f, 9.0f);
+		float z = randomValue(random, -9.0f, 9.0f);
+		glm::vec3 center(x, 0.5f * std::sin(x) * std::cos(z) + randomValue(random, -0.4f, 0.4f), z);
+
+		// closest face in the ranges of the bvh
+		bool hit = false;
+		float dist = radius;
+		mesh.queryBoxRanges(&body, center - radius, center + radius, [&](unsigned int first, unsigned int count) -> bool {
+			unsigned int idx;
+			float d;
+			if (worldMesh.faces.collidesWithSphere(first, count, center, radius, idx, d) && d <= dist) {
+				hit = true;
+				dist = d;
+			}
+			return false;
+		});
+
+		// closest point of every face
+		bool hitRef = false;
+		float distRef = radius * radius;
+		for (unsigned int f = 0; f < worldMesh.faces.count; f++) {
+			glm::vec3 diff = center - worldMesh.faces.closestPoint(f, center);
+			float d = glm::dot(diff, diff);
+			if (d <= distRef) {
+				hitRef = true;
+				distRef = d;
+			}
+		}
+
+		if (hit != hitRef || (hit && std::abs(dist - std::sqrt(distRef)) > 1e-4f)) {
+			noMismatches++;
+		}
+	}
+
+	return report(out, "terrain spheres", noMismatches, noSpheres);
+}
+
+// box regions against the faces of the terrain through the narrow phase against the convex test of every face (a hundredth of the cases)
+bool Verify::terrainBoxes(std::mt19937& random, std::ostream& out) {
+	std::vector<glm::vec3> points;
+	std::vector<unsigned int> indices;
+	terrain(64, false, points, indices);
+	CollisionMesh mesh((unsigned int)points.size(), &points[0].x, (unsigned int)indices.size() / 3, &indices[0]);
+
+	BodyStore store(2);
+	RigidBody ground(&store, store.add(glm::vec3(1.0f), 1.0f, glm::vec3(0.0f), glm::vec3(0.0f)));
+	RigidBody body(&store, store.add(glm::vec3(1.0f), 1.0f, glm::vec3(0.0f), glm::vec3(0.0f)));
+	ground.bodyId = 1;
+	body.bodyId = 2;
+	WorldMesh& worldMesh = mesh.getWorldMesh(&ground);
+
+	BoundingRegion groundRegion(glm::vec3(-10.0f, -0.5f, -10.0f), glm::vec3(10.0f, 0.5f, 10.0f));
+	groundRegion.instance = &ground;
+	groundRegion.collisionMesh = &mesh;
+
+	// each face as a hull of its corners
+	std::vector<glm::vec3> corners(3);
+	ConvexShape faceShape = {};
+	faceShape.type = ConvexTypes::HULL;
+	faceShape.points = &corners;
+	faceShape.transform = glm::mat4(1.0f);
+
+	unsigned int noBoxes = noCases / 100;
+	// cases closer than this to touching can go either way
+	float margin = 1e-3f;
+	unsigned int noMismatches = 0;
+	unsigned int noChecked = 0;
+	for (unsigned int i = 0; i < noBoxes; i++) {
+		// boxes just above or below the surface, every other one rotated
+		float x = randomValue(random, -9.0f, 9.0f);
+		float z = randomValue(random, -9.0f, 9.0f);
+		glm::vec3 center(x, 0.5f * std::sin(x) * std::cos(z) + randomValue(random, -0.6f, 0.6f), z);
+		glm::vec3 half = randomVector(random, 0.1f, 0.4f);
+
+		BoundingRegion box;
+		if (i % 2) {
+			box = BoundingRegion(center - half, center + half);
+		}
+		else {
+			box.type = BoundTypes::OBB;
+			box.center = center;
+			box.axes = glm::mat3_cast(glm::quat(randomVector(random, 0.0f, 6.28f)));
+			box.halfSize = half;
+		}
+		box.instance = &body;
+
+		Contact contact;
+		bool hit = NarrowPhase::test(groundRegion, box, contact);
+
+		// convex test of every face, deepest contact and closest distance
+		bool hitRef = false;
+		float depthRef = std::numeric_limits<float>::lowest();
+		ConvexShape boxShape = GJK::region(box);
+		for (unsigned int f = 0; f < worldMesh.faces.count; f++) {
+			corners[0] = glm::vec3(worldMesh.faces.px[f], worldMesh.faces.py[f], worldMesh.faces.pz[f]);
+			corners[1] = corners[0] + glm::vec3(worldMesh.faces.ax[f], worldMesh.faces.ay[f], worldMesh.faces.az[f]);
+			corners[2] = corners[0] + glm::vec3(worldMesh.faces.bx[f], worldMesh.faces.by[f], worldMesh.faces.bz[f]);
+			faceShape.center = (corners[0] + corners[1] + corners[2]) / 3.0f;
+
+			ConvexContact c;
+			glm::vec3 pointA, pointB;
+			if (GJK::collide(boxShape, faceShape, c)) {
+				hitRef = true;
+				depthRef = std::fmaxf(depthRef, c.depth);
+			}
+			else {
+				depthRef = std::fmaxf(depthRef, -GJK::distance(boxShape, faceShape, pointA, pointB));
+			}
+		}
+		if (std::abs(depthRef) < margin) {
+			continue;
+		}
+
+		// the box responds with the normal pointing towards it, the separating axis test gives the same depth as EPA
+		noChecked++;
+		if (hit != hitRef || (hit && (contact.instance != &body || std::abs(contact.depth - depthRef) > 2e-3f))) {
+			noMismatches++;
+		}
+	}
+
+	return report(out, "terrain boxes", noMismatches, noChecked);
+}
+
+// welding and simplifying an 80k-face terrain with split seams and a finely gridded box, error at sampled source points
+bool Verify::simplifiedMeshes(std::mt19937& random, std::ostream& out) {
+	unsigned int noSamples = noCases / 100;
+	bool passed = true;
+
+	// terrain (seams are welded, then 80k faces collapse to 1024)
+	std::vector<glm::vec3> points;
+	std::vector<unsigned int> indices;
+	terrain(200, true, points, indices);
+	std::vector<glm::vec3> source = points;
+	MeshSimplifier::weld(points, indices, 1e-5f * 28.3f);
+	MeshSimplifier::simplify(points, indices, 1024);
+	float error = maxError(random, noSamples, source, points, indices);
+	// surface stays within a fifth of the height of the waves (0.5)
+	passed = report(out, "simplified terrain", indices.size() / 3 <= 1024 && error < 0.1f ? 0 : 1, 1) && passed;
+
+	// box (flat sides collapse to two faces each, leaving a convex mesh)
+	points.clear();
+	indices.clear();
+	griddedBox(30, points, indices);
+	source = points;
+	MeshSimplifier::weld(points, indices, 1e-5f * 3.5f);
+	MeshSimplifier::simplify(points, indices, 12);
+	CollisionMesh box((unsigned int)points.size(), &points[0].x, (unsigned int)indices.size() / 3, &indices[0]);
+	error = maxError(random, noSamples, source, points, indices);
+	passed = report(out, "simplified box", indices.size() / 3 == 12 && box.convex && error < 1e-4f ? 0 : 1, 1) && passed;
+
+	return passed;
+}
+
+/*
+	running
+*/
+
+// run all checks, returns if all passed
+bool Verify::run(unsigned int seed, std::ostream& out) {
+	std::mt19937 random(seed);
+	bool passed = true;
+
+	out << "verify, seed " << seed << ", " << noCases << " cases" << std::endl;
+	passed = pointInFace(random, out) && passed;
+	passed = rayTriangle(random, out) && passed;
+	passed = triangleTriangle(random, out) && passed;
+	passed = triangleBatch(random, out) && passed;
+	passed = convexShapes(random, out) && passed;
+	passed = orientedBoxes(random, out) && passed;
+	passed = rayPackets(random, out) && passed;
+	passed = octreeQueries(random, out) && passed;
+	passed = octreeCache(random, out) && passed;
+	passed = ringBuffer(random, out) && passed;
+	passed = bodyStore(random, out) && passed;
+	passed = terrainSpheres(random, out) && passed;
+	passed = terrainBoxes(random, out) && passed;
+	passed = simplifiedMeshes(random, out) && passed;
+
+	return passed;
+}
+
+// print result of check, returns if it passed
+bool Verify::report(std::ostream& out, std::string name, unsigned int noMismatches, unsigned int noChecked) {
+	out << "  " << std::left << std::setw(20) << name << std::right;
+	if (noMismatches) {
+		out << "FAILED, " << noMismatches << " of " << noChecked << " differ" << std::endl;
+		return false;
+	}
+
+	out << "passed (" << noChecked << ")" << std::endl;
+	return true;
+}
@@ -0,0 +1,75 @@
+#ifndef VERIFY_H
+#define VERIFY_H
+
+#include <iostream>
+#include <random>
+#include <string>
+
+/*
+	namespace to tie together the checks of the collision tests against reference versions
+	- each check runs on random inputs from the seed and prints its number of mismatches
+	- references are the versions the tests replaced (row reduced tests, scalar loops) or brute force
+*/
+
+namespace Verify {
+	// random cases of each check
+	extern unsigned int noCases;
+
+	/*
+		checks
+	*/
+
+	// closed-form point in face test against the row reduced linear combination
+	bool pointInFace(std::mt19937& random, std::ostream& out);
+
+	// closed-form ray-triangle test against the plane intersection and row reduced containment test
+	bool rayTriangle(std::mt19937& random, std::ostream& out);
+
+	// Guigue-Devillers triangle-triangle test against the old edge test run in both directions (2D edge test for coplanar faces)
+	bool triangleTriangle(std::mt19937& random, std::ostream& out);
+
+	// SIMD ray test of triangle batches against scalar Moller-Trumbore of each face
+	bool triangleBatch(std::mt19937& random, std::ostream& out);
+
+	// GJK/EPA of sphere, box, hull and capsule pairs against closed-form distances and depths (a tenth of the cases for each pair)
+	bool convexShapes(std::mt19937& random, std::ostream& out);
+
+	// separating axis, sphere and ray slab tests of oriented boxes against GJK, closest points and rays in the frame of the box (a tenth of the cases each)
+	bool orientedBoxes(std::mt19937& random, std::ostream& out);
+
+	// SIMD packet tests of boxes, oriented boxes and spheres against the closest hit of each ray with the scalar test (a third of the cases each)
+	bool rayPackets(std::mt19937& random, std::ostream& out);
+
+	// box, sphere, k-nearest and ray queries of the octree, loose octree and split octree, and box and ray queries of sweep and prune, against brute force over all regions (a hundredth of the cases for each structure)
+	bool octreeQueries(std::mt19937& random, std::ostream& out);
+
+	// static tree loaded from the cache file against the tree that saved it, and a moved instance making the file out of date (a ten thousandth of the cases)
+	bool octreeCache(std::mt19937& random, std::ostream& out);
+
+	// ring buffer filled by several producer threads, then drained while they push (a ten thousandth of the cases for each)
+	bool ringBuffer(std::mt19937& random, std::ostream& out);
+
+	// SIMD integration and matrices of a body store over a few frames against stepping each body on its own with the scalar loop (a hundredth of the cases)
+	bool bodyStore(std::mt19937& random, std::ostream& out);
+
+	// SIMD sphere test of the face ranges of a 8192-face terrain against the closest point of every face (a hundredth of the cases)
+	bool terrainSpheres(std::mt19937& random, std::ostream& out);
+
+	// box regions against the faces of the terrain through the narrow phase against the deepest convex test of every face (a hundredth of the cases)
+	bool terrainBoxes(std::mt19937& random, std::ostream& out);
+
+	// welding and simplifying an 80k-face terrain with split seams and a finely gridded box, error at sampled source points
+	bool simplifiedMeshes(std::mt19937& random, std::ostream& out);
+
+	/*
+		running
+	*/
+
+	// run all checks, returns if all passed
+	bool run(unsigned int seed, std::ostream& out);
+
+	// print result of check, returns if it passed
+	bool report(std::ostream& out, std::string name, unsigned int noMismatches, unsigned int noChecked);
+}
+
+#endif // !VERIFY_H